@@ -0,0 +1,30 @@
+"""
+PlatformIO extra script for the optimization profiles in platformio.ini
+
+  custom_hot_files   source globs compiled with custom_hot_flags on top of
+                     the environment's flags (the last -O wins)
+  -flto              when present in build_flags it is also passed to the
+                     link, which is where LTO actually happens
+"""
+
+Import("env")  # noqa: F821 (provided by PlatformIO)
+
+
+def option(name, default=""):
+    value = env.GetProjectOption(name, default)  # noqa: F821
+    return (" ".join(value) if isinstance(value, list) else value).split()
+
+
+hot_files = option("custom_hot_files")
+hot_flags = option("custom_hot_flags", "-O3")
+
+
+def compile_hot(env, node):
+    return env.Object(node, CCFLAGS=env["CCFLAGS"] + hot_flags)
+
+
+for pattern in hot_files:
+    env.AddBuildMiddleware(compile_hot, pattern)  # noqa: F821
+
+if "-flto" in option("build_flags"):
+    env.Append(LINKFLAGS=["-flto"])  # noqa: F821
@@ -0,0 +1,493 @@
+#!/usr/bin/env python3
+"""
+Protocol code generator
+
+Reads protocol/schema.json and emits:
+  firmware/src/protocol_gen.h             message structs and type ids
+  firmware/src/protocol_gen.cpp           field tables and key dispatch
+  mobile-app/AICompanionApp/protocol.ts   matching TypeScript types + codec
+
+The firmware runtime (src/protocol.cpp) walks the generated tables, so the
+hot path decodes into fixed-size structs without heap allocation and maps
+keys to fields through generated switch statements instead of string
+lookups. Run from firmware/: python scripts/generate_protocol.py
+"""
+
+import json
+import os
+import re
+import sys
+
+ROOT = os.path.abspath(os.path.join(os.path.dirname(__file__), "..", ".."))
+SCHEMA = os.path.join(ROOT, "protocol", "schema.json")
+CPP_HEADER = os.path.join(ROOT, "firmware", "src", "protocol_gen.h")
+CPP_SOURCE = os.path.join(ROOT, "firmware", "src", "protocol_gen.cpp")
+TS_MODULE = os.path.join(ROOT, "mobile-app", "AICompanionApp", "protocol.ts")
+
+BANNER = "Generated by firmware/scripts/generate_protocol.py from\n" \
+         " * protocol/schema.json - do not edit"
+
+# Helper types referenced by "ts" overrides in the schema
+TS_HELPERS = """export interface CommandOp {
+  op: string;
+  key?: string;
+  value?: unknown;
+}
+
+export type BatchItem = ProtocolMessage & { count?: number };
+"""
+
+
+def camel(name):
+    return "".join(part.capitalize() for part in name.split("_"))
+
+
+def snake(name):
+    return re.sub(r"(?<!^)(?=[A-Z])", "_", name).lower()
+
+
+def load_schema():
+    with open(SCHEMA, encoding="utf-8") as f:
+        schema = json.load(f)
+
+    channels = {c["name"] for c in schema["channels"]}
+    if sorted(c["id"] for c in schema["channels"]) != list(
+            range(len(channels))):
+        sys.exit("channel ids must be 0..n-1")
+    ids = set()
+    for message in schema["messages"]:
+        message.setdefault("channel", "chat")
+        if message["channel"] not in channels:
+            sys.exit(f"{message['type']}: unknown channel "
+                     f"{message['channel']}")
+        message.setdefault("delivery", "notify")
+        if message["delivery"] not in ("notify", "indicate"):
+            sys.exit(f"{message['type']}: delivery must be notify or "
+                     f"indicate")
+        if message["struct"] not in schema["structs"]:
+            sys.exit(f"{message['type']}: unknown struct {message['struct']}")
+        if message["id"] in ids or not 0 < message["id"] < 256:
+            sys.exit(f"{message['type']}: id {message['id']} reused or >255")
+        ids.add(message["id"])
+    for name, fields in schema["structs"].items():
+        for field in fields:
+            if field["type"] not in ("string", "u32", "bool", "json"):
+                sys.exit(f"{name}.{field['name']}: bad type {field['type']}")
+    return schema
+
+
+def key_switch(function, entries, indent="  "):
+    """switch on length, then memcmp: no hashing, no string scans"""
+    by_length = {}
+    for key, value in entries:
+        by_length.setdefault(len(key), []).append((key, value))
+
+    lines = [f"{indent}switch (length) {{"]
+    for length in sorted(by_length):
+        lines.append(f"{indent}case {length}:")
+        for key, value in by_length[length]:
+            lines.append(f'{indent}  if (memcmp(key, "{key}", {length}) == 0) {{')
+            lines.append(f"{indent}    return {value};")
+            lines.append(f"{indent}  }}")
+        lines.append(f"{indent}  break;")
+    lines.append(f"{indent}}}")
+    return lines
+
+
+def generate_header(schema):
+    out = [
+        "/**",
+        f" * {BANNER}",
+        " *",
+        " * Message structs for the BLE / USB protocol. Strings are fixed-size",
+        " * NUL-terminated buffers sized from the schema limits; nested JSON",
+        " * members (command ops, batch items, ...) are not part of the structs",
+        " * and are read with ArduinoJson by the message handler.",
+        " */",
+        "",
+        "#ifndef PROTOCOL_GEN_H",
+        "#define PROTOCOL_GEN_H",
+        "",
+        "#include <stdint.h>",
+        "",
+        "namespace Protocol {",
+        "",
+        "enum class MessageType : uint8_t {",
+        "  Unknown = 0,",
+    ]
+    for message in schema["messages"]:
+        out.append(f"  {camel(message['type'])} = {message['id']},")
+    out += ["};", ""]
+    out.append("static const uint8_t MAX_MESSAGE_ID = "
+               f"{max(m['id'] for m in schema['messages'])};")
+    out.append("")
+
+    out.append("// BLE frames start with their channel id, see "
+               "channel_scheduler.h")
+    out.append("enum class Channel : uint8_t {")
+    for channel in sorted(schema["channels"], key=lambda c: c["id"]):
+        out.append(f"  {camel(channel['name'])} = {channel['id']},")
+    out += ["};", ""]
+    out.append("static const uint8_t CHANNEL_COUNT = "
+               f"{len(schema['channels'])};")
+    out.append("")
+
+    for name, fields in schema["structs"].items():
+        members = [f for f in fields if f["type"] != "json"]
+        if not members:
+            continue
+        out.append(f"struct {name} {{")
+        for field in members:
+            if field["type"] == "string":
+                out.append(f"  char {field['name']}[{field['max'] + 1}];")
+            elif field["type"] == "u32":
+                out.append(f"  uint32_t {field['name']};")
+            else:
+                out.append(f"  bool {field['name']};")
+        out += ["};", ""]
+
+    out.append("union Body {")
+    for name, fields in schema["structs"].items():
+        if any(f["type"] != "json" for f in fields):
+            out.append(f"  {name} {snake(name)};")
+    out += ["};", ""]
+
+    out += [
+        "struct Message {",
+        "  MessageType type;",
+        "  bool has_seq;",
+        "  uint32_t seq;",
+        "  Body body;",
+        "};",
+        "",
+        "} // namespace Protocol",
+        "",
+        "#endif // PROTOCOL_GEN_H",
+        "",
+    ]
+    return "\n".join(out)
+
+
+def generate_source(schema):
+    out = [
+        "/**",
+        f" * {BANNER}",
+        " */",
+        "",
+        '#include "protocol.h"',
+        "",
+        "#include <stddef.h>",
+        "#include <string.h>",
+        "",
+        "namespace Protocol {",
+        "",
+        "namespace {",
+        "",
+    ]
+
+    kinds = {"string": "String", "u32": "U32", "bool": "Bool"}
+    emitted = set()
+    for name, fields in schema["structs"].items():
+        members = [(i, f) for i, f in enumerate(fields) if f["type"] != "json"]
+        if not members or name in emitted:
+            continue
+        emitted.add(name)
+        table = snake(name).upper() + "_FIELDS"
+        out.append(f"const FieldDesc {table}[] = {{")
+        for index, field in members:
+            capacity = field["max"] + 1 if field["type"] == "string" else 0
+            entry = (f'{{"{field["name"]}", {len(field["name"])}, {index + 1}, '
+                     f"FieldKind::{kinds[field['type']]}, "
+                     f"offsetof({name}, {field['name']}), {capacity}}},")
+            if len(entry) + 4 <= 80:
+                out.append("    " + entry)
+            else:
+                split = entry.index(" offsetof(")
+                out.append("    " + entry[:split])
+                out.append("     " + entry[split + 1:])
+        out += ["};", ""]
+
+        out.append(f"int find_{snake(name)}_field(const char *key, "
+                   "size_t length) {")
+        out += key_switch(None, [(f["name"], n)
+                                 for n, (_, f) in enumerate(members)])
+        out += ["  return -1;", "}", ""]
+
+    out += ["} // namespace", ""]
+
+    out.append("const MessageDesc *describe(MessageType type) {")
+    out.append("  static const MessageDesc MESSAGES[] = {")
+    for message in schema["messages"]:
+        name = message["struct"]
+        fields = schema["structs"][name]
+        members = [f for f in fields if f["type"] != "json"]
+        dynamic = "true" if len(members) != len(fields) else "false"
+        table = snake(name).upper() + "_FIELDS" if members else "nullptr"
+        finder = f"find_{snake(name)}_field" if members else "nullptr"
+        out.append(f"      {{MessageType::{camel(message['type'])}, "
+                   f'"{message["type"]}", {len(message["type"])},')
+        indicate = "true" if message["delivery"] == "indicate" else "false"
+        tail = (f"{table}, {len(members)}, {dynamic}, {finder}, "
+                f"Channel::{camel(message['channel'])}, {indicate}}},")
+        if len(tail) + 7 <= 80:
+            out.append(f"       {tail}")
+        else:
+            split = tail.index(" Channel::")
+            out.append(f"       {tail[:split]}")
+            out.append(f"       {tail[split + 1:]}")
+    out += [
+        "  };",
+        "  for (const MessageDesc &desc : MESSAGES) {",
+        "    if (desc.type == type) {",
+        "      return &desc;",
+        "    }",
+        "  }",
+        "  return nullptr;",
+        "}",
+        "",
+        "const char *channel_name(Channel channel) {",
+        "  switch (channel) {",
+    ]
+    for channel in sorted(schema["channels"], key=lambda c: c["id"]):
+        out.append(f"  case Channel::{camel(channel['name'])}:")
+        out.append(f'    return "{channel["name"]}";')
+    out += [
+        "  }",
+        '  return "unknown";',
+        "}",
+        "",
+        "MessageType find_type(const char *key, size_t length) {",
+    ]
+    out += key_switch(None, [(m["type"], f"MessageType::{camel(m['type'])}")
+                             for m in schema["messages"]])
+    out += [
+        "  return MessageType::Unknown;",
+        "}",
+        "",
+        "} // namespace Protocol",
+        "",
+    ]
+    return "\n".join(out)
+
+
+def ts_type(field):
+    if "ts" in field:
+        return field["ts"]
+    return {"string": "string", "u32": "number", "bool": "boolean"}.get(
+        field["type"], "unknown")
+
+
+def generate_typescript(schema):
+    out = [
+        "/**",
+        f" * {BANNER}",
+        " *",
+        " * @format",
+        " */",
+        "",
+        "import { Buffer } from 'buffer';",
+        "",
+        "export const MessageType = {",
+    ]
+    for message in schema["messages"]:
+        out.append(f"  {camel(message['type'])}: '{message['type']}',")
+    out += [
+        "} as const;",
+        "",
+        "export type MessageTypeName = (typeof MessageType)[keyof typeof "
+        "MessageType];",
+        "",
+        "// BLE frames start with the id of their message's channel",
+        "export const Channel = {",
+    ]
+    for channel in sorted(schema["channels"], key=lambda c: c["id"]):
+        out.append(f"  {camel(channel['name'])}: {channel['id']},")
+    out += [
+        "} as const;",
+        "",
+        "export type ChannelId = (typeof Channel)[keyof typeof Channel];",
+        "",
+        "export const MESSAGE_CHANNEL: Record<MessageTypeName, ChannelId> = {",
+    ]
+    for message in schema["messages"]:
+        out.append(f"  {message['type']}: "
+                   f"Channel.{camel(message['channel'])},")
+    out += [
+        "};",
+        "",
+        TS_HELPERS,
+    ]
+
+    for name, fields in schema["structs"].items():
+        if not fields:
+            continue
+        out.append(f"export interface {name}Fields {{")
+        for field in fields:
+            optional = "?" if field["type"] == "json" else ""
+            out.append(f"  {field['name']}{optional}: {ts_type(field)};")
+        out += ["}", ""]
+
+    union = []
+    for message in schema["messages"]:
+        interface = camel(message["type"]) + "Message"
+        union.append(interface)
+        fields = schema["structs"][message["struct"]]
+        base = f" extends {message['struct']}Fields" if fields else ""
+        out.append(f"export interface {interface}{base} {{")
+        out.append(f"  type: '{message['type']}';")
+        out.append("  seq?: number;")
+        out += ["}", ""]
+
+    out.append("export type ProtocolMessage =")
+    for i, interface in enumerate(union):
+        end = ";" if i == len(union) - 1 else ""
+        out.append(f"  | {interface}{end}")
+    out.append("")
+
+    # Messages sharing a struct, e.g. every TextMessage can be built by one
+    # helper that takes the type as a parameter
+    for name, fields in schema["structs"].items():
+        shared = [camel(m["type"]) + "Message" for m in schema["messages"]
+                  if m["struct"] == name]
+        if not fields or len(shared) < 2:
+            continue
+        alias = f"{name}Message"
+        if alias in union:
+            sys.exit(f"{alias} clashes with a message interface")
+        out.append(f"export type {alias} =")
+        for i, interface in enumerate(shared):
+            end = ";" if i == len(shared) - 1 else ""
+            out.append(f"  | {interface}{end}")
+        out.append("")
+
+    # Binary layout: [id][seq varint][(tag << 3 | wire) value]...
+    out.append("type WireKind = 'string' | 'u32' | 'bool';")
+    out.append("")
+    out.append("const BINARY_LAYOUT: Record<")
+    out.append("  number,")
+    out.append("  { type: MessageTypeName; fields: [string, number, WireKind][] }")
+    out.append("> = {")
+    for message in schema["messages"]:
+        fields = schema["structs"][message["struct"]]
+        if any(f["type"] == "json" for f in fields):
+            continue
+        entries = [f"['{f['name']}', {i + 1}, '{f['type']}']"
+                   for i, f in enumerate(fields)]
+        out.append(f"  {message['id']}: {{")
+        out.append(f"    type: '{message['type']}',")
+        one_line = f"    fields: [{', '.join(entries)}],"
+        if len(one_line) <= 80:
+            out.append(one_line)
+        else:
+            # Wrapped the way Prettier would
+            out.append("    fields: [")
+            out += [f"      {entry}," for entry in entries]
+            out.append("    ],")
+        out.append("  },")
+    out += ["};", ""]
+    out.append(TS_CODEC)
+    return "\n".join(out)
+
+
+TS_CODEC = """const WIRE_VARINT = 0;
+const WIRE_BYTES = 2;
+
+const pushVarint = (out: number[], value: number) => {
+  let v = value >>> 0;
+  while (v >= 0x80) {
+    out.push((v & 0x7f) | 0x80);
+    v >>>= 7;
+  }
+  out.push(v);
+};
+
+// Compact binary form of a message (same layout as the firmware codec);
+// null for messages with nested JSON members
+export const encodeBinary = (message: ProtocolMessage): Uint8Array | null => {
+  const entry = Object.entries(BINARY_LAYOUT).find(
+    ([, layout]) => layout.type === message.type,
+  );
+  if (!entry) {
+    return null;
+  }
+  const out: number[] = [Number(entry[0])];
+  pushVarint(out, message.seq ?? 0);
+  const values = message as unknown as Record<string, unknown>;
+  for (const [name, tag, kind] of entry[1].fields) {
+    const value = values[name];
+    if (kind === 'string') {
+      const bytes = Buffer.from(String(value ?? ''), 'utf-8');
+      out.push((tag << 3) | WIRE_BYTES);
+      pushVarint(out, bytes.length);
+      bytes.forEach(b => out.push(b));
+    } else {
+      out.push((tag << 3) | WIRE_VARINT);
+      pushVarint(out, kind === 'bool' ? (value ? 1 : 0) : Number(value ?? 0));
+    }
+  }
+  return Uint8Array.from(out);
+};
+
+export const decodeBinary = (bytes: Uint8Array): ProtocolMessage | null => {
+  const layout = BINARY_LAYOUT[bytes[0]];
+  if (!layout) {
+    return null;
+  }
+  let pos = 1;
+  const readVarint = () => {
+    let value = 0;
+    for (let shift = 0; shift < 35 && pos < bytes.length; shift += 7) {
+      const b = bytes[pos++];
+      value += (b & 0x7f) * 2 ** shift;
+      if (!(b & 0x80)) {
+        return value;
+      }
+    }
+    throw new Error('truncated varint');
+  };
+
+  try {
+    const message: Record<string, unknown> = {
+      type: layout.type,
+      seq: readVarint(),
+    };
+    while (pos < bytes.length) {
+      const key = readVarint();
+      const field = layout.fields.find(([, tag]) => tag === key >> 3);
+      if ((key & 7) === WIRE_BYTES) {
+        const length = readVarint();
+        const text = Buffer.from(bytes.subarray(pos, pos + length));
+        pos += length;
+        if (field) {
+          message[field[0]] = text.toString('utf-8');
+        }
+      } else {
+        const value = readVarint();
+        if (field) {
+          message[field[0]] = field[2] === 'bool' ? value !== 0 : value;
+        }
+      }
+    }
+    return message as unknown as ProtocolMessage;
+  } catch {
+    return null;
+  }
+};
+"""
+
+
+def write(path, content):
+    with open(path, "w", encoding="utf-8", newline="\n") as f:
+        f.write(content)
+    print(f"wrote {os.path.relpath(path, ROOT)}")
+
+
+def main():
+    schema = load_schema()
+    write(CPP_HEADER, generate_header(schema))
+    write(CPP_SOURCE, generate_source(schema))
+    write(TS_MODULE, generate_typescript(schema))
+
+
+if __name__ == "__main__":
+    main()
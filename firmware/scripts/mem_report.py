@@ -0,0 +1,311 @@
+#!/usr/bin/env python3
+"""
+RAM and flash budget per module
+
+Reads the linker map and ELF of a PlatformIO build and reports how much
+flash, IRAM, DRAM and PSRAM each module takes: LVGL, the BLE stack, Wi-Fi,
+ArduinoJson, the Arduino core, ESP-IDF, the C runtime and the app itself.
+
+  - The map attributes every input section to the object or archive member
+    it came from. Header-only ArduinoJson is split out of the app objects
+    by the symbol name that -ffunction-sections puts in each section name.
+  - The ELF section headers give the authoritative size of every output
+    section, so alignment padding and linker-generated data show up as
+    "(padding)" and the totals match `pio run -t size`.
+
+Memory is assigned from the output section (ESP32-S3 IDF 4.4 linker
+scripts): code and data copied from the image count towards flash as well
+as the RAM they run from. Heap allocations at runtime, such as LVGL's
+slabs and PSRAM blocks (src/lvgl_heap.h), are not in the map.
+
+Run from firmware/ after a build:
+  python scripts/mem_report.py                        # default environment
+  python scripts/mem_report.py --detail App           # per object in a module
+  python scripts/mem_report.py --save-baseline memory_baseline.json
+  python scripts/mem_report.py --baseline memory_baseline.json
+"""
+
+import argparse
+import json
+import os
+import re
+import struct
+import sys
+
+DEFAULT_ENV = "T-Display-AMOLED"
+REGIONS = ("flash", "iram", "dram", "psram")
+
+# Output section prefix -> memory it occupies at runtime, and whether its
+# contents are stored in the flash image
+SECTIONS = (
+    (".flash.", None, True),
+    (".iram0.bss", "iram", False),
+    (".iram0.", "iram", True),
+    (".dram0.bss", "dram", False),
+    (".dram0.", "dram", True),
+    (".noinit", "dram", False),
+    (".ext_ram", "psram", False),
+    (".rtc.", None, True),  # RTC RAM is not tracked; its image bytes are
+)
+
+# Object path -> module, first match wins. Paths are normalized to '/'.
+MODULES = (
+    ("LVGL", r"/lvgl/|liblvgl"),
+    ("BLE stack", r"/lib(bt|btdm_app)\.a|/BLE/"),
+    ("Wi-Fi / lwIP", r"/lib(net80211|pp|wpa_supplicant|esp_wifi|lwip|"
+     r"coexist|phy|mesh|smartconfig|espnow|esp_netif)\.a|/WiFi/"),
+    ("LilyGo AMOLED", r"LilyGo|SensorLib|XPowersLib"),
+    ("AceButton", r"AceButton"),
+    ("Arduino core", r"FrameworkArduino|/cores/esp32/"),
+    ("C/C++ runtime", r"/lib(c|m|g|gcc|stdc\+\+|newlib|cxx)\.a"),
+    ("App", r"\.pio/build/[^/]+/src/"),
+    ("lib:", r"\.pio/build/[^/]+/lib[0-9a-f]+/([^/]+)/"),
+    ("ESP-IDF", r"framework-arduinoespressif32|/sdk/|/toolchain-"),
+)
+
+# Header-only libraries compiled into the app objects
+INLINE_MODULES = (("ArduinoJson", "ArduinoJson"),)
+
+INPUT_SECTION = re.compile(
+    r"^ (\.\S+|COMMON)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(.+)$")
+SECTION_NAME_ONLY = re.compile(r"^ (\.\S+|COMMON)$")
+CONTINUATION = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(.+)$")
+OUTPUT_SECTION = re.compile(r"^(\.\S+)(\s+0x[0-9a-fA-F]+\s+0x[0-9a-fA-F]+)?")
+
+
+def classify_section(name):
+    """Returns (region, in_flash) or None for sections that take no memory."""
+    if name.endswith("_dummy") or name.startswith(".flash_rodata_dummy"):
+        return None  # Address-space placeholders, not contents
+    for prefix, region, in_flash in SECTIONS:
+        if name.startswith(prefix):
+            return region, in_flash
+    return None
+
+
+def classify_object(path, section):
+    path = path.replace("\\", "/")
+    for module, pattern in MODULES:
+        match = re.search(pattern, path)
+        if match:
+            break
+    else:
+        module = "Other"
+    if module == "lib:":
+        module = f"lib: {match.group(1)}"  # Any other Arduino library
+    if module == "App":
+        for inline, marker in INLINE_MODULES:
+            if marker in section:
+                return inline
+    return module
+
+
+def object_name(path):
+    path = path.replace("\\", "/")
+    match = re.search(r"([^/]+\.a)\((.+)\)$", path)
+    if match:
+        return f"{match.group(1)}({match.group(2)})"
+    return path.rsplit("/", 1)[-1]
+
+
+def empty_usage():
+    return dict.fromkeys(REGIONS, 0)
+
+
+def add_usage(usage, placement, size):
+    region, in_flash = placement
+    if in_flash:
+        usage["flash"] += size
+    if region is not None:
+        usage[region] += size
+
+
+def parse_map(path):
+    """Yields (output_section, input_section, size, object) from a GNU map."""
+    with open(path, encoding="utf-8", errors="replace") as f:
+        lines = iter(f.read().splitlines())
+    for line in lines:
+        if line.startswith("Linker script and memory map"):
+            break
+    else:
+        sys.exit(f"{path}: not a GNU ld map file")
+
+    output = None
+    pending = None
+    for line in lines:
+        if pending is not None:
+            match = CONTINUATION.match(line)
+            if match:
+                yield output, pending, int(match.group(2), 16), match.group(3)
+            pending = None
+            continue
+        match = OUTPUT_SECTION.match(line)
+        if match:
+            output = match.group(1)
+            continue
+        match = INPUT_SECTION.match(line)
+        if match:
+            yield output, match.group(1), int(match.group(3), 16), \
+                match.group(4)
+            continue
+        match = SECTION_NAME_ONLY.match(line)
+        if match:
+            pending = match.group(1)
+
+
+def elf_sections(path):
+    """Section name -> size for every allocated section of an ELF file."""
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:4] != b"\x7fELF":
+        sys.exit(f"{path}: not an ELF file")
+    is64 = data[4] == 2
+    endian = "<" if data[5] == 1 else ">"
+    if is64:
+        shoff, = struct.unpack_from(endian + "Q", data, 0x28)
+        shentsize, shnum, shstrndx = struct.unpack_from(endian + "HHH", data,
+                                                        0x3A)
+        header = endian + "IIQQQQIIQQ"
+    else:
+        shoff, = struct.unpack_from(endian + "I", data, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from(endian + "HHH", data,
+                                                        0x2E)
+        header = endian + "IIIIIIIIII"
+
+    headers = [struct.unpack_from(header, data, shoff + i * shentsize)
+               for i in range(shnum)]
+    names_offset = headers[shstrndx][4]
+    sections = {}
+    SHF_ALLOC = 0x2
+    for name, _type, flags, _addr, _offset, size, *_ in headers:
+        if not flags & SHF_ALLOC or size == 0:
+            continue
+        start = names_offset + name
+        label = data[start:data.index(b"\0", start)].decode()
+        sections[label] = size
+    return sections
+
+
+def build_report(map_path, elf_path):
+    modules = {}
+    objects = {}
+    mapped = {}
+    for output, section, size, obj in parse_map(map_path):
+        placement = classify_section(output or "")
+        if placement is None or size == 0 or obj.startswith("*fill*"):
+            continue
+        module = classify_object(obj, section)
+        add_usage(modules.setdefault(module, empty_usage()), placement, size)
+        key = (module, object_name(obj))
+        add_usage(objects.setdefault(key, empty_usage()), placement, size)
+        mapped[output] = mapped.get(output, 0) + size
+
+    if elf_path:
+        padding = empty_usage()
+        for section, size in elf_sections(elf_path).items():
+            placement = classify_section(section)
+            if placement is not None and size > mapped.get(section, 0):
+                add_usage(padding, placement, size - mapped.get(section, 0))
+        if any(padding.values()):
+            modules["(padding)"] = padding
+    return modules, objects
+
+
+def format_table(rows, baseline=None, label="Module"):
+    title = [label] + [region.upper() for region in REGIONS]
+    width = max([len(title[0])] + [len(name) for name in rows]) + 2
+    lines = []
+    header = title[0].ljust(width) + "".join(t.rjust(20 if baseline else 11)
+                                             for t in title[1:])
+    lines.append(header)
+    lines.append("-" * len(header))
+
+    totals = empty_usage()
+    base_totals = empty_usage()
+    names = sorted(rows, key=lambda n: (-rows[n]["flash"] - rows[n]["dram"],
+                                        n))
+    if baseline:
+        names += sorted(n for n in baseline if n not in rows)
+    for name in names:
+        usage = rows.get(name, empty_usage())
+        base = baseline.get(name, empty_usage()) if baseline else None
+        line = name.ljust(width)
+        for region in REGIONS:
+            totals[region] += usage[region]
+            cell = f"{usage[region]:,}"
+            if base is not None:
+                base_totals[region] += base.get(region, 0)
+                cell += format_delta(usage[region] - base.get(region, 0))
+            line += cell.rjust(20 if baseline else 11)
+        lines.append(line)
+
+    lines.append("-" * len(header))
+    line = "Total".ljust(width)
+    for region in REGIONS:
+        cell = f"{totals[region]:,}"
+        if baseline:
+            cell += format_delta(totals[region] - base_totals[region])
+        line += cell.rjust(20 if baseline else 11)
+    lines.append(line)
+    return "\n".join(lines)
+
+
+def format_delta(delta):
+    return f" ({delta:+,})" if delta else " (=)"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    parser.add_argument("--env", default=DEFAULT_ENV,
+                        help="PlatformIO environment to read (.pio/build/ENV)")
+    parser.add_argument("--map", help="linker map (default: firmware.map)")
+    parser.add_argument("--elf", help="ELF image (default: firmware.elf)")
+    parser.add_argument("--detail", metavar="MODULE",
+                        help="break one module down per object file")
+    parser.add_argument("--baseline", metavar="JSON",
+                        help="show the change against a saved report")
+    parser.add_argument("--save-baseline", metavar="JSON",
+                        help="store this report for later comparison")
+    args = parser.parse_args()
+
+    build_dir = os.path.join(".pio", "build", args.env)
+    map_path = args.map or os.path.join(build_dir, "firmware.map")
+    elf_path = args.elf or os.path.join(build_dir, "firmware.elf")
+    if not os.path.exists(map_path):
+        sys.exit(f"{map_path} not found: build first (make build)")
+    if not os.path.exists(elf_path):
+        print(f"{elf_path} not found: padding is not reported")
+        elf_path = None
+
+    modules, objects = build_report(map_path, elf_path)
+
+    baseline = None
+    if args.baseline:
+        if os.path.exists(args.baseline):
+            with open(args.baseline, encoding="utf-8") as f:
+                baseline = json.load(f)["modules"]
+        else:
+            print(f"No baseline at {args.baseline}; "
+                  f"create one with --save-baseline")
+
+    print(f"Memory by module ({map_path})\n")
+    print(format_table(modules, baseline))
+
+    if args.detail:
+        rows = {obj: usage for (module, obj), usage in objects.items()
+                if module == args.detail}
+        if not rows:
+            sys.exit(f"No objects in module '{args.detail}'")
+        print(f"\n{args.detail} by object\n")
+        print(format_table(rows, label="Object"))
+
+    if args.save_baseline:
+        with open(args.save_baseline, "w", encoding="utf-8") as f:
+            json.dump({"env": args.env, "modules": modules}, f, indent=2,
+                      sort_keys=True)
+            f.write("\n")
+        print(f"\nBaseline saved to {args.save_baseline}")
+
+
+if __name__ == "__main__":
+    main()
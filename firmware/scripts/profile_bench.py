@@ -0,0 +1,189 @@
+#!/usr/bin/env python3
+"""
+Size and speed of each optimization profile
+
+For every profile environment in platformio.ini (T-Display-AMOLED-size,
+-balanced, -speed) this records:
+  - firmware.bin size and the flash / IRAM / DRAM totals from the ELF
+  - the pipeline benchmarks on the host (tools/host_bench), compiled with
+    the profile's -O / -flto flags and hot-file overrides
+  - the same benchmarks on the device (host_cli bench all) when --port is
+    given; each profile is flashed in turn
+
+Results are printed as tables and saved as JSON under bench_results/, so
+runs on different days or commits can be compared. Run from firmware/:
+  python scripts/profile_bench.py                       # size + host only
+  python scripts/profile_bench.py --port /dev/ttyACM0   # plus device timings
+"""
+
+import argparse
+import configparser
+import datetime
+import fnmatch
+import json
+import os
+import shlex
+import subprocess
+import sys
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from mem_report import classify_section, elf_sections  # noqa: E402
+
+BASE_ENV = "T-Display-AMOLED"
+PROFILES = ("size", "balanced", "speed")
+FRAMEWORK_OPT = "-Os"  # What arduino-esp32 compiles with by default
+
+HOST_SOURCES = ("src/bench_cases.cpp", "src/draw_kernels.cpp",
+                "src/frame_codec.cpp", "src/protocol.cpp",
+                "src/protocol_gen.cpp", "tools/host_bench/host_bench.cpp")
+HOST_FLAGS = ["-std=c++17", "-Isrc"]
+BOOT_WAIT_S = 5  # USB-CDC re-enumerates after an upload
+
+
+def run(command, **kwargs):
+    print("$", " ".join(command), flush=True)
+    return subprocess.run(command, check=True, **kwargs)
+
+
+def profile_flags(config, env):
+    """(-O / -flto flags, hot file globs, hot flags) for one environment."""
+    section = f"env:{env}"
+
+    def tokens(option):
+        value = config.get(section, option, fallback="")
+        return [t for t in shlex.split(value) if not t.startswith("${")]
+
+    unflags = tokens("build_unflags")
+    flags = [t for t in tokens("build_flags")
+             if t.startswith("-O") or t == "-flto"]
+    if FRAMEWORK_OPT not in unflags and not any(
+            f.startswith("-O") for f in flags):
+        flags.insert(0, FRAMEWORK_OPT)
+    return flags, tokens("custom_hot_files"), tokens("custom_hot_flags")
+
+
+def image_size(env):
+    build_dir = os.path.join(".pio", "build", env)
+    sizes = {"bin": os.path.getsize(os.path.join(build_dir, "firmware.bin")),
+             "flash": 0, "iram": 0, "dram": 0}
+    for section, size in elf_sections(
+            os.path.join(build_dir, "firmware.elf")).items():
+        placement = classify_section(section)
+        if placement is None:
+            continue
+        region, in_flash = placement
+        if in_flash:
+            sizes["flash"] += size
+        if region in sizes:
+            sizes[region] += size
+    return sizes
+
+
+def host_bench(profile, flags, hot_files, hot_flags, compiler):
+    out_dir = os.path.join("build", f"host_bench_{profile}")
+    os.makedirs(out_dir, exist_ok=True)
+    objects = []
+    for source in HOST_SOURCES:
+        path = os.path.abspath(source)
+        extra = hot_flags if any(fnmatch.fnmatch(path, pattern)
+                                 for pattern in hot_files) else []
+        obj = os.path.join(out_dir, os.path.basename(source) + ".o")
+        run([compiler, *HOST_FLAGS, *flags, *extra, "-c", source, "-o", obj])
+        objects.append(obj)
+    binary = os.path.join(out_dir, "host_bench")
+    run([compiler, *flags, *objects, "-o", binary])
+    result = run([binary], capture_output=True, text=True)
+    return json.loads(result.stdout)
+
+
+def device_bench(env, port, pio, host_cli):
+    run([pio, "run", "-e", env, "-t", "upload", "--upload-port", port])
+    time.sleep(BOOT_WAIT_S)
+    result = run([host_cli, port, "bench", "all"], capture_output=True,
+                 text=True)
+    for line in result.stdout.splitlines():
+        reply = json.loads(line)
+        if reply.get("type") == "bench_result":
+            return reply.get("results", {})
+    sys.exit(f"{env}: no bench_result from the device")
+
+
+def print_tables(results):
+    profiles = list(results)
+    print("\nImage size (bytes)\n")
+    print("Profile".ljust(10) + "".join(
+        c.rjust(12) for c in ("firmware.bin", "flash", "IRAM", "DRAM")))
+    for profile in profiles:
+        size = results[profile]["size"]
+        print(profile.ljust(10) + "".join(
+            f"{size[k]:,}".rjust(12) for k in ("bin", "flash", "iram",
+                                               "dram")))
+
+    names = []
+    for profile in profiles:
+        for target in ("device", "host"):
+            for name in results[profile].get(target) or {}:
+                if name not in names:
+                    names.append(name)
+    print("\nBenchmarks (ns per op, device / host)\n")
+    print("Benchmark".ljust(18) + "".join(p.rjust(20) for p in profiles))
+    for name in names:
+        line = name.ljust(18)
+        for profile in profiles:
+            cells = []
+            for target in ("device", "host"):
+                entry = (results[profile].get(target) or {}).get(name)
+                cells.append(f"{entry['ns_per_op']:,}" if entry else "-")
+            line += " / ".join(cells).rjust(20)
+        print(line)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    parser.add_argument("--port", help="device port for on-device timings")
+    parser.add_argument("--profiles", nargs="+", default=PROFILES,
+                        choices=PROFILES)
+    parser.add_argument("--no-build", action="store_true",
+                        help="reuse the existing .pio/build outputs")
+    parser.add_argument("--pio", default="pio")
+    parser.add_argument("--cxx", default=os.environ.get("CXX", "g++"))
+    parser.add_argument("--out", default="bench_results")
+    args = parser.parse_args()
+
+    config = configparser.ConfigParser(interpolation=None)
+    config.read("platformio.ini")
+    host_cli = os.path.join("build", "host_cli")
+    if args.port and not os.path.exists(host_cli):
+        run(["make", "host-cli"])
+
+    results = {}
+    for profile in args.profiles:
+        env = f"{BASE_ENV}-{profile}"
+        flags, hot_files, hot_flags = profile_flags(config, env)
+        if not args.no_build:
+            run([args.pio, "run", "-e", env])
+        results[profile] = {
+            "env": env,
+            "flags": flags,
+            "hot_files": hot_files,
+            "size": image_size(env),
+            "host": host_bench(profile, flags, hot_files, hot_flags,
+                               args.cxx),
+            "device": device_bench(env, args.port, args.pio, host_cli)
+            if args.port else None,
+        }
+
+    print_tables(results)
+
+    os.makedirs(args.out, exist_ok=True)
+    stamp = datetime.datetime.now().strftime("%Y%m%d-%H%M%S")
+    path = os.path.join(args.out, f"profiles-{stamp}.json")
+    with open(path, "w", encoding="utf-8") as f:
+        json.dump(results, f, indent=2)
+        f.write("\n")
+    print(f"\nSaved to {path}")
+
+
+if __name__ == "__main__":
+    main()
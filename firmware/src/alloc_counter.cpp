@@ -0,0 +1,44 @@
+/**
+ * Heap allocation counter - see alloc_counter.h
+ */
+
+#include "alloc_counter.h"
+
+#include <stddef.h>
+
+#ifdef COUNT_ALLOCATIONS
+
+namespace {
+uint32_t allocations = 0;
+}
+
+extern "C" {
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size) {
+  __atomic_fetch_add(&allocations, 1, __ATOMIC_RELAXED);
+  return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+  __atomic_fetch_add(&allocations, 1, __ATOMIC_RELAXED);
+  return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+  __atomic_fetch_add(&allocations, 1, __ATOMIC_RELAXED);
+  return __real_realloc(ptr, size);
+}
+}
+
+uint32_t allocation_count() {
+  return __atomic_load_n(&allocations, __ATOMIC_RELAXED);
+}
+
+#else
+
+uint32_t allocation_count() { return 0; }
+
+#endif // COUNT_ALLOCATIONS
@@ -0,0 +1,18 @@
+/**
+ * Heap allocation counter for the T-Display-AMOLED-alloc environment
+ *
+ * That environment links with -Wl,--wrap=malloc/calloc/realloc, routing
+ * every C heap allocation (including operator new and Arduino String)
+ * through a counting shim. In the normal build the shim is not compiled
+ * and allocation_count() always returns 0.
+ */
+
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <stdint.h>
+
+// Allocations since boot, from every task
+uint32_t allocation_count();
+
+#endif // ALLOC_COUNTER_H
@@ -0,0 +1,229 @@
+/**
+ * On-device micro-benchmarks - see bench.h
+ */
+
+#include "bench.h"
+
+#include <esp_task_wdt.h>
+#include <lvgl.h>
+
+#include "ble_session.h"
+#include "bench_cases.h"
+
+namespace {
+
+using BenchCases::ITERATIONS;
+
+void report(JsonObject results, const char *name, uint32_t elapsed_us,
+            uint32_t bytes) {
+  JsonObject entry = results[name].to<JsonObject>();
+  entry["iterations"] = ITERATIONS;
+  entry["total_us"] = elapsed_us;
+  entry["ns_per_op"] = elapsed_us * 1000ull / ITERATIONS;
+  if (bytes > 0 && elapsed_us > 0) {
+    entry["kb_per_s"] = static_cast<uint64_t>(bytes) * 1000000ull /
+                        elapsed_us / 1024;
+  }
+}
+
+// ArduinoJson only exists in the firmware, so this one has no host twin
+void bench_json(JsonObject results) {
+  JsonDocument doc;
+  char out[256];
+  uint32_t start = micros();
+  for (int i = 0; i < ITERATIONS; i++) {
+    deserializeJson(doc, BenchCases::SAMPLE_MESSAGE);
+    serializeJson(doc, out, sizeof(out));
+  }
+  report(results, "json", micros() - start,
+         ITERATIONS * BenchCases::SAMPLE_LENGTH);
+}
+
+const int BLE_FRAMES = 100;
+const uint32_t BLE_TIMEOUT_MS = 20000;
+const char BLE_FILLER[] = "{\"type\":\"bench\",\"pad\":\"";
+
+// Link throughput to the first connected phone, with every frame sent as a
+// notification or as an indication. Frames are MTU-sized "bench" messages on
+// the diagnostics channel, which the app ignores. Not part of "all": it
+// needs a phone and takes seconds.
+void bench_ble(JsonObject results, const char *name, bool indicate) {
+  JsonObject entry = results[name].to<JsonObject>();
+  int8_t peer = BLE_BROADCAST;
+  for (int8_t i = 0; i < Constants::Bluetooth::MAX_CENTRALS; i++) {
+    if (ble_sessions.session(i) != nullptr) {
+      peer = i;
+      break;
+    }
+  }
+  if (peer == BLE_BROADCAST) {
+    entry["error"] = "no BLE peer";
+    return;
+  }
+
+  BleSession *session = ble_sessions.session(peer);
+  size_t length = session->max_message();
+  const size_t head = sizeof(BLE_FILLER) - 1;
+  if (length < head + 2) {
+    entry["error"] = "MTU not negotiated";
+    return;
+  }
+  char frame[Constants::Bluetooth::MAX_FRAME_SIZE];
+  memcpy(frame, BLE_FILLER, head);
+  memset(frame + head, 'x', length - head - 2);
+  memcpy(frame + length - 2, "\"}", 2);
+
+  SessionStats before = session->stats;
+  // Bulk channels leave INTERACTIVE_RESERVE slots for chat and control
+  const uint8_t room = Constants::Bluetooth::TX_QUEUE_DEPTH -
+                       Constants::Bluetooth::INTERACTIVE_RESERVE;
+  int queued = 0;
+  uint32_t start = millis();
+  while ((queued < BLE_FRAMES || !ble_sessions.tx_idle()) &&
+         millis() - start < BLE_TIMEOUT_MS &&
+         ble_sessions.session(peer) != nullptr) {
+    while (queued < BLE_FRAMES && session->tx_queue.queued() < room &&
+           ble_sessions.enqueue(peer, Channel::Diagnostics, frame, length,
+                                indicate)) {
+      queued++;
+    }
+    ble_sessions.service_tx();
+    esp_task_wdt_reset(); // A run outlasts the loop() task watchdog
+    delay(1);             // Lets the Bluetooth task run
+  }
+  uint32_t elapsed_ms = millis() - start;
+
+  const SessionStats &after = session->stats;
+  uint32_t sent = after.frames_sent - before.frames_sent;
+  uint32_t bytes = after.bytes_sent - before.bytes_sent;
+  entry["frames"] = sent;
+  entry["dropped"] = after.frames_dropped - before.frames_dropped;
+  entry["frame_bytes"] = length + Constants::Bluetooth::FRAME_HEADER;
+  entry["total_ms"] = elapsed_ms;
+  if (elapsed_ms > 0) {
+    entry["frames_per_s"] = sent * 1000ull / elapsed_ms;
+    entry["kb_per_s"] = bytes * 1000ull / elapsed_ms / 1024;
+  }
+  if (indicate) {
+    uint32_t confirmed =
+        after.indications_confirmed - before.indications_confirmed;
+    entry["confirmed"] = confirmed;
+    if (confirmed > 0) {
+      entry["avg_confirm_ms"] =
+          (after.confirm_ms_total - before.confirm_ms_total) / confirmed;
+    }
+  }
+}
+
+const int RENDER_FRAMES = 20;
+// Two paragraphs of different length, so every frame rewraps every line
+const char REFLOW_SHORT[] =
+    "Lunch at noon? The usual place. I booked the table by the window, "
+    "and Sam is coming too if the train is on time.";
+const char REFLOW_LONG[] =
+    "Reminder: the quarterly review moved to Thursday at 10:00 in room 4B. "
+    "Please bring the updated figures for the device fleet, the battery "
+    "report from the field units and your notes on the companion app "
+    "release. Coffee will be there, and so will the new prototypes.";
+
+struct RenderTimer {
+  uint32_t flush_started_us;
+  uint32_t flush_us;
+};
+
+void on_render_flush(lv_event_t *e) {
+  RenderTimer *timer = static_cast<RenderTimer *>(lv_event_get_user_data(e));
+  if (lv_event_get_code(e) == LV_EVENT_FLUSH_START) {
+    timer->flush_started_us = micros();
+  } else {
+    timer->flush_us += micros() - timer->flush_started_us;
+  }
+}
+
+// Whole frames through LVGL, split into rendering (shared by the draw
+// units) and the flush to the panel (serial). "render_full" repaints the
+// screen; "render_text" rewraps a screen-sized label between two texts.
+// Not part of "all": the screen shows it. Run under LV_DRAW_SW_DRAW_UNIT_CNT
+// 1 and 2 (the -1unit environment) for the speedup.
+void bench_render(JsonObject results, const char *name, bool text) {
+  JsonObject entry = results[name].to<JsonObject>();
+  lv_display_t *display = lv_display_get_default();
+  if (display == nullptr) {
+    entry["error"] = "no display";
+    return;
+  }
+
+  lv_obj_t *label = nullptr;
+  if (text) {
+    label = lv_label_create(lv_layer_top());
+    lv_obj_set_size(label, lv_pct(100), lv_pct(100));
+    lv_obj_set_style_bg_color(label, lv_color_hex(0x1E1E1E), LV_PART_MAIN);
+    lv_obj_set_style_bg_opa(label, LV_OPA_COVER, LV_PART_MAIN);
+    lv_obj_set_style_text_color(label, lv_color_hex(0xFFFFFF), LV_PART_MAIN);
+    lv_obj_set_style_text_font(label, &lv_font_montserrat_18, LV_PART_MAIN);
+    lv_label_set_long_mode(label, LV_LABEL_LONG_WRAP);
+  }
+  lv_refr_now(display); // Settle whatever was already pending
+
+  RenderTimer timer = {};
+  lv_display_add_event_cb(display, on_render_flush, LV_EVENT_FLUSH_START,
+                          &timer);
+  lv_display_add_event_cb(display, on_render_flush, LV_EVENT_FLUSH_FINISH,
+                          &timer);
+  uint32_t start = micros();
+  for (int i = 0; i < RENDER_FRAMES; i++) {
+    if (text) {
+      lv_label_set_text_static(label, i & 1 ? REFLOW_SHORT : REFLOW_LONG);
+    } else {
+      lv_obj_invalidate(lv_screen_active());
+    }
+    lv_refr_now(display);
+  }
+  uint32_t total_us = micros() - start;
+  lv_display_remove_event_cb_with_user_data(display, on_render_flush, &timer);
+  if (label != nullptr) {
+    lv_obj_delete(label);
+  }
+
+  entry["frames"] = RENDER_FRAMES;
+  entry["draw_units"] = LV_DRAW_SW_DRAW_UNIT_CNT;
+  entry["frame_us"] = total_us / RENDER_FRAMES;
+  entry["render_us"] = (total_us - timer.flush_us) / RENDER_FRAMES;
+  entry["flush_us"] = timer.flush_us / RENDER_FRAMES;
+}
+
+} // namespace
+
+bool run_bench(const char *name, JsonObject results) {
+  bool all = strcmp(name, "all") == 0;
+  bool found = false;
+  if (all || strcmp(name, "json") == 0) {
+    bench_json(results);
+    found = true;
+  }
+  bool indicate = strcmp(name, "ble_indicate") == 0;
+  if (indicate || strcmp(name, "ble_notify") == 0) {
+    bench_ble(results, name, indicate);
+    found = true;
+  }
+  bool text = strcmp(name, "render_text") == 0;
+  if (text || strcmp(name, "render_full") == 0) {
+    bench_render(results, name, text);
+    found = true;
+  }
+  if (all || strncmp(name, "draw_", 5) == 0) {
+    JsonObject check = results["draw_check"].to<JsonObject>();
+    check["mismatches"] = BenchCases::check_draw_kernels();
+    found = found || strcmp(name, "draw_check") == 0;
+  }
+  for (size_t i = 0; i < BenchCases::CASE_COUNT; i++) {
+    const BenchCases::Case &benchmark = BenchCases::CASES[i];
+    if (all || strcmp(name, benchmark.name) == 0) {
+      uint32_t start = micros();
+      uint32_t bytes = benchmark.run(ITERATIONS);
+      report(results, benchmark.name, micros() - start, bytes);
+      found = true;
+    }
+  }
+  return found;
+}
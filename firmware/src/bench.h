@@ -0,0 +1,23 @@
+/**
+ * On-device micro-benchmarks
+ *
+ * Triggered from the USB host CLI ("bench" message) so hot paths can be
+ * measured on real hardware without a phone in the loop. Each benchmark
+ * reports iterations, elapsed microseconds and derived throughput into the
+ * bench_result reply. "ble_notify" and "ble_indicate" instead stream frames
+ * to a connected phone to compare the cost of the two delivery modes.
+ * Any draw_* run also reports "draw_check": fast against reference draw
+ * kernel mismatches, which must be 0. "render_full" and "render_text" time
+ * whole LVGL frames, split into render and flush time, on the panel.
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// Runs one benchmark by name ("all" runs every one); false if unknown
+bool run_bench(const char *name, JsonObject results);
+
+#endif // BENCH_H
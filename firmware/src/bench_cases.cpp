@@ -0,0 +1,133 @@
+/**
+ * Pipeline benchmark kernels - see bench_cases.h
+ */
+
+#include "bench_cases.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "draw_kernels.h"
+#include "frame_codec.h"
+#include "protocol.h"
+
+namespace BenchCases {
+
+const char SAMPLE_MESSAGE[] =
+    "{\"type\":\"notification\",\"app\":\"Chat\",\"title\":\"Alice\","
+    "\"message\":\"Lunch at noon? The usual place.\",\"priority\":\"normal\","
+    "\"seq\":42}";
+const size_t SAMPLE_LENGTH = sizeof(SAMPLE_MESSAGE) - 1;
+
+namespace {
+
+// Results go through here so the optimizer cannot drop the work
+volatile uint32_t sink = 0;
+
+uint32_t crc16(int iterations) {
+  static uint8_t block[Constants::Usb::MAX_PAYLOAD];
+  for (size_t i = 0; i < sizeof(block); i++) {
+    block[i] = i * 31;
+  }
+  for (int i = 0; i < iterations; i++) {
+    sink = crc16_ccitt(block, sizeof(block));
+  }
+  return iterations * sizeof(block);
+}
+
+uint32_t frame_encode(int iterations) {
+  static uint8_t frame[Constants::Usb::MAX_ENCODED];
+  const uint8_t *body = reinterpret_cast<const uint8_t *>(SAMPLE_MESSAGE);
+  for (int i = 0; i < iterations; i++) {
+    sink = encode_frame(FrameKind::Json, body, SAMPLE_LENGTH, frame,
+                        sizeof(frame));
+  }
+  return iterations * SAMPLE_LENGTH;
+}
+
+uint32_t protocol_decode(int iterations) {
+  static Protocol::Message message;
+  for (int i = 0; i < iterations; i++) {
+    sink = Protocol::decode_json(SAMPLE_MESSAGE, SAMPLE_LENGTH, message);
+  }
+  return iterations * SAMPLE_LENGTH;
+}
+
+uint32_t protocol_encode(int iterations) {
+  static Protocol::Message message;
+  static char out[256];
+  Protocol::decode_json(SAMPLE_MESSAGE, SAMPLE_LENGTH, message);
+  uint32_t bytes = 0;
+  for (int i = 0; i < iterations; i++) {
+    size_t length = Protocol::encode_json(message, out, sizeof(out));
+    sink = length;
+    bytes += length;
+  }
+  return bytes;
+}
+
+// One LVGL partial draw buffer's worth of pixels (LV_DRAW_BUF_SIZE_PREFERRED)
+const int32_t DRAW_W = 128;
+const int32_t DRAW_H = 40;
+const int32_t DRAW_PIXELS = DRAW_W * DRAW_H;
+const uint32_t DRAW_BYTES = DRAW_PIXELS * sizeof(uint16_t);
+
+// Scratch for the draw kernels: the area and an image (room for XRGB8888).
+// From the heap rather than .bss; kept, like the static buffers above
+uint16_t *draw_area() {
+  static uint16_t *area =
+      static_cast<uint16_t *>(malloc(DRAW_BYTES + DRAW_PIXELS * 4));
+  return area;
+}
+
+template <bool Reference> uint32_t draw_fill(int iterations) {
+  uint16_t *area = draw_area();
+  if (area == nullptr) {
+    return 0;
+  }
+  for (int i = 0; i < iterations; i++) {
+    (Reference ? draw_fill_rgb565_ref : draw_fill_rgb565)(
+        area, DRAW_W, DRAW_H, DRAW_W * 2, static_cast<uint16_t>(i));
+  }
+  sink = area[DRAW_PIXELS - 1];
+  return iterations * DRAW_BYTES;
+}
+
+// RGB888 (PxSize 3) or XRGB8888 (PxSize 4) image over the whole area
+template <bool Reference, uint8_t PxSize>
+uint32_t draw_image(int iterations) {
+  uint16_t *area = draw_area();
+  if (area == nullptr) {
+    return 0;
+  }
+  uint8_t *image = reinterpret_cast<uint8_t *>(area + DRAW_PIXELS);
+  for (int32_t i = 0; i < DRAW_PIXELS * PxSize; i++) {
+    image[i] = static_cast<uint8_t>(i * 7);
+  }
+  for (int i = 0; i < iterations; i++) {
+    (Reference ? draw_rgb888_to_rgb565_ref : draw_rgb888_to_rgb565)(
+        area, DRAW_W * 2, image, DRAW_W * PxSize, DRAW_W, DRAW_H, PxSize);
+  }
+  sink = area[DRAW_PIXELS - 1];
+  return iterations * DRAW_BYTES;
+}
+
+} // namespace
+
+uint32_t check_draw_kernels() { return draw_kernels_check(0x5EED1234); }
+
+const Case CASES[] = {
+    {"crc16", crc16},
+    {"frame_encode", frame_encode},
+    {"protocol_decode", protocol_decode},
+    {"protocol_encode", protocol_encode},
+    {"draw_fill", draw_fill<false>},
+    {"draw_fill_ref", draw_fill<true>},
+    {"draw_rgb888", draw_image<false, 3>},
+    {"draw_rgb888_ref", draw_image<true, 3>},
+    {"draw_xrgb8888", draw_image<false, 4>},
+    {"draw_xrgb8888_ref", draw_image<true, 4>},
+};
+const size_t CASE_COUNT = sizeof(CASES) / sizeof(CASES[0]);
+
+} // namespace BenchCases
@@ -0,0 +1,43 @@
+/**
+ * Pipeline benchmark kernels shared by the device and the host
+ *
+ * The framing and protocol stages have no Arduino dependency, so the same
+ * kernels run on the device (src/bench.cpp, timed with micros()) and on the
+ * host (tools/host_bench, timed with std::chrono). Comparing both under
+ * each build profile separates compiler effects from target effects.
+ *
+ * The draw_* cases time the RGB565 kernels from draw_kernels.h on one
+ * partial draw buffer, fast version and *_ref side by side; throughput is
+ * framebuffer bytes written.
+ */
+
+#ifndef BENCH_CASES_H
+#define BENCH_CASES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace BenchCases {
+
+const int ITERATIONS = 1000;
+
+// A typical notification, as sent by the phone
+extern const char SAMPLE_MESSAGE[];
+extern const size_t SAMPLE_LENGTH;
+
+struct Case {
+  const char *name;
+  // Runs the kernel; returns the bytes processed for throughput
+  uint32_t (*run)(int iterations);
+};
+
+extern const Case CASES[];
+extern const size_t CASE_COUNT;
+
+// Fast against reference draw kernels; mismatching cases, 0 when exact.
+// Draw timings are only meaningful when this is 0.
+uint32_t check_draw_kernels();
+
+} // namespace BenchCases
+
+#endif // BENCH_CASES_H
@@ -0,0 +1,499 @@
+/**
+ * BLE multi-central session management - see ble_session.h
+ */
+
+#include "ble_session.h"
+
+#include <esp_gatts_api.h>
+
+#include "protocol.h"
+
+SessionManager ble_sessions;
+
+namespace {
+
+// Credit grows only while the TX queue still has room for replies
+bool tx_room(const BleSession &s) {
+  return s.tx_queue.queued() + Constants::Bluetooth::INTERACTIVE_RESERVE <=
+         Constants::Bluetooth::TX_QUEUE_DEPTH;
+}
+
+} // namespace
+
+void SessionManager::begin(BLEServer *server_, BLECharacteristic *tx_) {
+  server = server_;
+  tx = tx_;
+  window_start = millis();
+}
+
+int8_t SessionManager::find(uint16_t conn_id) const {
+  for (int i = 0; i < Constants::Bluetooth::MAX_CENTRALS; i++) {
+    if (sessions[i].active && sessions[i].conn_id == conn_id) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+BleSession *SessionManager::session(int8_t peer) {
+  if (peer < 0 || peer >= Constants::Bluetooth::MAX_CENTRALS ||
+      !sessions[peer].active) {
+    return nullptr;
+  }
+  return &sessions[peer];
+}
+
+int8_t SessionManager::open(uint16_t conn_id) {
+  int8_t peer = -1;
+
+  portENTER_CRITICAL(&lock);
+  for (int i = 0; i < Constants::Bluetooth::MAX_CENTRALS; i++) {
+    if (!sessions[i].active) {
+      peer = i;
+      break;
+    }
+  }
+  if (peer >= 0) {
+    BleSession &s = sessions[peer];
+    memset(&s, 0, sizeof(s));
+    s.active = true;
+    s.conn_id = conn_id;
+    s.tx_queue.clear();
+    s.mtu = Constants::Bluetooth::DEFAULT_MTU;
+    s.connected_at = millis();
+    connected++;
+    push_event(SessionEventType::Connected, peer);
+  }
+  portEXIT_CRITICAL(&lock);
+
+  return peer;
+}
+
+void SessionManager::close(uint16_t conn_id) {
+  portENTER_CRITICAL(&lock);
+  int8_t peer = find(conn_id);
+  if (peer >= 0) {
+    sessions[peer].active = false;
+    sessions[peer].tx_queue.clear();
+    sessions[peer].rx_length = 0;
+    connected--;
+    push_event(SessionEventType::Disconnected, peer);
+  }
+  portEXIT_CRITICAL(&lock);
+}
+
+void SessionManager::set_mtu(uint16_t conn_id, uint16_t mtu) {
+  portENTER_CRITICAL(&lock);
+  int8_t peer = find(conn_id);
+  if (peer >= 0) {
+    sessions[peer].mtu = mtu;
+  }
+  portEXIT_CRITICAL(&lock);
+}
+
+void SessionManager::on_write(uint16_t conn_id, const uint8_t *data,
+                              size_t length) {
+  portENTER_CRITICAL(&lock);
+  int8_t peer = find(conn_id);
+  if (peer >= 0) {
+    BleSession &s = sessions[peer];
+    if (s.rx_length + length > sizeof(s.rx_buffer)) {
+      // Peer is writing faster than loop() parses - drop the stale partial
+      s.stats.rx_overflows++;
+      s.rx_length = 0;
+    }
+    if (length <= sizeof(s.rx_buffer)) {
+      memcpy(s.rx_buffer + s.rx_length, data, length);
+      s.rx_length += length;
+      s.rx_credit.received(length);
+      s.stats.bytes_received += length;
+    }
+  }
+  portEXIT_CRITICAL(&lock);
+}
+
+void SessionManager::on_confirm(uint16_t conn_id, bool ok) {
+  portENTER_CRITICAL(&lock);
+  int8_t peer = find(conn_id);
+  if (peer >= 0) {
+    BleSession &s = sessions[peer];
+    if (s.notify_confirms > 0) {
+      s.notify_confirms--;
+    } else if (s.indication_pending) {
+      s.indication_pending = false;
+      if (ok) {
+        uint32_t elapsed = millis() - s.indication_sent_at;
+        s.stats.indications_confirmed++;
+        s.stats.confirm_ms_total += elapsed;
+        if (elapsed > s.stats.max_confirm_ms) {
+          s.stats.max_confirm_ms = elapsed;
+        }
+      } else {
+        s.stats.indications_failed++;
+      }
+      report_indication(s, peer, ok);
+    }
+  }
+  portEXIT_CRITICAL(&lock);
+}
+
+// Caller holds the lock. Settles a tracked indication that is no longer
+// pending.
+void SessionManager::report_indication(BleSession &s, int8_t peer, bool ok) {
+  if (s.track_pending) {
+    s.track_pending = false;
+    push_event(ok ? SessionEventType::Delivered
+                  : SessionEventType::Undelivered,
+               peer);
+  }
+}
+
+// Caller holds the lock
+void SessionManager::push_event(SessionEventType type, int8_t peer) {
+  const uint8_t capacity = sizeof(events) / sizeof(events[0]);
+  if (event_count < capacity) {
+    events[(event_head + event_count) % capacity] = {type, peer};
+    event_count++;
+  }
+}
+
+bool SessionManager::poll_event(SessionEvent &event) {
+  bool found = false;
+  portENTER_CRITICAL(&lock);
+  if (event_count > 0) {
+    event = events[event_head];
+    event_head = (event_head + 1) % (sizeof(events) / sizeof(events[0]));
+    event_count--;
+    found = true;
+  }
+  portEXIT_CRITICAL(&lock);
+  return found;
+}
+
+// Pulls one complete JSON object out of the reassembly buffer. Writes may
+// split a message across several ATT packets, so braces are balanced while
+// skipping over string contents. The byte in front of the object names its
+// channel; frames without one (older apps) count as chat.
+bool SessionManager::extract_frame(BleSession &s, char *out, size_t capacity) {
+  uint16_t start = 0;
+  while (start < s.rx_length && s.rx_buffer[start] != '{') {
+    start++;
+  }
+  uint8_t id = start > 0 ? static_cast<uint8_t>(s.rx_buffer[start - 1]) : 0xFF;
+  bool tagged = id < CHANNEL_COUNT;
+  Channel channel = tagged ? static_cast<Channel>(id) : Channel::Chat;
+
+  int depth = 0;
+  bool in_string = false;
+  bool escaped = false;
+  for (uint16_t i = start; i < s.rx_length; i++) {
+    char c = s.rx_buffer[i];
+    if (in_string) {
+      if (escaped) {
+        escaped = false;
+      } else if (c == '\\') {
+        escaped = true;
+      } else if (c == '"') {
+        in_string = false;
+      }
+      continue;
+    }
+
+    if (c == '"') {
+      in_string = true;
+    } else if (c == '{') {
+      depth++;
+    } else if (c == '}' && --depth == 0) {
+      size_t length = i - start + 1;
+      bool fits = length < capacity;
+      if (fits) {
+        memcpy(out, s.rx_buffer + start, length);
+        out[length] = '\0';
+        s.stats.frames_received++;
+        s.tx_queue.note_received(channel, length);
+      } else {
+        s.stats.rx_overflows++;
+      }
+      s.rx_length -= i + 1;
+      memmove(s.rx_buffer, s.rx_buffer + i + 1, s.rx_length);
+      return fits;
+    }
+  }
+
+  // No complete frame yet - discard any noise in front of it, keeping the
+  // channel byte
+  if (tagged) {
+    start--;
+  }
+  if (start > 0) {
+    s.rx_length -= start;
+    memmove(s.rx_buffer, s.rx_buffer + start, s.rx_length);
+  }
+  return false;
+}
+
+bool SessionManager::next_inbound(int8_t &peer, char *out, size_t capacity) {
+  bool found = false;
+  portENTER_CRITICAL(&lock);
+  for (int n = 0; n < Constants::Bluetooth::MAX_CENTRALS && !found; n++) {
+    uint8_t idx = (rx_cursor + n) % Constants::Bluetooth::MAX_CENTRALS;
+    BleSession &s = sessions[idx];
+    if (s.active && s.rx_length > 0 && extract_frame(s, out, capacity)) {
+      peer = idx;
+      found = true;
+    }
+  }
+  rx_cursor = (rx_cursor + 1) % Constants::Bluetooth::MAX_CENTRALS;
+  portEXIT_CRITICAL(&lock);
+  return found;
+}
+
+bool SessionManager::enqueue(int8_t peer, Channel channel, const char *data,
+                             size_t length, bool indicate, bool track) {
+  BleSession *s = session(peer);
+  if (s == nullptr) {
+    return false;
+  }
+
+  // A truncated frame is no use to the phone (broken JSON, a torn mirror
+  // chunk): refuse it whole and let the caller decide
+  if (length > s->max_message()) {
+    portENTER_CRITICAL(&lock);
+    s->stats.frames_dropped++;
+    portEXIT_CRITICAL(&lock);
+    return false;
+  }
+
+  // The credit half of the header is filled in when the frame is sent
+  char frame[Constants::Bluetooth::MAX_FRAME_SIZE];
+  frame[0] = static_cast<char>(channel);
+  memcpy(frame + Constants::Bluetooth::FRAME_HEADER, data, length);
+
+  portENTER_CRITICAL(&lock);
+  bool queued = s->tx_queue.push(channel, frame,
+                                 length + Constants::Bluetooth::FRAME_HEADER,
+                                 millis(), indicate, track);
+  if (!queued) {
+    s->stats.frames_dropped++;
+  }
+  portEXIT_CRITICAL(&lock);
+  return queued;
+}
+
+// Caller holds the lock. Offset the peer may write up to.
+uint16_t SessionManager::credit_limit(BleSession &s) {
+  return s.rx_credit.limit(sizeof(s.rx_buffer) - s.rx_length, tx_room(s));
+}
+
+// Queues a bare "credit" frame when the phone may be waiting on a grant
+// that no other frame is about to carry
+void SessionManager::grant_credit(BleSession &s) {
+  static char frame[Constants::Bluetooth::FRAME_HEADER + 24];
+  static size_t length = 0;
+  if (length == 0) {
+    Protocol::Message credit{};
+    credit.type = Protocol::MessageType::Credit;
+    frame[0] = static_cast<char>(Protocol::channel_of(credit.type));
+    length = Constants::Bluetooth::FRAME_HEADER +
+             Protocol::encode_json(
+                 credit, frame + Constants::Bluetooth::FRAME_HEADER,
+                 sizeof(frame) - Constants::Bluetooth::FRAME_HEADER);
+  }
+
+  portENTER_CRITICAL(&lock);
+  if (s.active && s.tx_queue.queued() == 0 &&
+      s.rx_credit.grant_due(sizeof(s.rx_buffer) - s.rx_length, tx_room(s)) &&
+      s.tx_queue.push(Protocol::channel_of(Protocol::MessageType::Credit),
+                      frame, length, millis(), false)) {
+    s.stats.credit_frames++;
+  }
+  portEXIT_CRITICAL(&lock);
+}
+
+// Drains the per-peer TX queues round-robin, one frame per peer per round,
+// so a chatty session can never monopolise the notify budget. Within a
+// peer the channel scheduler picks which channel's frame goes next, and
+// passes over further indications until the pending one is confirmed.
+void SessionManager::service_tx() {
+  if (server == nullptr || tx == nullptr) {
+    return;
+  }
+
+  uint32_t now = millis();
+  int budget = Constants::Bluetooth::TX_FRAMES_PER_LOOP;
+  bool progress = true;
+
+  for (auto &s : sessions) {
+    grant_credit(s);
+  }
+
+  while (budget > 0 && progress) {
+    progress = false;
+    for (int n = 0; n < Constants::Bluetooth::MAX_CENTRALS && budget > 0;
+         n++) {
+      uint8_t idx = (rr_cursor + n) % Constants::Bluetooth::MAX_CENTRALS;
+      BleSession &s = sessions[idx];
+
+      TxFrame frame;
+      Channel channel;
+      uint16_t conn_id = 0;
+      bool have_frame = false;
+      portENTER_CRITICAL(&lock);
+      if (s.active && s.indication_pending &&
+          now - s.indication_sent_at >
+              Constants::Bluetooth::INDICATION_TIMEOUT_MS) {
+        // Lost confirm: unblock, and drop the count that may have hidden it
+        s.indication_pending = false;
+        s.notify_confirms = 0;
+        s.stats.indications_failed++;
+        report_indication(s, idx, false);
+      }
+      if (s.active && s.tx_queue.pop(frame, channel, s.indication_pending)) {
+        conn_id = s.conn_id;
+        have_frame = true;
+        uint16_t limit = credit_limit(s);
+        frame.data[1] = static_cast<char>(limit & 0xFF);
+        frame.data[2] = static_cast<char>(limit >> 8);
+        s.rx_credit.advertise(limit);
+        // Set before sending: the confirm can arrive before the call returns
+        if (frame.indicate) {
+          s.indication_pending = true;
+          s.indication_sent_at = now;
+          s.track_pending = frame.track;
+        } else {
+          s.notify_confirms++;
+        }
+      }
+      portEXIT_CRITICAL(&lock);
+
+      if (!have_frame) {
+        continue;
+      }
+
+      esp_err_t err = esp_ble_gatts_send_indicate(
+          server->getGattsIf(), conn_id, tx->getHandle(), frame.length,
+          reinterpret_cast<uint8_t *>(frame.data), frame.indicate);
+      if (err == ESP_OK) {
+        uint32_t waited = now - frame.enqueued_at;
+        s.stats.frames_sent++;
+        s.stats.window_frames++;
+        s.stats.bytes_sent += frame.length;
+        if (waited > s.stats.max_queue_wait_ms) {
+          s.stats.max_queue_wait_ms = waited;
+        }
+        s.tx_queue.note_sent(channel, frame.length, waited);
+        if (frame.indicate) {
+          s.stats.indications_sent++;
+        }
+      } else {
+        // No confirm event follows a rejected send
+        portENTER_CRITICAL(&lock);
+        if (frame.indicate) {
+          s.indication_pending = false;
+          report_indication(s, idx, false);
+        } else if (s.notify_confirms > 0) {
+          s.notify_confirms--;
+        }
+        portEXIT_CRITICAL(&lock);
+        s.stats.frames_dropped++;
+        s.tx_queue.note_dropped(channel);
+      }
+      budget--;
+      progress = true;
+    }
+    rr_cursor = (rr_cursor + 1) % Constants::Bluetooth::MAX_CENTRALS;
+  }
+
+  if (now - window_start >= Constants::Bluetooth::FAIRNESS_WINDOW_MS) {
+    last_fairness = fairness_index();
+    for (auto &s : sessions) {
+      s.stats.window_frames = 0;
+    }
+    window_start = now;
+  }
+}
+
+bool SessionManager::tx_idle() {
+  bool idle = true;
+  portENTER_CRITICAL(&lock);
+  for (const auto &s : sessions) {
+    if (s.active && (s.tx_queue.queued() > 0 || s.indication_pending)) {
+      idle = false;
+    }
+  }
+  portEXIT_CRITICAL(&lock);
+  return idle;
+}
+
+void SessionManager::note_rx_seq(int8_t peer, uint32_t seq) {
+  BleSession *s = session(peer);
+  if (s == nullptr) {
+    return;
+  }
+  if (s->rx_seq != 0 && seq != s->rx_seq + 1) {
+    s->stats.seq_gaps++;
+  }
+  s->rx_seq = seq;
+}
+
+// Jain's fairness index over frames delivered to each active peer in the
+// current window: 1.0 means every peer got an equal share.
+float SessionManager::fairness_index() {
+  float sum = 0.0f;
+  float sum_sq = 0.0f;
+  int n = 0;
+  for (const auto &s : sessions) {
+    if (!s.active) {
+      continue;
+    }
+    float x = s.stats.window_frames;
+    sum += x;
+    sum_sq += x * x;
+    n++;
+  }
+  if (n < 2 || sum_sq == 0.0f) {
+    return 1.0f;
+  }
+  return (sum * sum) / (n * sum_sq);
+}
+
+void SessionManager::print_stats() {
+  Serial.printf("BLE peers: %d | fairness %.2f\n", connected, last_fairness);
+  for (int i = 0; i < Constants::Bluetooth::MAX_CENTRALS; i++) {
+    const BleSession &s = sessions[i];
+    if (!s.active) {
+      continue;
+    }
+    Serial.printf("  peer %d conn %d mtu %d | tx %u (%u B, %u dropped, max "
+                  "wait %u ms) | rx %u (%u B, %u overflows, %u gaps)\n",
+                  i, s.conn_id, s.mtu, s.stats.frames_sent, s.stats.bytes_sent,
+                  s.stats.frames_dropped, s.stats.max_queue_wait_ms,
+                  s.stats.frames_received, s.stats.bytes_received,
+                  s.stats.rx_overflows, s.stats.seq_gaps);
+    Serial.printf("    rx credit %d B open (%u standalone grants)\n",
+                  s.rx_credit.open(),
+                  s.stats.credit_frames);
+    if (s.stats.indications_sent > 0) {
+      uint32_t confirmed = s.stats.indications_confirmed;
+      Serial.printf("    indications %u/%u confirmed (%u failed, avg %u ms, "
+                    "max %u ms)\n",
+                    confirmed, s.stats.indications_sent,
+                    s.stats.indications_failed,
+                    confirmed > 0 ? s.stats.confirm_ms_total / confirmed : 0,
+                    s.stats.max_confirm_ms);
+    }
+    for (uint8_t c = 0; c < CHANNEL_COUNT; c++) {
+      Channel channel = static_cast<Channel>(c);
+      const ChannelStats &cs = s.tx_queue.stats(channel);
+      if (cs.frames_sent + cs.frames_received + cs.frames_dropped == 0) {
+        continue;
+      }
+      Serial.printf("    %-11s tx %u (%u B, %u dropped, max wait %u ms) | "
+                    "rx %u (%u B) | queued %u\n",
+                    Protocol::channel_name(channel), cs.frames_sent,
+                    cs.bytes_sent, cs.frames_dropped, cs.max_wait_ms,
+                    cs.frames_received, cs.bytes_received,
+                    s.tx_queue.queued(channel));
+    }
+  }
+}
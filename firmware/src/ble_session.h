@@ -0,0 +1,161 @@
+/**
+ * BLE multi-central session management
+ *
+ * Every connected central (phone, tablet, ...) gets its own BleSession with
+ * negotiated MTU, a reassembly buffer for inbound writes, per-channel
+ * outbound queues (see channel_scheduler.h) and sequence counters. BLE stack
+ * callbacks only copy bytes into the session; parsing and notifying happen
+ * from loop() so that LVGL and the application state are never touched from
+ * the Bluetooth task.
+ *
+ * Inbound writes are flow controlled by credit. Every outbound frame header
+ * carries the byte offset (u16, wrapping) up to which the phone may write:
+ * bytes received so far plus free reassembly space, frozen while the TX
+ * queue has no room left for replies. The phone never writes past the
+ * latest offset, so a fast sender cannot overrun the buffer. When parsing
+ * frees space and nothing else is queued, a "credit" frame carries the grant
+ * (credit_window.h decides when one is worth sending).
+ */
+
+#ifndef BLE_SESSION_H
+#define BLE_SESSION_H
+
+#include <Arduino.h>
+#include <BLECharacteristic.h>
+#include <BLEServer.h>
+
+#include "channel_scheduler.h"
+#include "constants.h"
+#include "credit_window.h"
+
+// Peer index used to address every connected central at once
+static const int8_t BLE_BROADCAST = -1;
+
+struct SessionStats {
+  uint32_t frames_sent;
+  uint32_t bytes_sent;
+  uint32_t frames_received;
+  uint32_t bytes_received;
+  uint32_t frames_dropped; // TX queue full or larger than the MTU
+  uint32_t rx_overflows;   // Reassembly buffer full
+  uint32_t seq_gaps;       // Missing "seq" values from the peer
+  uint32_t max_queue_wait_ms;
+  uint32_t window_frames; // Frames sent in the current fairness window
+  uint32_t indications_sent;
+  uint32_t indications_confirmed;
+  uint32_t indications_failed; // Error status or ATT timeout
+  uint32_t credit_frames;      // Standalone grants (no frame to ride on)
+  uint32_t confirm_ms_total;   // Send to confirm, summed over confirms
+  uint32_t max_confirm_ms;
+};
+
+struct BleSession {
+  bool active;
+  uint16_t conn_id;
+  uint16_t mtu;
+  uint32_t connected_at;
+  uint32_t tx_seq; // Next sequence number stamped on outbound frames
+  uint32_t rx_seq; // Last sequence number received from the peer
+
+  char rx_buffer[Constants::Bluetooth::RX_BUFFER_SIZE];
+  uint16_t rx_length;
+  CreditWindow rx_credit;
+
+  ChannelScheduler tx_queue;
+  // Bluedroid raises a confirm event for every notification once it is
+  // sent and for an indication once the peer confirms it; counting the
+  // notifications still owed one tells the two apart
+  bool indication_pending;
+  uint32_t indication_sent_at;
+  uint8_t notify_confirms; // Confirm events still due for notifications
+  bool track_pending;      // The pending indication reports its outcome
+
+  SessionStats stats;
+
+  // Largest notification payload the peer accepts
+  uint16_t max_payload() const {
+    uint16_t payload = mtu > 3 ? mtu - 3 : 20;
+    return payload < Constants::Bluetooth::MAX_FRAME_SIZE
+               ? payload
+               : Constants::Bluetooth::MAX_FRAME_SIZE;
+  }
+  // Largest message per frame, after the channel id and credit
+  uint16_t max_message() const {
+    return max_payload() - Constants::Bluetooth::FRAME_HEADER;
+  }
+  // Phones request a larger MTU shortly after connecting; until then (or
+  // MTU_WAIT_MS without a request) most messages would not fit a frame
+  bool ready(uint32_t now) const {
+    return mtu > Constants::Bluetooth::DEFAULT_MTU ||
+           now - connected_at > Constants::Bluetooth::MTU_WAIT_MS;
+  }
+};
+
+// Delivered / Undelivered report a tracked indication (see enqueue)
+enum class SessionEventType : uint8_t {
+  Connected,
+  Disconnected,
+  Delivered,
+  Undelivered
+};
+
+struct SessionEvent {
+  SessionEventType type;
+  int8_t peer;
+};
+
+class SessionManager {
+public:
+  void begin(BLEServer *server, BLECharacteristic *tx_characteristic);
+
+  // Called from the BLE task
+  int8_t open(uint16_t conn_id);
+  void close(uint16_t conn_id);
+  void set_mtu(uint16_t conn_id, uint16_t mtu);
+  void on_write(uint16_t conn_id, const uint8_t *data, size_t length);
+  void on_confirm(uint16_t conn_id, bool ok);
+
+  // Called from loop()
+  bool poll_event(SessionEvent &event);
+  bool next_inbound(int8_t &peer, char *out, size_t capacity);
+  // A tracked indication raises Delivered once the peer confirms it, or
+  // Undelivered when the send fails or the confirm times out
+  bool enqueue(int8_t peer, Channel channel, const char *data, size_t length,
+               bool indicate = false, bool track = false);
+  void service_tx();
+  bool tx_idle(); // Every queue empty and no indication awaiting a confirm
+  void note_rx_seq(int8_t peer, uint32_t seq);
+  float fairness_index();
+  void print_stats();
+
+  int connected_count() const { return connected; }
+  bool is_connected() const { return connected > 0; }
+  BleSession *session(int8_t peer);
+
+private:
+  int8_t find(uint16_t conn_id) const;
+  bool extract_frame(BleSession &s, char *out, size_t capacity);
+  void push_event(SessionEventType type, int8_t peer);
+  void report_indication(BleSession &s, int8_t peer, bool ok);
+  uint16_t credit_limit(BleSession &s);
+  void grant_credit(BleSession &s);
+
+  BLEServer *server = nullptr;
+  BLECharacteristic *tx = nullptr;
+  BleSession sessions[Constants::Bluetooth::MAX_CENTRALS] = {};
+  volatile int connected = 0;
+  uint8_t rr_cursor = 0; // Round-robin start for fair TX draining
+  uint8_t rx_cursor = 0; // Round-robin start for fair RX parsing
+  uint32_t window_start = 0;
+  float last_fairness = 1.0f;
+
+  SessionEvent events[Constants::Bluetooth::MAX_CENTRALS * 3] = {};
+  uint8_t event_head = 0;
+  uint8_t event_count = 0;
+
+  portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+};
+
+extern SessionManager ble_sessions;
+
+#endif // BLE_SESSION_H
@@ -0,0 +1,224 @@
+/**
+ * Minimal HTTP/1.1 bulk-transfer endpoint - see bulk_http.h
+ */
+
+#include "bulk_http.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+namespace {
+const size_t HEADER_CAPACITY = 512;
+
+const char *reason_phrase(int status) {
+  switch (status) {
+  case 200:
+    return "OK";
+  case 201:
+    return "Created";
+  case 400:
+    return "Bad Request";
+  case 401:
+    return "Unauthorized";
+  case 404:
+    return "Not Found";
+  case 411:
+    return "Length Required";
+  case 413:
+    return "Payload Too Large";
+  default:
+    return "Internal Server Error";
+  }
+}
+
+// Asset names become SPIFFS paths: no directories, no dot-dot tricks
+bool valid_name(const char *name) {
+  size_t length = strlen(name);
+  if (length == 0 || length > Constants::WiFi::BULK_MAX_NAME_LENGTH ||
+      name[0] == '.') {
+    return false;
+  }
+  for (size_t i = 0; i < length; i++) {
+    char c = name[i];
+    if (!isalnum(static_cast<unsigned char>(c)) && c != '.' && c != '_' &&
+        c != '-') {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Copies the value of a header from the header block; false if absent
+bool find_header(const char *headers, const char *name, char *out,
+                 size_t capacity) {
+  size_t name_length = strlen(name);
+  for (const char *line = headers; *line != '\0';) {
+    const char *end = strstr(line, "\r\n");
+    if (end == nullptr) {
+      end = line + strlen(line);
+    }
+    if (strncasecmp(line, name, name_length) == 0 &&
+        line[name_length] == ':') {
+      const char *value = line + name_length + 1;
+      while (*value == ' ') {
+        value++;
+      }
+      snprintf(out, capacity, "%.*s", static_cast<int>(end - value), value);
+      return true;
+    }
+    line = *end != '\0' ? end + 2 : end;
+  }
+  return false;
+}
+} // namespace
+
+void BulkServer::begin(const char *token) {
+  snprintf(session_token, sizeof(session_token), "%s", token);
+  counters = {};
+}
+
+BulkResult BulkServer::respond(BulkStream &stream, int status,
+                               const char *body) {
+  char head[160];
+  int length = snprintf(head, sizeof(head),
+                        "HTTP/1.1 %d %s\r\nContent-Type: text/plain\r\n"
+                        "Content-Length: %u\r\nConnection: close\r\n\r\n",
+                        status, reason_phrase(status),
+                        static_cast<unsigned>(strlen(body)));
+  stream.write(reinterpret_cast<const uint8_t *>(head), length);
+  stream.write(reinterpret_cast<const uint8_t *>(body), strlen(body));
+  counters.bytes_out += length + strlen(body);
+  if (status >= 400) {
+    counters.rejected++;
+    return BulkResult::Rejected;
+  }
+  return BulkResult::Served;
+}
+
+BulkResult BulkServer::serve(BulkStream &stream, BulkStore &store) {
+  // Read until the blank line; body bytes that arrive with it are kept
+  char header[HEADER_CAPACITY + 1];
+  size_t received = 0;
+  char *body = nullptr;
+  while (body == nullptr) {
+    if (received == HEADER_CAPACITY) {
+      return respond(stream, 413, "header too large\n");
+    }
+    size_t n = stream.read(reinterpret_cast<uint8_t *>(header + received),
+                           HEADER_CAPACITY - received);
+    if (n == 0) {
+      counters.rejected++;
+      return BulkResult::Rejected; // Client went away or stalled
+    }
+    received += n;
+    header[received] = '\0';
+    body = strstr(header, "\r\n\r\n");
+  }
+  counters.requests++;
+  counters.bytes_in += received;
+
+  // Split off the header block and the early body bytes
+  *body = '\0';
+  const uint8_t *early = reinterpret_cast<uint8_t *>(body + 4);
+  size_t early_length = received - (body + 4 - header);
+
+  char method[8];
+  char path[64];
+  if (sscanf(header, "%7s %63s HTTP/1.%*d", method, path) != 2) {
+    return respond(stream, 400, "malformed request line\n");
+  }
+  char *fields = strstr(header, "\r\n");
+  fields = fields != nullptr ? fields + 2 : header + strlen(header);
+
+  char value[64];
+  if (!find_header(fields, "Authorization", value, sizeof(value)) ||
+      strncmp(value, "Bearer ", 7) != 0 ||
+      strcmp(value + 7, session_token) != 0) {
+    return respond(stream, 401, "bad token\n");
+  }
+
+  if (strcmp(method, "GET") == 0 && strcmp(path, "/history") == 0) {
+    return send_history(stream, store);
+  }
+  if (strcmp(method, "POST") == 0 && strcmp(path, "/done") == 0) {
+    respond(stream, 200, "bye\n");
+    return BulkResult::Done;
+  }
+  if (strcmp(method, "PUT") != 0) {
+    return respond(stream, 404, "unknown endpoint\n");
+  }
+
+  BulkTarget target;
+  const char *name = "";
+  if (strcmp(path, "/ota") == 0) {
+    target = BulkTarget::Firmware;
+  } else if (strncmp(path, "/files/", 7) == 0 && valid_name(path + 7)) {
+    target = BulkTarget::File;
+    name = path + 7;
+  } else {
+    return respond(stream, 404, "unknown endpoint\n");
+  }
+
+  if (!find_header(fields, "Content-Length", value, sizeof(value))) {
+    return respond(stream, 411, "content-length required\n");
+  }
+  size_t length = strtoul(value, nullptr, 10);
+  if (early_length > length) {
+    early_length = length;
+  }
+  return receive_upload(stream, store, target, name, length, early,
+                        early_length);
+}
+
+BulkResult BulkServer::receive_upload(BulkStream &stream, BulkStore &store,
+                                      BulkTarget target, const char *name,
+                                      size_t length, const uint8_t *head,
+                                      size_t head_length) {
+  if (!store.begin_upload(target, name, length)) {
+    return respond(stream, 413, "no space for upload\n");
+  }
+
+  bool ok = head_length == 0 || store.write_upload(head, head_length);
+  size_t remaining = length - head_length;
+  uint8_t chunk[Constants::WiFi::BULK_CHUNK_SIZE];
+  while (ok && remaining > 0) {
+    size_t want = remaining < sizeof(chunk) ? remaining : sizeof(chunk);
+    size_t n = stream.read(chunk, want);
+    if (n == 0) {
+      ok = false; // Stalled mid-body; the partial upload is discarded
+      break;
+    }
+    ok = store.write_upload(chunk, n);
+    remaining -= n;
+    counters.bytes_in += n;
+  }
+
+  if (!store.end_upload(ok)) {
+    return respond(stream, 500, "upload failed\n");
+  }
+  return respond(stream, 201, "stored\n");
+}
+
+BulkResult BulkServer::send_history(BulkStream &stream, BulkStore &store) {
+  // Length is unknown up front, so the body ends when the connection closes
+  static const char head[] = "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\n"
+                             "Connection: close\r\n\r\n";
+  stream.write(reinterpret_cast<const uint8_t *>(head), sizeof(head) - 1);
+  counters.bytes_out += sizeof(head) - 1;
+
+  uint8_t chunk[Constants::WiFi::BULK_CHUNK_SIZE];
+  size_t offset = 0;
+  size_t n;
+  while ((n = store.read_history(offset, chunk, sizeof(chunk))) > 0) {
+    if (stream.write(chunk, n) != n) {
+      counters.rejected++;
+      return BulkResult::Rejected;
+    }
+    offset += n;
+    counters.bytes_out += n;
+  }
+  return BulkResult::Served;
+}
@@ -0,0 +1,88 @@
+/**
+ * Minimal HTTP/1.1 bulk-transfer endpoint
+ *
+ * Large payloads (firmware images, assets, full history dumps) are far too
+ * slow over BLE, so the phone switches to the device's soft-AP and talks
+ * plain HTTP instead:
+ *
+ *   GET  /history       message history as text
+ *   PUT  /files/<name>  store an asset on SPIFFS
+ *   PUT  /ota           stream a firmware image into the update partition
+ *   POST /done          end the session, radio goes back off
+ *
+ * Every request carries "Authorization: Bearer <token>" with the one-time
+ * token handed out over BLE. One request per connection. The server only
+ * sees the BulkStream / BulkStore interfaces, so the same code runs behind
+ * WiFiClient on the device and behind a POSIX socket on a Linux host
+ * (tools/bulk_host) for testing over localhost.
+ */
+
+#ifndef BULK_HTTP_H
+#define BULK_HTTP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "constants.h"
+
+// Byte transport for one client connection
+class BulkStream {
+public:
+  virtual ~BulkStream() = default;
+
+  // Blocks up to the I/O timeout; returns 0 on timeout or close
+  virtual size_t read(uint8_t *buffer, size_t length) = 0;
+  virtual size_t write(const uint8_t *data, size_t length) = 0;
+};
+
+enum class BulkTarget : uint8_t { File, Firmware };
+
+// Storage behind the endpoint (SPIFFS / Update on device, files on host)
+class BulkStore {
+public:
+  virtual ~BulkStore() = default;
+
+  virtual bool begin_upload(BulkTarget target, const char *name,
+                            size_t length) = 0;
+  virtual bool write_upload(const uint8_t *data, size_t length) = 0;
+  virtual bool end_upload(bool complete) = 0;
+
+  // Copies history bytes starting at offset; returns 0 past the end
+  virtual size_t read_history(size_t offset, uint8_t *out,
+                              size_t capacity) = 0;
+};
+
+enum class BulkResult : uint8_t {
+  Served,   // Request handled, keep the session open
+  Rejected, // Malformed, unauthorized or failed request
+  Done,     // Client ended the session
+};
+
+struct BulkStats {
+  uint32_t requests;
+  uint32_t rejected;
+  uint32_t bytes_in;
+  uint32_t bytes_out;
+};
+
+class BulkServer {
+public:
+  void begin(const char *session_token);
+  BulkResult serve(BulkStream &stream, BulkStore &store);
+
+  const char *token() const { return session_token; }
+  const BulkStats &stats() const { return counters; }
+
+private:
+  BulkResult respond(BulkStream &stream, int status, const char *body);
+  BulkResult receive_upload(BulkStream &stream, BulkStore &store,
+                            BulkTarget target, const char *name,
+                            size_t length, const uint8_t *head,
+                            size_t head_length);
+  BulkResult send_history(BulkStream &stream, BulkStore &store);
+
+  char session_token[Constants::WiFi::BULK_TOKEN_LENGTH + 1] = {};
+  BulkStats counters = {};
+};
+
+#endif // BULK_HTTP_H
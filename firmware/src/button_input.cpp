@@ -0,0 +1,108 @@
+/**
+ * Interrupt-driven hardware button - see button_input.h
+ */
+
+#include "button_input.h"
+
+#include <esp_task_wdt.h>
+
+#include "constants.h"
+#include "stall_monitor.h"
+#include "ui_events.h"
+
+using ace_button::AceButton;
+using ace_button::ButtonConfig;
+
+ButtonInput button_input;
+
+void ButtonInput::begin(uint8_t button_pin) {
+  pin = button_pin;
+  pinMode(pin, INPUT_PULLUP);
+
+  config.setEventHandler(on_button_event);
+  config.setFeature(ButtonConfig::kFeatureClick);
+  config.setFeature(ButtonConfig::kFeatureDoubleClick);
+  config.setFeature(ButtonConfig::kFeatureLongPress);
+  // A double-click must not also scroll forward first
+  config.setFeature(ButtonConfig::kFeatureSuppressClickBeforeDoubleClick);
+  config.setFeature(ButtonConfig::kFeatureSuppressAfterDoubleClick);
+  config.setFeature(ButtonConfig::kFeatureSuppressAfterLongPress);
+  config.setDebounceDelay(Constants::Buttons::DEBOUNCE_MS);
+  config.setClickDelay(Constants::Buttons::CLICK_MS);
+  config.setDoubleClickDelay(Constants::Buttons::DOUBLE_CLICK_MS);
+  config.setLongPressDelay(Constants::Buttons::LONG_PRESS_MS);
+  button.init(&config, pin, HIGH);
+
+  xTaskCreatePinnedToCore(task_main, "buttons",
+                          Constants::Buttons::TASK_STACK_SIZE, this,
+                          Constants::Buttons::TASK_PRIORITY, &task,
+                          ARDUINO_RUNNING_CORE);
+  attachInterruptArg(pin, on_edge, this, CHANGE);
+}
+
+void IRAM_ATTR ButtonInput::on_edge(void *arg) {
+  ButtonInput *self = static_cast<ButtonInput *>(arg);
+  self->last_edge_us = esp_timer_get_time();
+  self->edge_count++;
+
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(self->task, &woken);
+  portYIELD_FROM_ISR(woken);
+}
+
+void ButtonInput::task_main(void *arg) {
+  ButtonInput *self = static_cast<ButtonInput *>(arg);
+  // Released and past the double-click window: the gesture is resolved
+  const uint32_t settle_us =
+      (Constants::Buttons::DOUBLE_CLICK_MS + Constants::Buttons::DEBOUNCE_MS) *
+      1000;
+  // One iteration is one AceButton sample and the events it raises
+  int8_t lane =
+      stall_monitor.watch("buttons", Constants::Watchdog::BUTTON_SLO_US,
+                          Constants::Watchdog::BUTTON_STALL_MS);
+  // A sample that never returns is left to the task watchdog, so idle
+  // waits wake up to feed it
+  esp_task_wdt_add(nullptr);
+  const TickType_t feed_ticks =
+      pdMS_TO_TICKS(Constants::Watchdog::TASK_WDT_FEED_MS);
+
+  while (true) {
+    esp_task_wdt_reset();
+    if (ulTaskNotifyTake(pdTRUE, feed_ticks) == 0) {
+      continue;
+    }
+    do {
+      stall_monitor.start(lane);
+      self->button.check();
+      stall_monitor.finish(lane);
+      esp_task_wdt_reset();
+      vTaskDelay(pdMS_TO_TICKS(Constants::Buttons::SAMPLE_MS));
+    } while (digitalRead(self->pin) == LOW ||
+             static_cast<uint32_t>(esp_timer_get_time()) -
+                     self->last_edge_us <
+                 settle_us);
+    stall_monitor.start(lane);
+    self->button.check();
+    stall_monitor.finish(lane);
+  }
+}
+
+void ButtonInput::on_button_event(AceButton * /*button*/, uint8_t type,
+                                  uint8_t /*state*/) {
+  // Latency is measured from the edge that completed the gesture
+  uint32_t edge_us = button_input.last_edge_us;
+  switch (type) {
+  case AceButton::kEventClicked:
+    ui_events.post(UiEventType::NextMessage, UiEventSource::Button, edge_us);
+    break;
+  case AceButton::kEventDoubleClicked:
+    ui_events.post(UiEventType::PreviousMessage, UiEventSource::Button,
+                   edge_us);
+    break;
+  case AceButton::kEventLongPressed:
+    ui_events.post(UiEventType::QuickAction, UiEventSource::Button, edge_us);
+    break;
+  default:
+    break;
+  }
+}
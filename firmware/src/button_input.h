@@ -0,0 +1,42 @@
+/**
+ * Interrupt-driven hardware button with AceButton gesture recognition
+ *
+ * A GPIO edge interrupt wakes a small task that samples the button through
+ * AceButton only while a gesture is in progress (held down, or inside the
+ * double-click window); otherwise the task sleeps and nothing polls the pin.
+ * Recognized gestures go to the UI event queue:
+ *
+ * - click: next message
+ * - double-click: previous message
+ * - long press: quick action to the phone
+ */
+
+#ifndef BUTTON_INPUT_H
+#define BUTTON_INPUT_H
+
+#include <AceButton.h>
+#include <Arduino.h>
+
+class ButtonInput {
+public:
+  void begin(uint8_t button_pin);
+
+  uint32_t edges() const { return edge_count; }
+
+private:
+  static void IRAM_ATTR on_edge(void *arg);
+  static void task_main(void *arg);
+  static void on_button_event(ace_button::AceButton *button, uint8_t type,
+                              uint8_t state);
+
+  ace_button::ButtonConfig config;
+  ace_button::AceButton button;
+  TaskHandle_t task = nullptr;
+  uint8_t pin = 0;
+  volatile uint32_t last_edge_us = 0;
+  volatile uint32_t edge_count = 0;
+};
+
+extern ButtonInput button_input;
+
+#endif // BUTTON_INPUT_H
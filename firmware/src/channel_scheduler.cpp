@@ -0,0 +1,162 @@
+/**
+ * Virtual channels with deficit round robin - see channel_scheduler.h
+ */
+
+#include "channel_scheduler.h"
+
+#include <string.h>
+
+namespace {
+
+struct ChannelConfig {
+  uint8_t weight;
+  bool interactive;
+};
+
+// Indexed by Channel
+const ChannelConfig CHANNELS[] = {
+    {4, true},  // Chat
+    {4, true},  // Control
+    {2, false}, // Diagnostics
+    {1, false}, // Logs
+    {2, false}, // Ota
+    {2, false}, // Asset
+    {1, false}, // Mirror
+};
+static_assert(sizeof(CHANNELS) / sizeof(CHANNELS[0]) == CHANNEL_COUNT,
+              "one config per channel in protocol/schema.json");
+
+const int32_t QUANTUM = Constants::Bluetooth::MAX_FRAME_SIZE;
+
+} // namespace
+
+uint8_t ChannelScheduler::weight(Channel channel) {
+  return CHANNELS[static_cast<uint8_t>(channel)].weight;
+}
+
+bool ChannelScheduler::interactive(Channel channel) {
+  return CHANNELS[static_cast<uint8_t>(channel)].interactive;
+}
+
+void ChannelScheduler::clear() {
+  for (int i = 0; i < Constants::Bluetooth::TX_QUEUE_DEPTH; i++) {
+    pool[i].next = i + 1 < Constants::Bluetooth::TX_QUEUE_DEPTH ? i + 1 : -1;
+  }
+  free_head = 0;
+  used = 0;
+  for (Queue &queue : queues) {
+    queue = {-1, -1, 0, true, 0};
+  }
+  current = 0;
+  memset(counters, 0, sizeof(counters));
+}
+
+bool ChannelScheduler::push(Channel channel, const char *data,
+                            uint16_t length, uint32_t now, bool indicate,
+                            bool track) {
+  uint8_t free_slots = Constants::Bluetooth::TX_QUEUE_DEPTH - used;
+  uint8_t reserve =
+      interactive(channel) ? 0 : Constants::Bluetooth::INTERACTIVE_RESERVE;
+  if (free_slots <= reserve || length > sizeof(pool[0].data)) {
+    note_dropped(channel);
+    return false;
+  }
+
+  int8_t slot = free_head;
+  TxFrame &frame = pool[slot];
+  free_head = frame.next;
+  memcpy(frame.data, data, length);
+  frame.length = length;
+  frame.enqueued_at = now;
+  frame.next = -1;
+  frame.indicate = indicate;
+  frame.track = track;
+
+  Queue &queue = queues[static_cast<uint8_t>(channel)];
+  if (queue.count == 0) {
+    queue.head = slot;
+  } else {
+    pool[queue.tail].next = slot;
+  }
+  queue.tail = slot;
+  queue.count++;
+  used++;
+  return true;
+}
+
+void ChannelScheduler::advance() {
+  current = (current + 1) % CHANNEL_COUNT;
+}
+
+bool ChannelScheduler::pop(TxFrame &out, Channel &channel,
+                           bool hold_indications) {
+  if (used == 0) {
+    return false;
+  }
+  // One quantum always covers a head frame, so any channel that may send
+  // does so within two rounds
+  for (int visits = 0; visits < 2 * CHANNEL_COUNT + 1; visits++) {
+    Queue &queue = queues[current];
+    if (queue.count == 0) {
+      // Idle channels do not bank credit
+      queue.deficit = 0;
+      queue.fresh = true;
+      advance();
+      continue;
+    }
+    if (hold_indications && pool[queue.head].indicate) {
+      // Blocked, not idle: keeps its credit for when the confirm arrives
+      advance();
+      continue;
+    }
+    if (queue.fresh) {
+      queue.deficit += QUANTUM * CHANNELS[current].weight;
+      queue.fresh = false;
+    }
+
+    int8_t slot = queue.head;
+    TxFrame &frame = pool[slot];
+    if (frame.length > queue.deficit) {
+      // Credit left over carries into this channel's next turn
+      queue.fresh = true;
+      advance();
+      continue;
+    }
+
+    queue.deficit -= frame.length;
+    out = frame;
+    channel = static_cast<Channel>(current);
+    queue.head = frame.next;
+    queue.count--;
+    frame.next = free_head;
+    free_head = slot;
+    used--;
+    if (queue.count == 0) {
+      queue.deficit = 0;
+      queue.fresh = true;
+      advance();
+    }
+    return true;
+  }
+  return false;
+}
+
+void ChannelScheduler::note_sent(Channel channel, uint16_t length,
+                                 uint32_t waited_ms) {
+  ChannelStats &stats = counters[static_cast<uint8_t>(channel)];
+  stats.frames_sent++;
+  stats.bytes_sent += length;
+  if (waited_ms > stats.max_wait_ms) {
+    stats.max_wait_ms = waited_ms;
+  }
+}
+
+void ChannelScheduler::note_dropped(Channel channel) {
+  counters[static_cast<uint8_t>(channel)].frames_dropped++;
+}
+
+void ChannelScheduler::note_received(Channel channel, uint16_t length) {
+  ChannelStats &stats = counters[static_cast<uint8_t>(channel)];
+  stats.frames_received++;
+  stats.bytes_received += length;
+}
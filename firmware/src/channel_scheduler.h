@@ -0,0 +1,100 @@
+/**
+ * Virtual channels over the UART service with deficit round robin
+ *
+ * Chat, control, diagnostics, logs, OTA, asset and screen mirror traffic
+ * share the single TX characteristic. Every BLE frame starts with one
+ * channel id byte (ids come from protocol/schema.json), and each peer's
+ * outbound frames wait in per-channel FIFOs that share one frame pool.
+ *
+ * Frames leave by deficit round robin: on its turn a channel earns
+ * weight * QUANTUM bytes of credit and sends head frames while they fit,
+ * so bandwidth splits by weight whatever the frame sizes, and an idle
+ * channel's share goes to the busy ones. The quantum covers a full frame,
+ * so every backlogged channel sends at least one frame per round: a bulk
+ * transfer slows chat down by at most one round, never starves it. The
+ * last INTERACTIVE_RESERVE pool slots are kept for chat and control so a
+ * bulk backlog cannot crowd them out of the queue either.
+ *
+ * ATT allows one unconfirmed indication per link. While one is in flight,
+ * a channel whose head frame is another indication sits out its turns
+ * (keeping its order); notifications on every other channel keep flowing.
+ */
+
+#ifndef CHANNEL_SCHEDULER_H
+#define CHANNEL_SCHEDULER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "constants.h"
+#include "protocol_gen.h"
+
+using Protocol::Channel;
+using Protocol::CHANNEL_COUNT;
+
+// One outbound frame waiting for its notify slot
+struct TxFrame {
+  uint16_t length;
+  uint32_t enqueued_at;
+  int8_t next;   // Next frame of the same channel, or -1
+  bool indicate; // Sent as an indication the peer confirms
+  bool track;    // Its confirm (or loss) raises a session event
+  char data[Constants::Bluetooth::MAX_FRAME_SIZE];
+};
+
+struct ChannelStats {
+  uint32_t frames_sent;
+  uint32_t bytes_sent;
+  uint32_t frames_received;
+  uint32_t bytes_received;
+  uint32_t frames_dropped; // Pool full, or the notify failed
+  uint32_t max_wait_ms;
+};
+
+class ChannelScheduler {
+public:
+  // Also the initialiser: the scheduler lives in zeroed session storage
+  void clear();
+
+  // Copies a frame in; false (and counted as dropped) when full
+  bool push(Channel channel, const char *data, uint16_t length, uint32_t now,
+            bool indicate, bool track = false);
+  // Takes the next frame in DRR order, skipping channels whose head is an
+  // indication while hold_indications; false when nothing can go
+  bool pop(TxFrame &out, Channel &channel, bool hold_indications);
+
+  void note_sent(Channel channel, uint16_t length, uint32_t waited_ms);
+  void note_dropped(Channel channel);
+  void note_received(Channel channel, uint16_t length);
+
+  uint8_t queued() const { return used; }
+  uint8_t queued(Channel channel) const {
+    return queues[static_cast<uint8_t>(channel)].count;
+  }
+  const ChannelStats &stats(Channel channel) const {
+    return counters[static_cast<uint8_t>(channel)];
+  }
+
+  static uint8_t weight(Channel channel);
+  static bool interactive(Channel channel);
+
+private:
+  struct Queue {
+    int8_t head;
+    int8_t tail;
+    uint8_t count;
+    bool fresh; // Earns its quantum when next visited
+    int32_t deficit;
+  };
+
+  void advance();
+
+  TxFrame pool[Constants::Bluetooth::TX_QUEUE_DEPTH];
+  int8_t free_head;
+  uint8_t used;
+  Queue queues[CHANNEL_COUNT];
+  uint8_t current;
+  ChannelStats counters[CHANNEL_COUNT];
+};
+
+#endif // CHANNEL_SCHEDULER_H
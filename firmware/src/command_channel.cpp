@@ -0,0 +1,180 @@
+/**
+ * Batched remote configuration commands - see command_channel.h
+ */
+
+#include "command_channel.h"
+
+#include "constants.h"
+#include "protocol.h"
+#include "settings.h"
+
+namespace {
+
+enum SettingKey : uint8_t {
+  KEY_BRIGHTNESS,
+  KEY_DEVICE_NAME,
+  KEY_STATUS_INTERVAL,
+  KEY_BATTERY_INTERVAL,
+  KEY_COUNT
+};
+
+const char *const SETTING_NAMES[KEY_COUNT] = {
+    "brightness",
+    "device_name",
+    "status_interval_ms",
+    "battery_interval_ms",
+};
+
+int find_key(const char *name) {
+  for (int i = 0; i < KEY_COUNT; i++) {
+    if (strcmp(name, SETTING_NAMES[i]) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+void report(const DeviceSettings &settings, int key, JsonObject results) {
+  switch (key) {
+  case KEY_BRIGHTNESS:
+    results[SETTING_NAMES[key]] = settings.brightness;
+    break;
+  case KEY_DEVICE_NAME:
+    results[SETTING_NAMES[key]] = settings.device_name;
+    break;
+  case KEY_STATUS_INTERVAL:
+    results[SETTING_NAMES[key]] = settings.status_interval_ms;
+    break;
+  case KEY_BATTERY_INTERVAL:
+    results[SETTING_NAMES[key]] = settings.battery_interval_ms;
+    break;
+  }
+}
+
+bool valid_interval(JsonVariantConst value) {
+  if (!value.is<uint32_t>()) {
+    return false;
+  }
+  uint32_t interval = value.as<uint32_t>();
+  return interval >= Constants::Settings::MIN_INTERVAL_MS &&
+         interval <= Constants::Settings::MAX_INTERVAL_MS;
+}
+
+// Applies one set to the staged copy; returns an error string on rejection
+const char *stage(DeviceSettings &settings, int key, JsonVariantConst value) {
+  switch (key) {
+  case KEY_BRIGHTNESS: {
+    if (!value.is<int>() || value.as<int>() < 0 || value.as<int>() > 255) {
+      return "expected integer 0-255";
+    }
+    settings.brightness = value.as<int>();
+    return nullptr;
+  }
+  case KEY_DEVICE_NAME: {
+    const char *name = value.as<const char *>();
+    size_t length = name != nullptr ? strlen(name) : 0;
+    if (length == 0 || length > Constants::Settings::MAX_DEVICE_NAME_LENGTH) {
+      return "expected name of 1-29 characters";
+    }
+    memset(settings.device_name, 0, sizeof(settings.device_name));
+    strlcpy(settings.device_name, name, sizeof(settings.device_name));
+    return nullptr;
+  }
+  case KEY_STATUS_INTERVAL:
+    if (!valid_interval(value)) {
+      return "expected interval 1000-3600000 ms";
+    }
+    settings.status_interval_ms = value.as<uint32_t>();
+    return nullptr;
+  case KEY_BATTERY_INTERVAL:
+    if (!valid_interval(value)) {
+      return "expected interval 1000-3600000 ms";
+    }
+    settings.battery_interval_ms = value.as<uint32_t>();
+    return nullptr;
+  }
+  return "unknown key";
+}
+
+} // namespace
+
+bool run_command_batch(JsonObjectConst request, JsonDocument &response) {
+  response[Constants::JSON::KEY_TYPE] =
+      Protocol::type_name(Protocol::MessageType::CommandResponse);
+  response[Constants::JSON::KEY_ID] = request[Constants::JSON::KEY_ID];
+  JsonObject results =
+      response[Constants::JSON::KEY_RESULTS].to<JsonObject>();
+
+  JsonArrayConst ops = request[Constants::JSON::KEY_OPS];
+  if (ops.isNull() || ops.size() == 0 ||
+      ops.size() > Constants::Settings::MAX_COMMAND_OPS) {
+    response[Constants::JSON::KEY_OK] = false;
+    response[Constants::JSON::KEY_ERRORS][Constants::JSON::KEY_OPS] =
+        "expected 1-16 operations";
+    return false;
+  }
+
+  // Stage every set on a copy so a single bad op rejects the whole batch
+  DeviceSettings staged = device_settings;
+  bool requested[KEY_COUNT] = {};
+  bool failed = false;
+
+  for (JsonObjectConst op : ops) {
+    const char *kind = op[Constants::JSON::KEY_OP] | "";
+    if (strcmp(kind, Constants::JSON::OP_GET_ALL) == 0) {
+      for (bool &flag : requested) {
+        flag = true;
+      }
+      continue;
+    }
+
+    const char *name = op[Constants::JSON::KEY_KEY] | "";
+    int key = find_key(name);
+    const char *error = nullptr;
+
+    if (key < 0) {
+      error = "unknown key";
+    } else if (strcmp(kind, Constants::JSON::OP_GET) == 0) {
+      requested[key] = true;
+    } else if (strcmp(kind, Constants::JSON::OP_SET) == 0) {
+      error = stage(staged, key, op[Constants::JSON::KEY_VALUE]);
+      requested[key] = true;
+    } else {
+      error = "unknown op";
+    }
+
+    if (error != nullptr) {
+      response[Constants::JSON::KEY_ERRORS][name] = error;
+      failed = true;
+    }
+  }
+
+  bool changed = false;
+  bool stored = true;
+  if (!failed && memcmp(&staged, &device_settings, sizeof(staged)) != 0) {
+    device_settings = staged;
+    changed = true;
+    // One flash write for the whole batch
+    // Applied for now, but lost on reboot: the phone must not count the
+    // sync as done
+    if (!save_settings()) {
+      stored = false;
+      response[Constants::JSON::KEY_ERRORS]["storage"] = "write failed";
+    }
+  }
+
+  // Results always reflect the live settings, i.e. the pre-batch values
+  // when the batch was rejected
+  for (int key = 0; key < KEY_COUNT; key++) {
+    if (requested[key]) {
+      report(device_settings, key, results);
+    }
+  }
+
+  response[Constants::JSON::KEY_OK] = !failed && stored;
+  Serial.printf("⚙️ Command batch %s: %d ops%s%s\n",
+                failed ? "rejected" : "ok", ops.size(),
+                changed ? ", settings updated" : "",
+                stored ? "" : ", not saved");
+  return changed;
+}
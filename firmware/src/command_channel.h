@@ -0,0 +1,24 @@
+/**
+ * Batched remote configuration commands
+ *
+ * A "command" message carries a list of get/set operations, e.g.
+ *   {"type":"command","id":7,"ops":[
+ *     {"op":"set","key":"brightness","value":120},
+ *     {"op":"set","key":"device_name","value":"Desk"},
+ *     {"op":"get_all"}]}
+ *
+ * Every set is validated before any is applied, so a batch lands as a whole
+ * or not at all. The batch is answered with one "command_response" and
+ * persisted with one settings write, letting the phone sync its whole
+ * configuration in a single round trip.
+ */
+
+#ifndef COMMAND_CHANNEL_H
+#define COMMAND_CHANNEL_H
+
+#include <ArduinoJson.h>
+
+// Fills `response` and returns true when the stored settings changed
+bool run_command_batch(JsonObjectConst request, JsonDocument &response);
+
+#endif // COMMAND_CHANNEL_H
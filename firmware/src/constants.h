@@ -16,6 +16,63 @@ struct Bluetooth {
   static constexpr const char *DEFAULT_PIN = "1234";
   static const int PAIRING_TIMEOUT_MS = 30000;   // 30 seconds
   static const int RECONNECT_INTERVAL_MS = 5000; // 5 seconds
+
+  // Multi-central sessions
+  static const int MAX_CENTRALS = 3;          // Simultaneous phones/tablets
+  static const int DEFAULT_MTU = 23;          // ATT default before exchange
+  static const int PREFERRED_MTU = 256;       // Requested from every central
+  static const int MAX_FRAME_SIZE = 253;      // PREFERRED_MTU - 3 (ATT header)
+  static const int RX_BUFFER_SIZE = 512;      // Per-peer reassembly buffer
+  static const int TX_QUEUE_DEPTH = 8;        // Per-peer, all channels
+  static const int FRAME_HEADER = 3;          // Channel id + u16 credit
+  static const int CREDIT_UPDATE_BYTES = 128; // Grant growth worth a frame
+  static const int MAX_WRITE_CHUNK = 200;     // App's largest write (App.tsx)
+  static const int INTERACTIVE_RESERVE = 2;   // Slots only chat/control use
+  static const int TX_FRAMES_PER_LOOP = 4;    // Notify budget per loop() pass
+  static const int FAIRNESS_WINDOW_MS = 5000; // Fairness sampling window
+  static const int MTU_WAIT_MS = 3000;        // Ready without MTU exchange
+
+  // Confirmed delivery (indications)
+  static const int INDICATION_TIMEOUT_MS = 30000; // ATT transaction timeout
+  static const int TX_DRAIN_WAIT_MS = 2000;       // Confirms before a reboot
+  static const int READVERTISE_DELAY_MS = 500;    // Stack settles first
+};
+
+struct Usb {
+  // Framed transport on the USB-CDC console (see frame_codec.h)
+  static const int RX_BUFFER_SIZE = 4096;  // CDC driver receive buffer
+  static const int MAX_PAYLOAD = 1024;     // Kind byte + body, before CRC
+  static const int MAX_ENCODED = 1040;     // COBS worst case + CRC + delimiter
+  static const int BYTES_PER_LOOP = 2048;  // RX budget per loop() pass
+  static const int HOST_TIMEOUT_MS = 5000; // Host detached after silence
+};
+
+struct Mirror {
+  // Framebuffer mirror to a phone (see screen_mirror.h)
+  static const int TILE_SIZE = 8;             // Pixels per tile side
+  static const int MAX_TILES = 2048;          // 536x240 needs 67 x 30
+  static const int MAX_FPS = 15;
+  static const int DEFAULT_SHARE_PERCENT = 25;
+  static const int MAX_SHARE_PERCENT = 50;    // Of LINK_BYTES_PER_S
+  static const int LINK_BYTES_PER_S = 32000;  // Nominal notify throughput
+  static const int MAX_QUEUED_FRAMES = 2;     // Mirror frames waiting to send
+};
+
+struct LvglHeap {
+  // LVGL's allocator (see lvgl_heap.h): small blocks from internal slabs
+  static const int SLAB_BYTES = 4096;           // Taken from the heap at once
+  static const int INTERNAL_BUDGET = 48 * 1024; // Slabs stop growing here
+  static const int SMALL_MAX = 256;             // Largest slab block
+};
+
+struct Led {
+  // WS2812 status pixel; the stock board has none (see status_led.h)
+#ifdef STATUS_LED_PIN
+  static const int PIN = STATUS_LED_PIN;
+#else
+  static const int PIN = -1;
+#endif
+  static const int MAX_BRIGHTNESS = 40; // Of 255; a pixel is blinding
 };
 
 struct Battery {
@@ -29,6 +86,42 @@ struct Timing {
   static const int MAIN_LOOP_DELAY_MS = 10;
   static const int MESSAGE_DISPLAY_TIMEOUT_MS = 5000; // 5 seconds
   static const int TOUCH_DEBOUNCE_MS = 200;           // 200ms
+  static const int SCREEN_SLEEP_MS = 60000; // Panel dark after 1 min idle
+};
+
+struct Buttons {
+  // BOOT key, active low; free for the application once the chip is up
+  static const int BOOT_PIN = 0;
+  static const int DEBOUNCE_MS = 20;
+  static const int CLICK_MS = 200;
+  static const int DOUBLE_CLICK_MS = 300;
+  static const int LONG_PRESS_MS = 800;
+  static const int SAMPLE_MS = 5; // AceButton sampling while a gesture runs
+  static const int TASK_STACK_SIZE = 3072;
+  static const int TASK_PRIORITY = 2; // Above loop() so gestures stay timely
+};
+
+struct Watchdog {
+  // Software stall detector, see stall_monitor.h. The ESP-IDF task
+  // watchdog (5 s) watches loop() and the button task behind it.
+  static const int MAX_LANES = 4;
+  static const int POLL_MS = 10;           // Monitor task period (core 0)
+  static const int BACKTRACE_DEPTH = 16;   // Frames kept per stall
+  static const int LOOP_SLO_US = 33000;    // Two 60 Hz frames per pass
+  static const int LOOP_STALL_MS = 250;    // Backtrace past this
+  static const int BUTTON_SLO_US = 2000;   // One AceButton sample
+  static const int BUTTON_STALL_MS = 100;
+  static const int TASK_WDT_FEED_MS = 1000; // Idle button task wake-up
+  static const int TASK_STACK_SIZE = 3072;
+  static const int TASK_PRIORITY = 3; // Above loop() and the button task
+};
+
+struct Touch {
+  // Touch controller interrupt (active low); reads follow it, see
+  // touch_input.h
+  static const int IRQ_PIN = 21;
+  static const int POLL_MS = 10;       // Read rate while a finger is down
+  static const int IDLE_READ_MS = 500; // Safety net if an IRQ is missed
 };
 
 struct UI {
@@ -37,6 +130,8 @@ struct UI {
   static const int BUTTON_SPACING = 10;
   static const int STATUS_BAR_HEIGHT = 30;
   static const int MESSAGE_CONTAINER_HEIGHT = 100;
+  static const int EVENT_QUEUE_DEPTH = 8; // Recognized input gestures
+  static const int HISTORY_LINES = 4;     // Messages on the history view
 
   // Colors (RGB565 format)
   static const uint16_t COLOR_PRIMARY = 0x07E0;    // Green
@@ -57,27 +152,73 @@ struct Messages {
   static constexpr const char *DISCONNECTED_MESSAGE = "Bluetooth disconnected";
 };
 
+struct Notifications {
+  static const int MAX_APPS = 8;              // Coalescing slots, one per app
+  static const int MAX_APP_NAME_LENGTH = 23;
+  static const int MAX_TEXT_LENGTH = 120;
+  static const int BUCKET_CAPACITY = 3;         // Lines shown in one burst
+  static const int REFILL_INTERVAL_MS = 2000;   // One more line every 2 s
+  static const int LOW_PRIORITY_TTL_MS = 30000; // Stale low-priority drop
+};
+
+struct Cache {
+  static const int ENTRIES = 16; // LRU capacity
+  static const int MAX_ANSWER_LENGTH = 200;
+  static const int MAX_PENDING = 4; // Requests awaiting a fresh answer
+  static const int PENDING_TIMEOUT_MS = 30000;
+  static const uint32_t MAX_TTL_MS = 86400000; // Phone TTLs capped at 1 day
+};
+
+struct Outbox {
+  static constexpr const char *FILE_PATH = "/outbox.bin";
+  static const int MAX_ITEMS = 16;
+  static const int MAX_TYPE_LENGTH = 15;
+  static const int MAX_MESSAGE_LENGTH = 63;
+  static const int MAX_ACTION_LENGTH = 15;
+  static const int SEQ_RESERVE = 16;   // Room for the per-peer "seq" field
+};
+
 struct WiFi {
-  // Optional WiFi for future features
+  // On-demand soft-AP for bulk transfers (OTA, images, history export)
   static constexpr const char *AP_SSID = "AI-Companion-Setup";
   static constexpr const char *AP_PASSWORD = "companion123";
   static const int CONNECTION_TIMEOUT_MS = 15000; // 15 seconds
+  static const int BULK_PORT = 8080;
+  static const int BULK_IDLE_TIMEOUT_MS = 60000; // Radio off after 1 minute
+  static const int BULK_IO_TIMEOUT_MS = 5000;    // Stalled client is dropped
+  static const int BULK_CHUNK_SIZE = 1024;
+  static const int BULK_TOKEN_LENGTH = 16;
+  static const int BULK_MAX_NAME_LENGTH = 30; // "/" + name fits SPIFFS
+  static const int BULK_ACCEPT_POLL_MS = 20;  // Listener check between requests
+  static const int BULK_TASK_STACK_SIZE = 6144;
+  static const int BULK_TASK_PRIORITY = 1; // Same as loop(), time-sliced
+  static const int BULK_TASK_CORE = 0;     // With the Wi-Fi stack
 };
 
 struct JSON {
-  // JSON message structure
+  // Keys for the dynamic parts of the protocol that are still read and
+  // built with ArduinoJson. Message types and every other key come from
+  // protocol/schema.json (see protocol.h).
   static constexpr const char *KEY_TYPE = "type";
   static constexpr const char *KEY_MESSAGE = "message";
-  static constexpr const char *KEY_TIMESTAMP = "timestamp";
-  static constexpr const char *KEY_DEVICE_NAME = "device_name";
-  static constexpr const char *KEY_PIN = "pin";
-  static constexpr const char *KEY_MAC = "mac";
 
-  // Message types
-  static constexpr const char *TYPE_CHAT = "chat";
-  static constexpr const char *TYPE_PAIRING = "pairing";
-  static constexpr const char *TYPE_STATUS = "status";
-  static constexpr const char *TYPE_COMMAND = "command";
+  // Command batches
+  static constexpr const char *KEY_ID = "id";
+  static constexpr const char *KEY_OPS = "ops";
+  static constexpr const char *KEY_OP = "op";
+  static constexpr const char *KEY_KEY = "key";
+  static constexpr const char *KEY_VALUE = "value";
+  static constexpr const char *KEY_OK = "ok";
+  static constexpr const char *KEY_RESULTS = "results";
+  static constexpr const char *KEY_ERRORS = "errors";
+  static constexpr const char *OP_GET = "get";
+  static constexpr const char *OP_SET = "set";
+  static constexpr const char *OP_GET_ALL = "get_all";
+
+  // Offline outbox flushes
+  static constexpr const char *KEY_ITEMS = "items";
+  static constexpr const char *KEY_COUNT = "count";
+  static constexpr const char *KEY_ACTION = "action";
 };
 
 struct Storage {
@@ -86,6 +227,18 @@ struct Storage {
   static constexpr const char *KEY_PAIRED_DEVICES = "paired_devices";
   static constexpr const char *KEY_USER_SETTINGS = "user_settings";
 };
+
+struct Settings {
+  static const uint8_t VERSION = 1;                     // Bump on layout change
+  static const uint8_t DEFAULT_BRIGHTNESS = 200;        // 0-255
+  static const int DEFAULT_STATUS_INTERVAL_MS = 30000;  // 30 seconds
+  static const int DEFAULT_BATTERY_INTERVAL_MS = 60000; // 1 minute
+  static const int MIN_INTERVAL_MS = 1000;
+  static const int MAX_INTERVAL_MS = 3600000;   // 1 hour
+  static const int MAX_DEVICE_NAME_LENGTH = 29; // Fits the advertising packet
+  static const int MAX_COMMAND_OPS = 16;
+  static const int SAVE_DELAY_MS = 2000; // Coalesces UI state writes to NVS
+};
 } // namespace Constants
 
 #endif // CONSTANTS_H
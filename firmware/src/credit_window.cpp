@@ -0,0 +1,27 @@
+/**
+ * Receive credit for one BLE peer - see credit_window.h
+ */
+
+#include "credit_window.h"
+
+uint16_t CreditWindow::limit(uint16_t free_space, bool tx_room) {
+  if (tx_room) {
+    uint16_t candidate = total + free_space;
+    if (static_cast<int16_t>(candidate - granted) > 0) {
+      granted = candidate;
+    }
+  }
+  return granted;
+}
+
+bool CreditWindow::grant_due(uint16_t free_space, bool tx_room) {
+  uint16_t growth = limit(free_space, tx_room) - advertised;
+  if (growth == 0) {
+    return false;
+  }
+  // Small grants are batched, unless the phone may already be stuck on a
+  // chunk the open window cannot take: a partial message frees no space
+  // until the rest arrives, and no reply is coming to carry the grant
+  return growth >= Constants::Bluetooth::CREDIT_UPDATE_BYTES ||
+         open() < Constants::Bluetooth::MAX_WRITE_CHUNK;
+}
@@ -0,0 +1,40 @@
+/**
+ * Receive credit for one BLE peer
+ *
+ * The limit is a wrapping byte offset the phone may write up to: the bytes
+ * received so far plus the free reassembly space. It only grows while the
+ * TX queue still has room for replies, and never moves backwards (see
+ * ble_session.h). Pure C++, so tools/credit_sim can run the same rules on
+ * the host against a model of the app's chunked writes.
+ */
+
+#ifndef CREDIT_WINDOW_H
+#define CREDIT_WINDOW_H
+
+#include <stdint.h>
+
+#include "constants.h"
+
+class CreditWindow {
+public:
+  void received(uint16_t bytes) { total += bytes; }
+
+  // Limit to stamp into the next frame
+  uint16_t limit(uint16_t free_space, bool tx_room);
+  // The limit a frame just carried to the peer
+  void advertise(uint16_t sent_limit) { advertised = sent_limit; }
+
+  // Whether a bare grant is worth a frame of its own
+  bool grant_due(uint16_t free_space, bool tx_room);
+
+  // Bytes the peer may still write under the last advertised limit
+  int16_t open() const { return static_cast<int16_t>(advertised - total); }
+
+private:
+  // Zeroed with the session (BleSession is cleared by memset)
+  uint16_t total;      // Bytes accepted from the peer, wrapping
+  uint16_t granted;    // Credit limit; never moves backwards
+  uint16_t advertised; // Last limit stamped into a frame
+};
+
+#endif // CREDIT_WINDOW_H
@@ -0,0 +1,50 @@
+/**
+ * On-device storage behind the bulk transfer paths - see device_store.h
+ */
+
+#include "device_store.h"
+
+#include <SPIFFS.h>
+#include <Update.h>
+
+bool DeviceStore::begin_upload(BulkTarget target, const char *name,
+                               size_t length) {
+  current = target;
+  if (target == BulkTarget::Firmware) {
+    return Update.begin(length, U_FLASH);
+  }
+  if (SPIFFS.totalBytes() - SPIFFS.usedBytes() < length) {
+    return false;
+  }
+  snprintf(path, sizeof(path), "/%s", name);
+  file = SPIFFS.open(path, FILE_WRITE);
+  return static_cast<bool>(file);
+}
+
+bool DeviceStore::write_upload(const uint8_t *data, size_t length) {
+  if (current == BulkTarget::Firmware) {
+    return Update.write(const_cast<uint8_t *>(data), length) == length;
+  }
+  return file.write(data, length) == length;
+}
+
+bool DeviceStore::end_upload(bool complete) {
+  if (current == BulkTarget::Firmware) {
+    if (!complete) {
+      Update.abort();
+      return false;
+    }
+    image_ready = Update.end(true);
+    return image_ready;
+  }
+  file.close();
+  if (!complete) {
+    SPIFFS.remove(path); // Never leave a truncated asset behind
+  }
+  return complete;
+}
+
+size_t DeviceStore::read_history(size_t offset, uint8_t *out,
+                                 size_t capacity) {
+  return history != nullptr ? history(offset, out, capacity) : 0;
+}
@@ -0,0 +1,41 @@
+/**
+ * On-device storage behind the bulk transfer paths
+ *
+ * Assets go to SPIFFS and firmware images to the OTA partition. Shared by the
+ * Wi-Fi endpoint (wifi_bulk.h) and the USB asset upload (usb_link.h) so both
+ * validate, store and clean up uploads the same way.
+ */
+
+#ifndef DEVICE_STORE_H
+#define DEVICE_STORE_H
+
+#include <Arduino.h>
+#include <FS.h>
+
+#include "bulk_http.h"
+
+// Supplies the history export; same contract as BulkStore::read_history
+typedef size_t (*HistoryReader)(size_t offset, uint8_t *out, size_t capacity);
+
+class DeviceStore : public BulkStore {
+public:
+  explicit DeviceStore(HistoryReader history = nullptr) : history(history) {}
+
+  bool begin_upload(BulkTarget target, const char *name,
+                    size_t length) override;
+  bool write_upload(const uint8_t *data, size_t length) override;
+  bool end_upload(bool complete) override;
+  size_t read_history(size_t offset, uint8_t *out, size_t capacity) override;
+
+  // A complete image was verified and will boot after a restart
+  bool firmware_ready() const { return image_ready; }
+
+private:
+  HistoryReader history;
+  BulkTarget current = BulkTarget::File;
+  bool image_ready = false;
+  char path[Constants::WiFi::BULK_MAX_NAME_LENGTH + 2] = {};
+  File file;
+};
+
+#endif // DEVICE_STORE_H
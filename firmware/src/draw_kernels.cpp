@@ -0,0 +1,306 @@
+/**
+ * RGB565 draw kernels - see draw_kernels.h
+ */
+
+#include "draw_kernels.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+#include <sdkconfig.h>
+#endif
+
+#if defined(CONFIG_IDF_TARGET_ESP32S3) && defined(__XTENSA__)
+#define DRAW_KERNELS_PIE 1
+#endif
+
+namespace {
+
+// Two RGB565 pixels in one store; may_alias keeps the pixel buffers legal
+typedef uint32_t __attribute__((may_alias)) PixelPair;
+
+inline uint16_t *next_row(uint16_t *row, int32_t stride) {
+  return reinterpret_cast<uint16_t *>(reinterpret_cast<uint8_t *>(row) +
+                                      stride);
+}
+
+// One little-endian word per pixel: B, G, R in bits 0-23
+inline uint16_t xrgb_pixel(const uint8_t *in) {
+  uint32_t pixel;
+  memcpy(&pixel, in, sizeof(pixel));
+  return static_cast<uint16_t>(((pixel >> 8) & 0xF800) |
+                               ((pixel >> 5) & 0x07E0) |
+                               ((pixel >> 3) & 0x001F));
+}
+
+void fill_span(uint16_t *dest, int32_t count, uint16_t color) {
+#ifdef DRAW_KERNELS_PIE
+  // vst.128 ignores the low address bits, so align the head by hand
+  while (count > 0 && (reinterpret_cast<uintptr_t>(dest) & 15) != 0) {
+    *dest++ = color;
+    count--;
+  }
+  int32_t blocks = count >> 3;
+  if (blocks > 0) {
+    asm volatile("ee.vldbc.16 q0, %[color]\n"
+                 "1:\n"
+                 "ee.vst.128.ip q0, %[dest], 16\n"
+                 "addi %[blocks], %[blocks], -1\n"
+                 "bnez %[blocks], 1b\n"
+                 : [dest] "+r"(dest), [blocks] "+r"(blocks)
+                 : [color] "r"(&color)
+                 : "memory");
+    count &= 7;
+  }
+#else
+  if (count > 0 && (reinterpret_cast<uintptr_t>(dest) & 2) != 0) {
+    *dest++ = color;
+    count--;
+  }
+  const uint32_t pair = color | static_cast<uint32_t>(color) << 16;
+  PixelPair *pairs = reinterpret_cast<PixelPair *>(dest);
+  for (int32_t i = 0; i < count >> 1; i++) {
+    pairs[i] = pair;
+  }
+  dest += count & ~1;
+  count &= 1;
+#endif
+  while (count-- > 0) {
+    *dest++ = color;
+  }
+}
+
+#ifdef DRAW_KERNELS_PIE
+// Field masks of xrgb_pixel(), broadcast to every lane
+const uint32_t RED_MASK = 0xF800;
+const uint32_t GREEN_MASK = 0x07E0;
+const uint32_t BLUE_MASK = 0x001F;
+
+// Eight XRGB8888 pixels per pass: each 32-bit lane is shifted and masked
+// as in xrgb_pixel() and vunzip.16 packs the low halves into one 16-byte
+// store. Source rows are only 4-byte aligned (LV_DRAW_BUF_ALIGN), so loads
+// go through ld.128.usar / src.q, which also read the next 16-byte block;
+// the vector part stops 4 pixels before the row end to keep that read
+// inside the row. Returns the pixels converted.
+int32_t xrgb_span(uint16_t *dest, const uint8_t *src, int32_t w) {
+  int32_t x = 0;
+  while (x < w && (reinterpret_cast<uintptr_t>(dest + x) & 15) != 0) {
+    dest[x] = xrgb_pixel(src + x * 4);
+    x++;
+  }
+  int32_t blocks = w - x > 4 ? (w - x - 4) >> 3 : 0;
+  if (blocks == 0) {
+    return x;
+  }
+  uint16_t *out = dest + x;
+  const uint8_t *in = src + x * 4;
+  x += blocks * 8;
+  asm volatile("ee.vldbc.32 q4, %[red]\n"
+               "ee.vldbc.32 q5, %[green]\n"
+               "ee.vldbc.32 q6, %[blue]\n"
+               "1:\n"
+               "ee.ld.128.usar.ip q0, %[in], 16\n"
+               "ee.vld.128.ip q1, %[in], 0\n"
+               "ee.src.q q0, q0, q1\n"
+               "ee.ld.128.usar.ip q1, %[in], 16\n"
+               "ee.vld.128.ip q2, %[in], 0\n"
+               "ee.src.q q1, q1, q2\n"
+               "ssai 8\n"
+               "ee.vsr.32 q2, q0\n"
+               "ee.andq q2, q2, q4\n"
+               "ee.vsr.32 q3, q1\n"
+               "ee.andq q3, q3, q4\n"
+               "ssai 5\n"
+               "ee.vsr.32 q7, q0\n"
+               "ee.andq q7, q7, q5\n"
+               "ee.orq q2, q2, q7\n"
+               "ee.vsr.32 q7, q1\n"
+               "ee.andq q7, q7, q5\n"
+               "ee.orq q3, q3, q7\n"
+               "ssai 3\n"
+               "ee.vsr.32 q0, q0\n"
+               "ee.andq q0, q0, q6\n"
+               "ee.orq q0, q0, q2\n"
+               "ee.vsr.32 q1, q1\n"
+               "ee.andq q1, q1, q6\n"
+               "ee.orq q1, q1, q3\n"
+               "ee.vunzip.16 q0, q1\n"
+               "ee.vst.128.ip q0, %[out], 16\n"
+               "addi %[blocks], %[blocks], -1\n"
+               "bnez %[blocks], 1b\n"
+               : [in] "+r"(in), [out] "+r"(out), [blocks] "+r"(blocks)
+               : [red] "r"(&RED_MASK), [green] "r"(&GREEN_MASK),
+                 [blue] "r"(&BLUE_MASK)
+               : "memory");
+  return x;
+}
+#endif
+
+// xorshift32: a fixed, repeatable input stream on every target
+uint32_t next_random(uint32_t &state) {
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+// Check canvas: wide enough for every 16-byte store phase; pixels around
+// each area are compared too and must come through untouched
+const int32_t CHECK_WIDTH = 48;
+const int32_t CHECK_HEIGHT = 12;
+const int32_t CHECK_PIXELS = CHECK_WIDTH * CHECK_HEIGHT;
+const int CHECK_CASES = 256;
+
+struct CheckArea {
+  int32_t offset; // First pixel, in pixels from the canvas start
+  int32_t w;
+  int32_t h;
+  int32_t stride; // Bytes
+};
+
+CheckArea random_area(uint32_t &state) {
+  CheckArea area;
+  area.w = 1 + next_random(state) % CHECK_WIDTH;
+  area.h = 1 + next_random(state) % CHECK_HEIGHT;
+  if (next_random(state) & 1) {
+    // Contiguous rows, which the fill takes as one span
+    area.stride = area.w * 2;
+    area.offset = next_random(state) % (CHECK_PIXELS - area.w * area.h + 1);
+  } else {
+    area.stride = CHECK_WIDTH * 2;
+    int32_t x = next_random(state) % (CHECK_WIDTH - area.w + 1);
+    int32_t y = next_random(state) % (CHECK_HEIGHT - area.h + 1);
+    area.offset = y * CHECK_WIDTH + x;
+  }
+  return area;
+}
+
+} // namespace
+
+extern "C" {
+
+void draw_fill_rgb565(uint16_t *dest, int32_t w, int32_t h, int32_t stride,
+                      uint16_t color) {
+  if (stride == w * 2) {
+    fill_span(dest, w * h, color);
+    return;
+  }
+  for (int32_t y = 0; y < h; y++) {
+    fill_span(dest, w, color);
+    dest = next_row(dest, stride);
+  }
+}
+
+void draw_fill_rgb565_ref(uint16_t *dest, int32_t w, int32_t h,
+                          int32_t stride, uint16_t color) {
+  for (int32_t y = 0; y < h; y++) {
+    for (int32_t x = 0; x < w; x++) {
+      dest[x] = color;
+    }
+    dest = next_row(dest, stride);
+  }
+}
+
+void draw_rgb888_to_rgb565(uint16_t *dest, int32_t dest_stride,
+                           const uint8_t *src, int32_t src_stride, int32_t w,
+                           int32_t h, uint8_t px_size) {
+  for (int32_t y = 0; y < h; y++) {
+    const uint8_t *in = src;
+    int32_t x = 0;
+    if (px_size == 4) {
+#ifdef DRAW_KERNELS_PIE
+      x = xrgb_span(dest, in, w);
+      in += x * 4;
+#endif
+      for (; x < w; x++, in += 4) {
+        dest[x] = xrgb_pixel(in);
+      }
+    } else {
+      // Three-byte pixels straddle the vector lanes and PIE has no byte
+      // shuffle to regroup them, so RGB888 stays scalar, unrolled by four
+      for (; x + 4 <= w; x += 4, in += 12) {
+        dest[x] = ((in[2] & 0xF8) << 8) | ((in[1] & 0xFC) << 3) | (in[0] >> 3);
+        dest[x + 1] =
+            ((in[5] & 0xF8) << 8) | ((in[4] & 0xFC) << 3) | (in[3] >> 3);
+        dest[x + 2] =
+            ((in[8] & 0xF8) << 8) | ((in[7] & 0xFC) << 3) | (in[6] >> 3);
+        dest[x + 3] =
+            ((in[11] & 0xF8) << 8) | ((in[10] & 0xFC) << 3) | (in[9] >> 3);
+      }
+      for (; x < w; x++, in += 3) {
+        dest[x] = ((in[2] & 0xF8) << 8) | ((in[1] & 0xFC) << 3) | (in[0] >> 3);
+      }
+    }
+    dest = next_row(dest, dest_stride);
+    src += src_stride;
+  }
+}
+
+void draw_rgb888_to_rgb565_ref(uint16_t *dest, int32_t dest_stride,
+                               const uint8_t *src, int32_t src_stride,
+                               int32_t w, int32_t h, uint8_t px_size) {
+  for (int32_t y = 0; y < h; y++) {
+    for (int32_t x = 0, at = 0; x < w; x++, at += px_size) {
+      dest[x] = ((src[at + 2] & 0xF8) << 8) + ((src[at + 1] & 0xFC) << 3) +
+                ((src[at] & 0xF8) >> 3);
+    }
+    dest = next_row(dest, dest_stride);
+    src += src_stride;
+  }
+}
+
+uint32_t draw_kernels_check(uint32_t seed) {
+  // Both canvases 16-byte aligned like LVGL's draw buffers, so the
+  // offsets cover every store phase
+  const size_t bytes = CHECK_PIXELS * sizeof(uint16_t);
+  uint8_t *block = static_cast<uint8_t *>(malloc(bytes * 2 + 16));
+  uint8_t *source = static_cast<uint8_t *>(malloc(CHECK_PIXELS * 4));
+  if (block == nullptr || source == nullptr) {
+    free(block);
+    free(source);
+    return 1;
+  }
+  uint16_t *fast = reinterpret_cast<uint16_t *>(
+      (reinterpret_cast<uintptr_t>(block) + 15) & ~uintptr_t(15));
+  uint16_t *reference = fast + CHECK_PIXELS;
+
+  uint32_t state = seed != 0 ? seed : 1;
+  uint32_t mismatches = 0;
+  for (int i = 0; i < CHECK_CASES * 2; i++) {
+    for (int32_t p = 0; p < CHECK_PIXELS; p++) {
+      reference[p] = static_cast<uint16_t>(next_random(state));
+    }
+    memcpy(fast, reference, bytes);
+    CheckArea area = random_area(state);
+
+    if (i % 2 == 0) {
+      uint16_t color = static_cast<uint16_t>(next_random(state));
+      draw_fill_rgb565(fast + area.offset, area.w, area.h, area.stride,
+                       color);
+      draw_fill_rgb565_ref(reference + area.offset, area.w, area.h,
+                           area.stride, color);
+    } else {
+      // Rows w * px_size bytes apart: the XRGB8888 vector loads meet
+      // every 4-byte phase
+      uint8_t px_size = (i / 2) & 1 ? 4 : 3;
+      for (int32_t b = 0; b < CHECK_PIXELS * 4; b++) {
+        source[b] = static_cast<uint8_t>(next_random(state));
+      }
+      int32_t src_stride = area.w * px_size;
+      draw_rgb888_to_rgb565(fast + area.offset, area.stride, source,
+                            src_stride, area.w, area.h, px_size);
+      draw_rgb888_to_rgb565_ref(reference + area.offset, area.stride, source,
+                                src_stride, area.w, area.h, px_size);
+    }
+    if (memcmp(fast, reference, bytes) != 0) {
+      mismatches++;
+    }
+  }
+
+  free(block);
+  free(source);
+  return mismatches;
+}
+
+} // extern "C"
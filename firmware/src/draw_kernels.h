@@ -0,0 +1,58 @@
+/**
+ * RGB565 draw kernels for LVGL's software renderer
+ *
+ * Solid fills (screen and widget backgrounds) and RGB888 / XRGB8888 images
+ * converted to the RGB565 framebuffer each come in two versions:
+ *  - *_ref: a plain per-pixel loop, kept as the bit-exact reference. The
+ *    conversion reference is LVGL's own loop; the fill reference is simpler
+ *    than LVGL's fill, which already stores pixel pairs.
+ *  - the fast version LVGL calls through src/lv_blend_hooks.h. On the
+ *    ESP32-S3 solid fills and XRGB8888 conversion use the PIE vector unit
+ *    (16-byte stores); RGB888 conversion is unrolled. Without PIE (the
+ *    host) the fill stores 32-bit pixel pairs.
+ *
+ * Translucent fills are left to LVGL: its loop already reuses the mixed
+ * color across equal background pixels.
+ *
+ * Fast and reference versions must agree bit for bit on every input:
+ * draw_kernels_check() compares them over random sizes, strides and
+ * offsets, and runs before the draw benchmarks on the device and the host
+ * (src/bench_cases.h).
+ *
+ * Strides are in bytes, as in LVGL's blend descriptors. Plain C interface:
+ * LVGL's C sources call these from the hook macros.
+ */
+
+#ifndef DRAW_KERNELS_H
+#define DRAW_KERNELS_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Sets every pixel of a w x h area to color
+void draw_fill_rgb565(uint16_t *dest, int32_t w, int32_t h, int32_t stride,
+                      uint16_t color);
+void draw_fill_rgb565_ref(uint16_t *dest, int32_t w, int32_t h,
+                          int32_t stride, uint16_t color);
+
+// Converts RGB888 (px_size 3) or XRGB8888 (px_size 4) pixels, stored
+// B, G, R as LVGL does, to RGB565 by truncation
+void draw_rgb888_to_rgb565(uint16_t *dest, int32_t dest_stride,
+                           const uint8_t *src, int32_t src_stride, int32_t w,
+                           int32_t h, uint8_t px_size);
+void draw_rgb888_to_rgb565_ref(uint16_t *dest, int32_t dest_stride,
+                               const uint8_t *src, int32_t src_stride,
+                               int32_t w, int32_t h, uint8_t px_size);
+
+// Runs fast and reference kernels on the same random inputs; returns the
+// number of cases whose outputs differ (0 when the kernels are exact)
+uint32_t draw_kernels_check(uint32_t seed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DRAW_KERNELS_H
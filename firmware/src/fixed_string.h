@@ -0,0 +1,132 @@
+/**
+ * Fixed-capacity UTF-8 string
+ *
+ * Replacement for Arduino String on hot paths: the buffer lives inline
+ * (stack, static or inside another object), so building and copying text
+ * never touches the heap. Writes that do not fit are truncated on a UTF-8
+ * character boundary instead of failing. format() / append_format() are
+ * printf-checked by the compiler (-Wformat), so a mismatched argument is a
+ * build warning rather than garbage on the panel.
+ *
+ * std::string_view serves as the matching read-only view type.
+ */
+
+#ifndef FIXED_STRING_H
+#define FIXED_STRING_H
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <string_view>
+
+inline bool utf8_continuation(char c) {
+  return (static_cast<unsigned char>(c) & 0xC0) == 0x80;
+}
+
+// Longest prefix of text[0, length) that fits capacity bytes without
+// splitting a multi-byte UTF-8 sequence. Only reads the first capacity
+// bytes, so it also works on output vsnprintf already cut short.
+inline size_t utf8_fit(const char *text, size_t length, size_t capacity) {
+  if (length <= capacity) {
+    return length;
+  }
+  // Last lead (or ASCII) byte before the cut
+  size_t lead = capacity;
+  while (lead > 0 && utf8_continuation(text[lead - 1])) {
+    lead--;
+  }
+  if (lead == 0) {
+    return capacity; // No character structure to respect
+  }
+  lead--;
+  unsigned char c = static_cast<unsigned char>(text[lead]);
+  size_t needed = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 1;
+  return lead + needed <= capacity ? capacity : lead;
+}
+
+template <size_t N> class FixedString {
+  static_assert(N > 0, "FixedString needs room for at least one byte");
+
+public:
+  FixedString() { buffer[0] = '\0'; }
+  FixedString(const char *text) { assign(text); }
+  FixedString(std::string_view text) { assign(text); }
+
+  FixedString &operator=(const char *text) {
+    assign(text);
+    return *this;
+  }
+
+  void clear() {
+    length = 0;
+    buffer[0] = '\0';
+  }
+
+  void assign(std::string_view text) {
+    clear();
+    append(text);
+  }
+  void assign(const char *text) { assign(std::string_view(text ? text : "")); }
+
+  void append(std::string_view text) {
+    size_t n = utf8_fit(text.data(), text.size(), N - 1 - length);
+    memcpy(buffer + length, text.data(), n);
+    length += n;
+    buffer[length] = '\0';
+  }
+
+  FixedString &operator+=(std::string_view text) {
+    append(text);
+    return *this;
+  }
+
+  size_t format(const char *fmt, ...) __attribute__((format(printf, 2, 3))) {
+    clear();
+    va_list args;
+    va_start(args, fmt);
+    append_vformat(fmt, args);
+    va_end(args);
+    return length;
+  }
+
+  size_t append_format(const char *fmt, ...)
+      __attribute__((format(printf, 2, 3))) {
+    va_list args;
+    va_start(args, fmt);
+    append_vformat(fmt, args);
+    va_end(args);
+    return length;
+  }
+
+  const char *c_str() const { return buffer; }
+  std::string_view view() const { return {buffer, length}; }
+  size_t size() const { return length; }
+  bool empty() const { return length == 0; }
+  static constexpr size_t capacity() { return N - 1; }
+
+  bool operator==(std::string_view other) const { return view() == other; }
+
+  // For variadic wrappers; callers should carry the format attribute
+  void append_vformat(const char *fmt, va_list args) {
+    int wanted = vsnprintf(buffer + length, N - length, fmt, args);
+    if (wanted < 0) {
+      buffer[length] = '\0';
+      return;
+    }
+    size_t written = static_cast<size_t>(wanted);
+    if (length + written > N - 1) {
+      // vsnprintf cut at a byte; back off to a character boundary
+      written = utf8_fit(buffer + length, written, N - 1 - length);
+    }
+    length += written;
+    buffer[length] = '\0';
+  }
+
+private:
+  char buffer[N];
+  size_t length = 0;
+};
+
+#endif // FIXED_STRING_H
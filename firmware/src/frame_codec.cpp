@@ -0,0 +1,122 @@
+/**
+ * Binary framing for the USB-CDC link - see frame_codec.h
+ */
+
+#include "frame_codec.h"
+
+uint16_t crc16_ccitt(const uint8_t *data, size_t length, uint16_t crc) {
+  for (size_t i = 0; i < length; i++) {
+    crc ^= static_cast<uint16_t>(data[i]) << 8;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+  return crc;
+}
+
+size_t encode_frame(FrameKind kind, const uint8_t *body, size_t length,
+                    uint8_t *out, size_t capacity) {
+  if (length + 1 > Constants::Usb::MAX_PAYLOAD) {
+    return 0;
+  }
+
+  uint8_t kind_byte = static_cast<uint8_t>(kind);
+  uint16_t crc = crc16_ccitt(&kind_byte, 1);
+  crc = crc16_ccitt(body, length, crc);
+  uint8_t trailer[2] = {static_cast<uint8_t>(crc & 0xFF),
+                        static_cast<uint8_t>(crc >> 8)};
+
+  // COBS: each block starts with the distance to the next zero byte
+  size_t total = length + 3;
+  size_t code_index = 0;
+  size_t written = 1;
+  uint8_t code = 1;
+  for (size_t i = 0; i < total; i++) {
+    uint8_t byte = kind_byte;
+    if (i > length) {
+      byte = trailer[i - length - 1];
+    } else if (i > 0) {
+      byte = body[i - 1];
+    }
+    if (written >= capacity) {
+      return 0;
+    }
+    if (byte == 0) {
+      out[code_index] = code;
+      code_index = written++;
+      code = 1;
+      continue;
+    }
+    out[written++] = byte;
+    if (++code == 0xFF) {
+      if (written >= capacity) {
+        return 0;
+      }
+      out[code_index] = code;
+      code_index = written++;
+      code = 1;
+    }
+  }
+  if (written >= capacity) {
+    return 0;
+  }
+  out[code_index] = code;
+  out[written++] = 0x00;
+  return written;
+}
+
+FeedResult FrameDecoder::feed(uint8_t byte) {
+  if (byte == 0x00) {
+    return finish();
+  }
+  if (fill == sizeof(encoded)) {
+    // No delimiter in sight: hand the bytes out as raw and start over
+    counters.overflows++;
+    raw_fill = fill;
+    fill = 0;
+    encoded[fill++] = byte;
+    return FeedResult::Invalid;
+  }
+  encoded[fill++] = byte;
+  return FeedResult::Pending;
+}
+
+FeedResult FrameDecoder::finish() {
+  size_t length = fill;
+  fill = 0;
+  raw_fill = length;
+  if (length == 0) {
+    return FeedResult::Pending; // Back-to-back delimiters
+  }
+
+  decoded_length = 0;
+  size_t i = 0;
+  while (i < length) {
+    uint8_t code = encoded[i++];
+    if (i + code - 1 > length) {
+      counters.crc_errors++;
+      return FeedResult::Invalid;
+    }
+    for (uint8_t j = 1; j < code; j++) {
+      decoded[decoded_length++] = encoded[i++];
+    }
+    if (code != 0xFF && i < length) {
+      decoded[decoded_length++] = 0x00;
+    }
+  }
+
+  // Kind byte plus CRC at minimum
+  if (decoded_length < 3) {
+    counters.crc_errors++;
+    return FeedResult::Invalid;
+  }
+  decoded_length -= 2;
+  uint16_t expected = decoded[decoded_length] |
+                      static_cast<uint16_t>(decoded[decoded_length + 1]) << 8;
+  if (crc16_ccitt(decoded, decoded_length) != expected) {
+    counters.crc_errors++;
+    return FeedResult::Invalid;
+  }
+  counters.frames++;
+  return FeedResult::Frame;
+}
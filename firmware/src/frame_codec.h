@@ -0,0 +1,69 @@
+/**
+ * Binary framing for the USB-CDC link
+ *
+ * Each frame is [kind][body][crc16] encoded with COBS and terminated by a
+ * 0x00 byte. COBS keeps 0x00 out of the encoded bytes, so the receiver can
+ * resynchronise on the next delimiter after any corruption, and plain-text
+ * debug prints sharing the console simply fail the CRC and are reported as
+ * raw text instead of frames. The codec has no Arduino dependency and is
+ * compiled into the host CLI (tools/host_cli) as well.
+ */
+
+#ifndef FRAME_CODEC_H
+#define FRAME_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "constants.h"
+
+enum class FrameKind : uint8_t {
+  Json = 0x01,      // Same JSON messages as BLE
+  AssetData = 0x02, // Raw chunk of an asset_begin ... asset_end upload
+  Binary = 0x03,    // Same messages in the protocol.h binary encoding
+};
+
+enum class FeedResult : uint8_t { Pending, Frame, Invalid };
+
+struct FrameStats {
+  uint32_t frames;
+  uint32_t crc_errors; // Includes interleaved log text on the host side
+  uint32_t overflows;  // Delimiter missing for longer than MAX_ENCODED
+};
+
+// CRC-16/CCITT-FALSE
+uint16_t crc16_ccitt(const uint8_t *data, size_t length,
+                     uint16_t crc = 0xFFFF);
+
+// Writes the encoded frame including the trailing delimiter; returns its
+// length, or 0 when the body or the output buffer is too large
+size_t encode_frame(FrameKind kind, const uint8_t *body, size_t length,
+                    uint8_t *out, size_t capacity);
+
+class FrameDecoder {
+public:
+  FeedResult feed(uint8_t byte);
+
+  // Valid after FeedResult::Frame
+  FrameKind kind() const { return static_cast<FrameKind>(decoded[0]); }
+  const uint8_t *body() const { return decoded + 1; }
+  size_t body_length() const { return decoded_length - 1; }
+
+  // Undecodable bytes after FeedResult::Invalid
+  const uint8_t *raw() const { return encoded; }
+  size_t raw_length() const { return raw_fill; }
+
+  const FrameStats &stats() const { return counters; }
+
+private:
+  FeedResult finish();
+
+  uint8_t encoded[Constants::Usb::MAX_ENCODED];
+  uint8_t decoded[Constants::Usb::MAX_ENCODED];
+  size_t fill = 0;
+  size_t raw_fill = 0;
+  size_t decoded_length = 0;
+  FrameStats counters = {};
+};
+
+#endif // FRAME_CODEC_H
@@ -0,0 +1,148 @@
+/**
+ * Declarative GATT service table - see gatt_table.h
+ */
+
+#include "gatt_table.h"
+
+#include <BLE2902.h>
+#include <BLEDevice.h>
+
+#include "ble_session.h"
+#include "constants.h"
+
+namespace Gatt {
+
+namespace {
+
+// These run on the Bluetooth task: only session bookkeeping happens here,
+// the UI and message handling follow from loop() via session events.
+class ServerCallbacks : public BLEServerCallbacks {
+  void onConnect(BLEServer *server, esp_ble_gatts_cb_param_t *param) {
+    uint16_t conn_id = param->connect.conn_id;
+    int8_t peer = ble_sessions.open(conn_id);
+    if (peer < 0) {
+      Serial.printf("⚠️ Central limit reached, rejecting conn %d\n",
+                    conn_id);
+      server->disconnect(conn_id);
+      return;
+    }
+
+    // Log connection for monitoring (production: consider privacy implications)
+    Serial.printf("🔐 BLE Client connected (peer %d, conn %d)\n", peer,
+                  conn_id);
+
+    // Keep advertising so further phones/tablets can join
+    if (ble_sessions.connected_count() < Constants::Bluetooth::MAX_CENTRALS) {
+      BLEDevice::startAdvertising();
+    }
+  }
+
+  void onDisconnect(BLEServer *server, esp_ble_gatts_cb_param_t *param) {
+    ble_sessions.close(param->disconnect.conn_id);
+    Serial.printf("BLE Client disconnected (conn %d)\n",
+                  param->disconnect.conn_id);
+    // Restart advertising
+    BLEDevice::startAdvertising();
+  }
+
+  void onMtuChanged(BLEServer *server, esp_ble_gatts_cb_param_t *param) {
+    ble_sessions.set_mtu(param->mtu.conn_id, param->mtu.mtu);
+    Serial.printf("📡 MTU negotiated: %d bytes (conn %d)\n", param->mtu.mtu,
+                  param->mtu.conn_id);
+  }
+};
+
+class RxCallbacks : public BLECharacteristicCallbacks {
+  void onWrite(BLECharacteristic *characteristic,
+               esp_ble_gatts_cb_param_t *param) {
+    // getValue() rather than param->write.value: a long (prepared) write
+    // is delivered once, on the execute event, where only conn_id is valid
+    auto received_data = characteristic->getValue();
+    if (received_data.length() > 0) {
+      // Reassembled and parsed from loop()
+      ble_sessions.on_write(
+          param->write.conn_id,
+          reinterpret_cast<const uint8_t *>(received_data.c_str()),
+          received_data.length());
+    }
+  }
+};
+
+// Runs on the Bluetooth task ahead of the library's own dispatch. Confirm
+// events for the TX characteristic release the session's pending
+// indication (BLEServerCallbacks has no hook for them).
+void on_gatts_event(esp_gatts_cb_event_t event, esp_gatt_if_t,
+                    esp_ble_gatts_cb_param_t *param) {
+  if (event == ESP_GATTS_CONF_EVT &&
+      param->conf.handle == tx_characteristic.getHandle()) {
+    ble_sessions.on_confirm(param->conf.conn_id,
+                            param->conf.status == ESP_GATT_OK);
+  }
+}
+
+ServerCallbacks server_callbacks;
+RxCallbacks rx_callbacks;
+BLE2902 tx_cccd;
+
+struct Attribute {
+  const Uuid128 &uuid;
+  const char *access;
+  BLECharacteristic *characteristic;
+  BLEDescriptor *cccd; // Client configuration for notify, or null
+  BLECharacteristicCallbacks *callbacks;
+};
+
+constexpr Attribute TABLE[] = {
+    {RX, "write, write without response, read", &rx_characteristic, nullptr,
+     &rx_callbacks},
+    {TX, "notify, indicate, read", &tx_characteristic, &tx_cccd, nullptr},
+};
+
+// Service declaration plus declaration and value per characteristic, plus
+// one handle per descriptor
+constexpr uint16_t handle_count() {
+  uint16_t handles = 1;
+  for (const Attribute &attribute : TABLE) {
+    handles += attribute.cccd != nullptr ? 3 : 2;
+  }
+  return handles;
+}
+
+} // namespace
+
+// Write without response is the fast path; credit keeps it from overrunning
+BLECharacteristic rx_characteristic(ble_uuid(RX),
+                                    BLECharacteristic::PROPERTY_WRITE |
+                                        BLECharacteristic::PROPERTY_WRITE_NR |
+                                        BLECharacteristic::PROPERTY_READ);
+BLECharacteristic tx_characteristic(ble_uuid(TX),
+                                    BLECharacteristic::PROPERTY_NOTIFY |
+                                        BLECharacteristic::PROPERTY_INDICATE |
+                                        BLECharacteristic::PROPERTY_READ);
+
+BLEService *create_service(BLEServer *server) {
+  server->setCallbacks(&server_callbacks);
+  BLEDevice::setCustomGattsHandler(on_gatts_event);
+  BLEService *service =
+      server->createService(ble_uuid(SERVICE), handle_count());
+  for (const Attribute &attribute : TABLE) {
+    if (attribute.cccd != nullptr) {
+      attribute.characteristic->addDescriptor(attribute.cccd);
+    }
+    if (attribute.callbacks != nullptr) {
+      attribute.characteristic->setCallbacks(attribute.callbacks);
+    }
+    service->addCharacteristic(attribute.characteristic);
+  }
+  return service;
+}
+
+void print_table() {
+  Serial.printf("Service UUID: %s\n", SERVICE.text);
+  for (const Attribute &attribute : TABLE) {
+    Serial.printf("  Characteristic %s (%s)\n", attribute.uuid.text,
+                  attribute.access);
+  }
+}
+
+} // namespace Gatt
@@ -0,0 +1,84 @@
+/**
+ * Declarative GATT service table
+ *
+ * The UART service is described by a constexpr table instead of being built
+ * call by call in setup_ble(). UUID strings are parsed into bytes by the
+ * compiler (a malformed UUID is a build error), and the characteristics,
+ * CCCD and callback objects are statically allocated, so registering the
+ * service does no string parsing and no per-attribute heap allocation. A new
+ * characteristic is one more static object and one more table row.
+ *
+ * UUIDs follow the Nordic UART Service so generic BLE tools recognise it.
+ */
+
+#ifndef GATT_TABLE_H
+#define GATT_TABLE_H
+
+#include <BLECharacteristic.h>
+#include <BLEServer.h>
+
+namespace Gatt {
+
+// 128-bit UUID in the little-endian byte order Bluedroid expects
+struct Uuid128 {
+  const char *text; // Canonical form, for logs
+  uint8_t bytes[16];
+};
+
+// Not constexpr: reaching it during constant evaluation fails the build
+inline void invalid_uuid() {}
+
+constexpr uint8_t hex_digit(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  invalid_uuid();
+  return 0;
+}
+
+// "6E400001-B5A3-F393-E0A9-E50E24DCCA9E" -> bytes, at compile time
+constexpr Uuid128 uuid128(const char (&text)[37]) {
+  Uuid128 uuid{text, {}};
+  int byte = 15;
+  for (int i = 0; i < 36; i++) {
+    if (i == 8 || i == 13 || i == 18 || i == 23) {
+      if (text[i] != '-') {
+        invalid_uuid();
+      }
+      continue;
+    }
+    uint8_t high = hex_digit(text[i++]);
+    uuid.bytes[byte--] = high << 4 | hex_digit(text[i]);
+  }
+  return uuid;
+}
+
+constexpr Uuid128 SERVICE = uuid128("6E400001-B5A3-F393-E0A9-E50E24DCCA9E");
+constexpr Uuid128 RX = uuid128("6E400002-B5A3-F393-E0A9-E50E24DCCA9E");
+constexpr Uuid128 TX = uuid128("6E400003-B5A3-F393-E0A9-E50E24DCCA9E");
+
+// Wraps the parsed bytes; no string parsing at runtime
+inline BLEUUID ble_uuid(const Uuid128 &uuid) {
+  return BLEUUID(const_cast<uint8_t *>(uuid.bytes), sizeof(uuid.bytes),
+                 false);
+}
+
+extern BLECharacteristic rx_characteristic; // Phone -> device writes
+extern BLECharacteristic tx_characteristic; // Device -> phone notifications
+
+// Registers the server callbacks and the service from the table; the
+// returned service still has to be started
+BLEService *create_service(BLEServer *server);
+
+// Prints the table (UUIDs and properties) to the serial log
+void print_table();
+
+} // namespace Gatt
+
+#endif // GATT_TABLE_H
@@ -0,0 +1,101 @@
+/**
+ * Touch-to-photon latency measurement - see latency_probe.h
+ */
+
+#include "latency_probe.h"
+
+#include <stdio.h>
+
+LatencyProbe latency_probe;
+
+namespace {
+
+// A click whose frame has not started by then produced no visible change
+const uint32_t MAX_PENDING_US = 1000000;
+
+} // namespace
+
+void LatencyHistogram::record(uint32_t us) {
+  uint32_t bucket = us / BUCKET_US;
+  buckets[bucket < BUCKETS ? bucket : BUCKETS - 1]++;
+  samples++;
+  if (us > max_us) {
+    max_us = us;
+  }
+}
+
+uint32_t LatencyHistogram::percentile(int percent) const {
+  if (samples == 0) {
+    return 0;
+  }
+  // Rank of the sample at this percentile, rounded up
+  uint32_t rank = (static_cast<uint64_t>(samples) * percent + 99) / 100;
+  uint32_t seen = 0;
+  for (int i = 0; i < BUCKETS - 1; i++) {
+    seen += buckets[i];
+    if (seen >= rank) {
+      // The bucket's upper bound, but never past the largest sample
+      uint32_t bound = (i + 1) * BUCKET_US;
+      return bound < max_us ? bound : max_us;
+    }
+  }
+  return max_us;
+}
+
+void LatencyProbe::event(uint32_t event_us, uint32_t input_us) {
+  if (armed) {
+    abandoned_count++;
+  }
+  // A stale release (or none) means the click did not come from the panel
+  bool recent = input_us != 0 && event_us - input_us < MAX_PENDING_US;
+  pending = {recent ? input_us : event_us, event_us, 0, 0};
+  armed = true;
+  rendering = false;
+}
+
+void LatencyProbe::render_start(uint32_t now_us) {
+  if (!armed || rendering) {
+    return;
+  }
+  if (now_us - pending.event_us > MAX_PENDING_US) {
+    armed = false;
+    abandoned_count++;
+    return;
+  }
+  pending.render_us = now_us;
+  rendering = true;
+}
+
+bool LatencyProbe::flush_done(uint32_t now_us, LatencySample &out) {
+  if (!armed || !rendering) {
+    return false;
+  }
+  pending.flush_us = now_us;
+  armed = false;
+  rendering = false;
+
+  histogram.record(pending.flush_us - pending.input_us);
+  input_to_event_us += pending.event_us - pending.input_us;
+  event_to_render_us += pending.render_us - pending.event_us;
+  render_to_flush_us += pending.flush_us - pending.render_us;
+  out = pending;
+  return true;
+}
+
+size_t LatencyProbe::format_summary(char *out, size_t capacity) const {
+  uint32_t n = histogram.count();
+  if (n == 0) {
+    return snprintf(out, capacity, "no samples");
+  }
+  int written = snprintf(
+      out, capacity,
+      "n=%u | p50 %u ms | p90 %u ms | p99 %u ms | max %u.%03u ms | "
+      "avg input->event %u us, event->render %u us, render->flush %u us | "
+      "%u abandoned",
+      n, histogram.percentile(50) / 1000, histogram.percentile(90) / 1000,
+      histogram.percentile(99) / 1000, histogram.max() / 1000,
+      histogram.max() % 1000, static_cast<uint32_t>(input_to_event_us / n),
+      static_cast<uint32_t>(event_to_render_us / n),
+      static_cast<uint32_t>(render_to_flush_us / n), abandoned_count);
+  return written < 0 ? 0 : static_cast<size_t>(written);
+}
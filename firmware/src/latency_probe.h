@@ -0,0 +1,72 @@
+/**
+ * Touch-to-photon latency measurement
+ *
+ * Follows one tap through four timestamps: the touch controller interrupt
+ * of the release, the LVGL click event, the start of the frame that renders
+ * the feedback, and the end of that frame's flush to the panel. Completed
+ * samples go into a 1 ms histogram for percentiles and are logged as
+ *
+ *   LAT <input_us> <event_us> <render_us> <flush_us>
+ *
+ * so a captured serial log can be replayed through the same probe on the
+ * host (tools/latency_replay). Pure C++: timestamps are passed in.
+ */
+
+#ifndef LATENCY_PROBE_H
+#define LATENCY_PROBE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct LatencySample {
+  uint32_t input_us;
+  uint32_t event_us;
+  uint32_t render_us;
+  uint32_t flush_us;
+};
+
+class LatencyHistogram {
+public:
+  static const int BUCKETS = 100; // 1 ms each, last one is open-ended
+  static const uint32_t BUCKET_US = 1000;
+
+  void record(uint32_t us);
+  // Upper bound of the bucket holding the given percentile, in us
+  uint32_t percentile(int percent) const;
+  uint32_t count() const { return samples; }
+  uint32_t max() const { return max_us; }
+
+private:
+  uint32_t buckets[BUCKETS] = {};
+  uint32_t samples = 0;
+  uint32_t max_us = 0;
+};
+
+class LatencyProbe {
+public:
+  // A click was handled; input_us is the press interrupt (0 if unknown)
+  void event(uint32_t event_us, uint32_t input_us);
+  void render_start(uint32_t now_us);
+  // True when this flush completed a pending sample
+  bool flush_done(uint32_t now_us, LatencySample &out);
+
+  // One-line summary: percentiles and average per stage
+  size_t format_summary(char *out, size_t capacity) const;
+
+  const LatencyHistogram &total() const { return histogram; }
+  uint32_t abandoned() const { return abandoned_count; }
+
+private:
+  LatencySample pending = {};
+  bool armed = false;
+  bool rendering = false;
+  LatencyHistogram histogram;
+  uint64_t input_to_event_us = 0;
+  uint64_t event_to_render_us = 0;
+  uint64_t render_to_flush_us = 0;
+  uint32_t abandoned_count = 0; // Click that produced no frame
+};
+
+extern LatencyProbe latency_probe;
+
+#endif // LATENCY_PROBE_H
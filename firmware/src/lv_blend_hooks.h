@@ -0,0 +1,28 @@
+/**
+ * LVGL software blend hooks (LV_DRAW_SW_ASM_CUSTOM_INCLUDE in lv_conf.h)
+ *
+ * LVGL includes this from its blend sources and calls a hook before each
+ * of its own RGB565 loops; LV_RESULT_INVALID falls back to the built-in
+ * loop. Only the cases draw_kernels.h covers are hooked: solid fills and
+ * unmasked opaque RGB888 / XRGB8888 images. Translucent fills and masked
+ * blends (anti-aliased edges, text) stay on LVGL's code.
+ */
+
+#ifndef LV_BLEND_HOOKS_H
+#define LV_BLEND_HOOKS_H
+
+#include "draw_kernels.h"
+
+#define LV_DRAW_SW_COLOR_BLEND_TO_RGB565(dsc)                                 \
+  (draw_fill_rgb565((uint16_t *)(dsc)->dest_buf, (dsc)->dest_w,               \
+                    (dsc)->dest_h, (dsc)->dest_stride,                        \
+                    lv_color_to_u16((dsc)->color)),                           \
+   LV_RESULT_OK)
+
+#define LV_DRAW_SW_RGB888_BLEND_NORMAL_TO_RGB565(dsc, src_px_size)            \
+  (draw_rgb888_to_rgb565((uint16_t *)(dsc)->dest_buf, (dsc)->dest_stride,     \
+                         (const uint8_t *)(dsc)->src_buf, (dsc)->src_stride,  \
+                         (dsc)->dest_w, (dsc)->dest_h, (src_px_size)),        \
+   LV_RESULT_OK)
+
+#endif // LV_BLEND_HOOKS_H
@@ -7,24 +7,28 @@
 #ifndef LV_CONF_H
 #define LV_CONF_H
 
-/* CRITICAL: Disable ARM optimizations for ESP32S3 (Xtensa architecture) */
-#define LV_USE_DRAW_SW_ASM LV_DRAW_SW_ASM_NONE
+/* No NEON/Helium on Xtensa: RGB565 fills and RGB888 conversion go through
+ * the ESP32-S3 kernels in draw_kernels.h (see lv_blend_hooks.h) */
+#define LV_USE_DRAW_SW_ASM LV_DRAW_SW_ASM_CUSTOM
+#define LV_DRAW_SW_ASM_CUSTOM_INCLUDE "lv_blend_hooks.h"
+
+/* Rendering on both cores: LVGL's FreeRTOS port runs each SW draw unit in
+ * its own (unpinned) task. App code holds lv_lock() around its LVGL calls
+ * (see loop()); T-Display-AMOLED-1unit builds with one unit to compare. */
+#define LV_USE_OS LV_OS_FREERTOS
+#ifndef LV_DRAW_SW_DRAW_UNIT_CNT
+#define LV_DRAW_SW_DRAW_UNIT_CNT 2
+#endif
+#define LV_DRAW_THREAD_STACK_SIZE (8 * 1024)
 
 /* Basic LVGL settings */
 #define LV_COLOR_DEPTH 16
-#define LV_USE_STDLIB_MALLOC LV_STDLIB_BUILTIN
+/* lv_malloc: small blocks in internal RAM slabs, large ones in PSRAM,
+ * growing on demand (lvgl_heap.h) */
+#define LV_USE_STDLIB_MALLOC LV_STDLIB_CUSTOM
 #define LV_USE_STDLIB_STRING LV_STDLIB_BUILTIN
 #define LV_USE_STDLIB_SPRINTF LV_STDLIB_BUILTIN
 
-/* Memory settings optimized for ESP32S3 - Use PSRAM for large allocations */
-#define LV_MEM_SIZE (128 * 1024U) /* Reduced to 128KB for better DRAM usage */
-
-/* Enable PSRAM usage for ESP32S3 */
-#define LV_MEM_POOL_INCLUDE <esp_heap_caps.h>
-#define LV_MEM_POOL_ALLOC(size)                                                \
-  heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT)
-#define LV_MEM_POOL_FREE(ptr) heap_caps_free(ptr)
-
 /* Optimize drawing buffers for lower memory usage */
 #define LV_DRAW_BUF_SIZE_PREFERRED (10 * 1024) /* Smaller draw buffer */
 #define LV_DRAW_BUF_ALIGN 4
@@ -0,0 +1,346 @@
+/**
+ * Tiered LVGL allocator - see lvgl_heap.h
+ */
+
+#include "lvgl_heap.h"
+
+#include <esp_heap_caps.h>
+
+LvglHeap lvgl_heap;
+
+namespace {
+
+const size_t HEADER = sizeof(uint32_t); // Requested bytes << 2 | tier
+const uint32_t INTERNAL_CAPS = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+const uint32_t PSRAM_CAPS = MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT;
+
+inline uint32_t *header_of(void *data) {
+  return reinterpret_cast<uint32_t *>(static_cast<uint8_t *>(data) - HEADER);
+}
+
+inline void *payload_of(void *block, uint32_t bytes, uint8_t tier) {
+  *static_cast<uint32_t *>(block) = bytes << 2 | tier;
+  return static_cast<uint8_t *>(block) + HEADER;
+}
+
+uint8_t frag_pct(uint32_t free_bytes, uint32_t largest) {
+  return free_bytes > 0 ? 100 - static_cast<uint64_t>(largest) * 100 /
+                                    free_bytes
+                        : 0;
+}
+
+} // namespace
+
+// Multiples of 8 so every carved block stays word aligned
+const uint16_t LvglHeap::CLASS_BYTES[CLASS_COUNT] = {
+    16, 24, 32, 48, 64, 96, 128, 192, Constants::LvglHeap::SMALL_MAX};
+
+int LvglHeap::class_of(size_t bytes) {
+  for (int i = 0; i < CLASS_COUNT; i++) {
+    if (bytes <= CLASS_BYTES[i]) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+void *LvglHeap::allocate(size_t size) {
+  size_t bytes = size + HEADER;
+  int size_class = class_of(bytes);
+  if (size_class >= 0) {
+    void *data = take_small(size_class, bytes);
+    if (data != nullptr) {
+      return data;
+    }
+  }
+  return take_large(bytes, size_class >= 0);
+}
+
+// bytes: requested size plus header, as recorded in the header
+void *LvglHeap::take_small(int size_class, uint32_t bytes) {
+  const uint32_t class_bytes = CLASS_BYTES[size_class];
+  for (int attempt = 0; attempt < 2; attempt++) {
+    uint8_t *block = nullptr;
+    portENTER_CRITICAL(&lock);
+    if (free_lists[size_class] != nullptr) {
+      block = reinterpret_cast<uint8_t *>(free_lists[size_class]);
+      free_lists[size_class] = free_lists[size_class]->next;
+      counters.free_blocks--;
+      counters.free_bytes -= class_bytes;
+    } else if (tail != nullptr &&
+               static_cast<size_t>(tail_end - tail) >= class_bytes) {
+      block = tail;
+      tail += class_bytes;
+      counters.free_bytes -= class_bytes;
+    }
+    if (block != nullptr) {
+      count_alloc(counters.internal, bytes);
+      counters.slab_used += class_bytes;
+      slab_requested += bytes;
+    }
+    portEXIT_CRITICAL(&lock);
+    if (block != nullptr) {
+      return payload_of(block, bytes, Slab);
+    }
+    if (attempt == 0 && !grow()) {
+      break;
+    }
+  }
+  return nullptr;
+}
+
+void *LvglHeap::take_large(size_t bytes, bool small) {
+  uint8_t tier = PsramHeap;
+  void *block = heap_caps_malloc(bytes, PSRAM_CAPS);
+  if (block == nullptr) {
+    tier = InternalHeap;
+    block = heap_caps_malloc(bytes, INTERNAL_CAPS);
+  }
+  portENTER_CRITICAL(&lock);
+  if (block == nullptr) {
+    counters.failed++;
+  } else {
+    count_alloc(tier == PsramHeap ? counters.psram : counters.internal,
+                bytes);
+    if (tier == InternalHeap) {
+      counters.fallbacks++;
+    } else if (small) {
+      counters.spills++;
+    }
+  }
+  portEXIT_CRITICAL(&lock);
+  return block != nullptr ? payload_of(block, bytes, tier) : nullptr;
+}
+
+// Adds a slab; false once the internal budget is spent or RAM is short
+bool LvglHeap::grow() {
+  const uint32_t slab_bytes = Constants::LvglHeap::SLAB_BYTES;
+  portENTER_CRITICAL(&lock);
+  bool allowed = (counters.slabs + 1) * slab_bytes <=
+                 static_cast<uint32_t>(Constants::LvglHeap::INTERNAL_BUDGET);
+  portEXIT_CRITICAL(&lock);
+  if (!allowed) {
+    return false;
+  }
+  uint8_t *slab =
+      static_cast<uint8_t *>(heap_caps_malloc(slab_bytes, INTERNAL_CAPS));
+  if (slab == nullptr) {
+    return false;
+  }
+  portENTER_CRITICAL(&lock);
+  // Another task may have grown meanwhile; its tail is not lost either
+  retire_tail();
+  tail = slab;
+  tail_end = slab + slab_bytes;
+  counters.slabs++;
+  counters.free_bytes += slab_bytes;
+  portEXIT_CRITICAL(&lock);
+  return true;
+}
+
+// Hands the old slab's tail to the free lists, largest classes first.
+// Caller holds the lock.
+void LvglHeap::retire_tail() {
+  for (int i = CLASS_COUNT - 1; i >= 0 && tail != nullptr; i--) {
+    while (static_cast<size_t>(tail_end - tail) >= CLASS_BYTES[i]) {
+      FreeBlock *block = reinterpret_cast<FreeBlock *>(tail);
+      block->next = free_lists[i];
+      free_lists[i] = block;
+      counters.free_blocks++;
+      tail += CLASS_BYTES[i];
+    }
+  }
+  // Under the smallest class: too small to ever hand out
+  counters.free_bytes -= tail_end - tail;
+  tail = tail_end = nullptr;
+}
+
+void LvglHeap::push_free(uint8_t *block, int size_class) {
+  FreeBlock *free_block = reinterpret_cast<FreeBlock *>(block);
+  free_block->next = free_lists[size_class];
+  free_lists[size_class] = free_block;
+  counters.free_blocks++;
+  counters.free_bytes += CLASS_BYTES[size_class];
+}
+
+void LvglHeap::release(void *data) {
+  if (data == nullptr) {
+    return;
+  }
+  uint32_t *header = header_of(data);
+  uint32_t bytes = *header >> 2;
+  uint8_t tier = *header & 3;
+  if (tier == Slab) {
+    portENTER_CRITICAL(&lock);
+    int size_class = class_of(bytes);
+    push_free(reinterpret_cast<uint8_t *>(header), size_class);
+    count_free(counters.internal, bytes);
+    counters.slab_used -= CLASS_BYTES[size_class];
+    slab_requested -= bytes;
+    portEXIT_CRITICAL(&lock);
+    return;
+  }
+  heap_caps_free(header);
+  portENTER_CRITICAL(&lock);
+  count_free(tier == PsramHeap ? counters.psram : counters.internal, bytes);
+  portEXIT_CRITICAL(&lock);
+}
+
+void *LvglHeap::reallocate(void *data, size_t size) {
+  if (data == nullptr) {
+    return allocate(size);
+  }
+  uint32_t *header = header_of(data);
+  uint32_t bytes = *header >> 2;
+  uint8_t tier = *header & 3;
+  size_t needed = size + HEADER;
+  int size_class = class_of(needed);
+
+  // Same slab class: the block already fits
+  if (tier == Slab && size_class == class_of(bytes)) {
+    portENTER_CRITICAL(&lock);
+    count_free(counters.internal, bytes);
+    count_alloc(counters.internal, needed);
+    slab_requested += needed - bytes;
+    portEXIT_CRITICAL(&lock);
+    *header = needed << 2 | Slab;
+    return data;
+  }
+  // Large stays large: let the heap grow or shrink it in place
+  if (tier != Slab && size_class < 0) {
+    void *block = heap_caps_realloc(
+        header, needed, tier == PsramHeap ? PSRAM_CAPS : INTERNAL_CAPS);
+    if (block != nullptr) {
+      LvglHeapTier &counted =
+          tier == PsramHeap ? counters.psram : counters.internal;
+      portENTER_CRITICAL(&lock);
+      count_free(counted, bytes);
+      count_alloc(counted, needed);
+      portEXIT_CRITICAL(&lock);
+      return payload_of(block, needed, tier);
+    }
+  }
+  // Changes tier or class: move it
+  void *moved = allocate(size);
+  if (moved == nullptr) {
+    return nullptr;
+  }
+  size_t kept = bytes - HEADER;
+  memcpy(moved, data, kept < size ? kept : size);
+  release(data);
+  return moved;
+}
+
+void LvglHeap::count_alloc(LvglHeapTier &tier, uint32_t bytes) {
+  tier.blocks++;
+  tier.bytes += bytes;
+  if (tier.bytes > tier.peak_bytes) {
+    tier.peak_bytes = tier.bytes;
+  }
+}
+
+void LvglHeap::count_free(LvglHeapTier &tier, uint32_t bytes) {
+  tier.blocks--;
+  tier.bytes -= bytes;
+}
+
+// Caller holds the lock
+uint32_t LvglHeap::largest_free() const {
+  uint32_t largest = tail != nullptr ? tail_end - tail : 0;
+  for (int i = CLASS_COUNT - 1; i >= 0; i--) {
+    if (free_lists[i] != nullptr) {
+      return largest > CLASS_BYTES[i] ? largest : CLASS_BYTES[i];
+    }
+  }
+  return largest;
+}
+
+LvglHeapStats LvglHeap::stats() {
+  portENTER_CRITICAL(&lock);
+  LvglHeapStats copy = counters;
+  portEXIT_CRITICAL(&lock);
+  return copy;
+}
+
+// Caller holds the lock
+uint8_t LvglHeap::slab_frag_pct() const {
+  uint32_t tail_bytes = tail != nullptr ? tail_end - tail : 0;
+  uint32_t carved = counters.slab_used + counters.free_bytes - tail_bytes;
+  return carved > 0
+             ? 100 - static_cast<uint64_t>(slab_requested) * 100 / carved
+             : 0;
+}
+
+uint8_t LvglHeap::internal_frag_pct() {
+  portENTER_CRITICAL(&lock);
+  uint8_t pct = slab_frag_pct();
+  portEXIT_CRITICAL(&lock);
+  return pct;
+}
+
+uint8_t LvglHeap::psram_frag_pct() const {
+  return frag_pct(heap_caps_get_free_size(PSRAM_CAPS),
+                  heap_caps_get_largest_free_block(PSRAM_CAPS));
+}
+
+void LvglHeap::monitor(lv_mem_monitor_t *out) {
+  portENTER_CRITICAL(&lock);
+  out->total_size = counters.slabs * Constants::LvglHeap::SLAB_BYTES +
+                    counters.psram.bytes;
+  out->free_cnt = counters.free_blocks;
+  out->free_size = counters.free_bytes;
+  out->free_biggest_size = largest_free();
+  out->used_cnt = counters.internal.blocks + counters.psram.blocks;
+  out->max_used = counters.internal.peak_bytes + counters.psram.peak_bytes;
+  out->frag_pct = slab_frag_pct();
+  portEXIT_CRITICAL(&lock);
+  out->used_pct =
+      out->total_size > 0
+          ? 100 - static_cast<uint64_t>(out->free_size) * 100 /
+                      out->total_size
+          : 0;
+}
+
+void LvglHeap::print_stats() {
+  LvglHeapStats heap = stats();
+  Serial.printf("LVGL heap: internal %u B in %u blocks (peak %u, %u/%u "
+                "slabs, %u B free, %u%% frag) | PSRAM %u B in %u blocks "
+                "(peak %u, %u%% frag) | %u spills | %u fallbacks | "
+                "%u failed\n",
+                heap.internal.bytes, heap.internal.blocks,
+                heap.internal.peak_bytes, heap.slabs,
+                Constants::LvglHeap::INTERNAL_BUDGET /
+                    Constants::LvglHeap::SLAB_BYTES,
+                heap.free_bytes, internal_frag_pct(), heap.psram.bytes,
+                heap.psram.blocks, heap.psram.peak_bytes, psram_frag_pct(),
+                heap.spills, heap.fallbacks, heap.failed);
+}
+
+// LVGL's core allocator hooks (lv_mem.h), in place of lv_mem_core_*.c
+extern "C" {
+
+void lv_mem_init(void) {}
+
+void lv_mem_deinit(void) {}
+
+lv_mem_pool_t lv_mem_add_pool(void * /*mem*/, size_t /*bytes*/) {
+  return nullptr; // Grows from the system heap instead
+}
+
+void lv_mem_remove_pool(lv_mem_pool_t /*pool*/) {}
+
+void *lv_malloc_core(size_t size) { return lvgl_heap.allocate(size); }
+
+void *lv_realloc_core(void *p, size_t new_size) {
+  return lvgl_heap.reallocate(p, new_size);
+}
+
+void lv_free_core(void *p) { lvgl_heap.release(p); }
+
+void lv_mem_monitor_core(lv_mem_monitor_t *mon_p) {
+  lvgl_heap.monitor(mon_p);
+}
+
+lv_result_t lv_mem_test_core(void) { return LV_RESULT_OK; }
+
+} // extern "C"
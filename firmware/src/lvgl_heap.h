@@ -0,0 +1,101 @@
+/**
+ * Tiered allocator behind lv_malloc (LV_STDLIB_CUSTOM in lv_conf.h)
+ *
+ * LVGL allocates two kinds of memory. Objects, styles, event lists and
+ * short strings are small and touched on every refresh. Draw layers,
+ * image cache entries and long label text are large and touched rarely.
+ * One fixed pool in PSRAM made both pay PSRAM latency, and sizing it meant
+ * guessing the peak.
+ *  - Small blocks (header included, up to SMALL_MAX bytes) come from size
+ *    classes carved out of internal RAM slabs. A freed block goes back to
+ *    its class's free list. Slabs are taken SLAB_BYTES at a time, as the UI
+ *    needs them, up to INTERNAL_BUDGET, and are never handed back.
+ *  - Larger blocks go to the PSRAM heap.
+ * Past the budget, small blocks spill to PSRAM. A large block the PSRAM
+ * heap cannot serve falls back to the internal heap. Both are counted.
+ *
+ * Every block carries a 4-byte header with its tier and requested size, so
+ * free and realloc need no lookup. LVGL's draw tasks allocate too: the
+ * free lists and counters are guarded by a spinlock, and the system heap
+ * calls are made outside it.
+ *
+ * Fragmentation, per tier:
+ *  - Internal RAM: the share of carved slab memory that holds no data,
+ *    from class rounding and from free blocks waiting for reuse. The open
+ *    slab's uncarved tail is room to grow, not fragmentation.
+ *  - PSRAM: lv_mem_monitor()'s measure on the system heap, the share of
+ *    free memory the largest free block does not cover.
+ */
+
+#ifndef LVGL_HEAP_H
+#define LVGL_HEAP_H
+
+#include <Arduino.h>
+#include <lvgl.h>
+
+#include "constants.h"
+
+struct LvglHeapTier {
+  uint32_t blocks; // Live
+  uint32_t bytes;  // Held by live blocks, headers included
+  uint32_t peak_bytes;
+};
+
+struct LvglHeapStats {
+  LvglHeapTier internal; // Slab blocks and internal fallbacks
+  LvglHeapTier psram;
+  uint32_t slabs;
+  uint32_t slab_used;   // Class bytes of live slab blocks
+  uint32_t free_blocks; // Internal: in the class free lists
+  uint32_t free_bytes;  // Internal: free class blocks and the slab tail
+  uint32_t spills;      // Small blocks in PSRAM, internal budget spent
+  uint32_t fallbacks;   // Large blocks in internal RAM, PSRAM full
+  uint32_t failed;      // Requests neither tier could serve
+};
+
+class LvglHeap {
+public:
+  void *allocate(size_t size);
+  void *reallocate(void *data, size_t size);
+  void release(void *data);
+
+  // Fills LVGL's monitor (lv_mem_monitor) over both tiers
+  void monitor(lv_mem_monitor_t *out);
+
+  LvglHeapStats stats();
+  uint8_t internal_frag_pct();
+  uint8_t psram_frag_pct() const;
+  void print_stats();
+
+private:
+  static const int CLASS_COUNT = 9;
+  static const uint16_t CLASS_BYTES[CLASS_COUNT];
+
+  enum Tier : uint8_t { Slab, InternalHeap, PsramHeap };
+
+  static int class_of(size_t bytes);
+  void *take_small(int size_class, uint32_t bytes);
+  void *take_large(size_t bytes, bool small);
+  bool grow();
+  void retire_tail();
+  void push_free(uint8_t *block, int size_class);
+  uint32_t largest_free() const;
+  void count_alloc(LvglHeapTier &tier, uint32_t bytes);
+  void count_free(LvglHeapTier &tier, uint32_t bytes);
+  uint8_t slab_frag_pct() const;
+
+  struct FreeBlock {
+    FreeBlock *next;
+  };
+
+  FreeBlock *free_lists[CLASS_COUNT] = {};
+  uint8_t *tail = nullptr; // Uncarved part of the newest slab
+  uint8_t *tail_end = nullptr;
+  uint32_t slab_requested = 0; // Live slab blocks, as requested
+  LvglHeapStats counters = {};
+  portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+};
+
+extern LvglHeap lvgl_heap;
+
+#endif // LVGL_HEAP_H
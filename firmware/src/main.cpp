@@ -10,14 +10,35 @@
 
 #include <Arduino.h>
 #include <ArduinoJson.h>
-#include <BLE2902.h>
 #include <BLEDevice.h>
 #include <BLEServer.h>
 #include <BLEUtils.h>
 #include <SPIFFS.h>
 
 // LilyGo T-Display AMOLED includes
+#include "alloc_counter.h"
+#include "bench.h"
+#include "ble_session.h"
+#include "button_input.h"
+#include "command_channel.h"
 #include "constants.h"
+#include "fixed_string.h"
+#include "gatt_table.h"
+#include "latency_probe.h"
+#include "lvgl_heap.h"
+#include "notification_center.h"
+#include "outbox.h"
+#include "protocol.h"
+#include "response_cache.h"
+#include "screen_mirror.h"
+#include "settings.h"
+#include "stall_monitor.h"
+#include "status_led.h"
+#include "touch_input.h"
+#include "ui_events.h"
+#include "ui_state.h"
+#include "usb_link.h"
+#include "wifi_bulk.h"
 #include <LV_Helper.h>
 #include <LilyGo_AMOLED.h>
 
@@ -37,110 +58,73 @@ lv_obj_t *btn1_label;
 // BLE variables
 BLEServer *pServer = nullptr;
 BLECharacteristic *pTxCharacteristic = nullptr;
-BLECharacteristic *pRxCharacteristic = nullptr;
-bool deviceConnected = false;
-bool oldDeviceConnected = false;
+bool oldDeviceConnected = false; // Any central connected on the last pass
+uint32_t readvertise_at = 0;     // Pending advertising restart, 0 if none
 
-// BLE UUIDs (Nordic UART Service compatible)
-// These UUIDs provide compatibility with standard BLE UART implementations
-#define SERVICE_UUID "6E400001-B5A3-F393-E0A9-E50E24DCCA9E"
-#define CHARACTERISTIC_UUID_RX "6E400002-B5A3-F393-E0A9-E50E24DCCA9E"
-#define CHARACTERISTIC_UUID_TX "6E400003-B5A3-F393-E0A9-E50E24DCCA9E"
+// Application state (device name, brightness, intervals: see settings.h)
+bool display_asleep = false;
+bool storage_failed = false; // Shown as the error animation
+bool history_shown = false;  // Label holds the history, not MessageIndex
+uint8_t greeting_due = 0;    // Peers (bits) owed the "connected" message
 
-// Application state
-String device_name = "AI-Companion";
-String current_message = "Welcome to your AI Companion!";
+// Peer whose confirm the outbox batch awaits (see flush_outbox)
+int8_t outbox_peer = BLE_BROADCAST;
 
-int battery_percentage = 100;
+// Peers, battery, brightness and the message on screen: see ui_state.h
 unsigned long last_message_time = 0;
 unsigned long last_battery_update = 0;
+uint32_t save_state_at = 0; // Pending settings write, 0 if none
 
-// Message queue for display
+// Message queue for display, stored inline so adding text never allocates
 const int MAX_MESSAGES = 10;
-String message_queue[MAX_MESSAGES];
+typedef FixedString<Constants::Messages::MAX_MESSAGE_LENGTH + 1> MessageText;
+MessageText message_queue[MAX_MESSAGES];
 int message_count = 0;
-int current_message_index = 0;
+
+// Iteration SLO and stall tracking for loop() (see stall_monitor.h)
+int8_t loop_lane = -1;
+
+// Heap allocations made while handling inbound messages (alloc build only)
+uint32_t handled_messages = 0;
+uint32_t message_allocations = 0;
 
 // Forward declarations
 bool setup_display();
 void setup_ui();
 void setup_ble();
-void send_ble_message(const String &type, const String &message,
-                      const String &action = "");
-void update_connection_status();
+void send_text_message(Protocol::MessageType type, const char *message,
+                       const char *action, int8_t peer = BLE_BROADCAST);
+bool send_message(Protocol::Message &message, int8_t peer = BLE_BROADCAST);
+bool send_ble_json(JsonDocument &doc, int8_t peer = BLE_BROADCAST,
+                   bool track = false);
+void send_ai_request(const char *request, const char *action);
+void queue_user_action(Protocol::MessageType type, const char *message,
+                       const char *action, int8_t peer = BLE_BROADCAST);
+int8_t first_peer(uint32_t now, bool ready_only);
+void flush_outbox();
+void greet_ready_peers();
+void finish_bulk_transfer();
+size_t read_message_history(size_t offset, uint8_t *out, size_t capacity);
+void fill_metrics(Protocol::Metrics &metrics);
+void apply_settings(const DeviceSettings &previous);
+void handle_session_event(const SessionEvent &event);
+void handle_incoming_message(int8_t peer, const char *json);
+void handle_binary_message(int8_t peer, const uint8_t *data, size_t length);
+void dispatch_message(int8_t peer, const Protocol::Message &msg,
+                      const char *json);
+void handle_ui_event(const UiEvent &event);
+void log_line(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+void update_display_sleep();
+void update_status_led();
 void update_battery_status();
-void add_message_to_queue(const String &message);
+void send_device_status();
+void persist_ui_state();
+void add_message_to_queue(std::string_view message);
+void add_message_to_queue(const char *prefix, const char *text);
+void display_message(int index);
 void display_next_message();
 void display_previous_message();
-
-// BLE Server Callbacks
-class MyServerCallbacks : public BLEServerCallbacks {
-  void onConnect(BLEServer *pServer) {
-    deviceConnected = true;
-    Serial.println("BLE Client connected");
-
-    // Log current MTU for debugging
-    uint16_t currentMTU = pServer->getPeerMTU(pServer->getConnId());
-    Serial.printf("📡 MTU negotiated: %d bytes\n", currentMTU);
-
-    // Log connection for monitoring (production: consider privacy implications)
-    // Note: BLE peer address access varies by ESP32 BLE library version
-    Serial.printf("🔐 Device connected from BLE client\n");
-
-    add_message_to_queue("📱 Phone connected!");
-    send_ble_message("connected", "ESP32 ready for communication", "ready");
-  };
-
-  void onDisconnect(BLEServer *pServer) {
-    deviceConnected = false;
-    Serial.println("BLE Client disconnected");
-    add_message_to_queue("📱 Phone disconnected");
-    // Restart advertising
-    BLEDevice::startAdvertising();
-  }
-};
-
-// BLE Characteristic Callbacks
-class MyCallbacks : public BLECharacteristicCallbacks {
-  void onWrite(BLECharacteristic *pCharacteristic) {
-    String received_data = pCharacteristic->getValue().c_str();
-
-    if (received_data.length() > 0) {
-      Serial.println("BLE Received: " + received_data);
-
-      // Parse JSON data
-      JsonDocument doc;
-      DeserializationError error = deserializeJson(doc, received_data);
-
-      if (error) {
-        Serial.println("JSON parsing failed: " + String(error.c_str()));
-        return;
-      }
-
-      String type = doc["type"] | "";
-      String message = doc["message"] | "";
-
-      if (type == "ai_request") {
-        add_message_to_queue("🤖 Processing: " + message);
-        send_ble_message("ai_response", "AI Response to: " + message,
-                         "processed");
-        display_next_message();
-      } else if (type == "test") {
-        add_message_to_queue("📱 " + message);
-        send_ble_message("test_response", "Hello from ESP32!", "ack");
-        display_next_message();
-      } else if (type == "hello") {
-        add_message_to_queue("📱 " + message);
-        send_ble_message("welcome", "Hello from ESP32! Ready to chat.",
-                         "ready");
-        display_next_message();
-      } else {
-        add_message_to_queue("📱 " + message);
-        display_next_message();
-      }
-    }
-  }
-};
+void display_history();
 
 // LVGL display buffer - will be handled by LV_Helper
 // T-Display AMOLED dimensions: 536x240
@@ -151,21 +135,68 @@ static const uint16_t screenHeight = 240;
 static void btn1_event_handler(lv_event_t *e) {
   lv_event_code_t code = lv_event_get_code(e);
   if (code == LV_EVENT_CLICKED) {
+    // Timed from the release that completed the click, not the press
+    latency_probe.event(esp_timer_get_time(), touch_input.input_us());
     Serial.println("Ask AI button pressed");
     add_message_to_queue("🔵 AI Assistant: How can I help you?");
 
-    // Send BLE message to phone if connected
-    if (deviceConnected) {
-      send_ble_message("btn", "Ask AI", "ask");
-    }
+    // Sent to one connected phone, or kept in the outbox while offline
+    send_ai_request("Ask AI", "ask");
 
     display_next_message();
   }
 }
 
+// Frame that shows the click feedback: render start and flush completion
+static void display_latency_event(lv_event_t *e) {
+  uint32_t now = esp_timer_get_time();
+  if (lv_event_get_code(e) == LV_EVENT_RENDER_START) {
+    latency_probe.render_start(now);
+    return;
+  }
+  LatencySample sample;
+  if (latency_probe.flush_done(now, sample)) {
+    // Replayable on the host, see tools/latency_replay
+    Serial.printf("LAT %u %u %u %u\n", sample.input_us, sample.event_us,
+                  sample.render_us, sample.flush_us);
+  }
+}
+
+// UI state observers (see ui_state.h): each runs once when bound and then
+// only when its value changes
+static void connection_observer(lv_observer_t *observer,
+                                lv_subject_t *subject) {
+  lv_obj_t *label = lv_observer_get_target_obj(observer);
+  int peers = lv_subject_get_int(subject);
+  if (peers > 1) {
+    lv_label_set_text_fmt(label, "🟢 Connected (%d)", peers);
+  } else if (peers == 1) {
+    lv_label_set_text(label, "🟢 Connected");
+  } else {
+    lv_label_set_text(label, "🔴 Disconnected");
+  }
+}
+
+static void message_observer(lv_observer_t *observer, lv_subject_t *subject) {
+  // Keeps the boot text until the first message arrives
+  if (message_count > 0) {
+    lv_label_set_text(lv_observer_get_target_obj(observer),
+                      message_queue[lv_subject_get_int(subject)].c_str());
+  }
+}
+
+static void brightness_observer(lv_observer_t *, lv_subject_t *subject) {
+  // A dark panel picks the new level up when it wakes
+  if (!display_asleep) {
+    amoled.setBrightness(lv_subject_get_int(subject));
+  }
+}
+
 // Touch input and display handling will be managed by LV_Helper
 
 void setup() {
+  // Room for USB asset chunks queued while a flash write is in progress
+  Serial.setRxBufferSize(Constants::Usb::RX_BUFFER_SIZE);
   Serial.begin(115200);
   delay(1000); // Give serial time to initialize
   Serial.println("\n=== AI Companion Device Starting ===");
@@ -174,10 +205,22 @@ void setup() {
   Serial.print("Initializing SPIFFS... ");
   if (!SPIFFS.begin(true)) {
     Serial.println("FAILED!");
+    storage_failed = true;
   } else {
     Serial.println("OK");
   }
 
+  // Status pixel animations run on RMT + esp_timer, off the CPU
+  if (status_led.begin(Constants::Led::PIN)) {
+    Serial.println("Status LED on RMT ready");
+  }
+
+  // Restore actions queued while no phone was connected
+  outbox.begin();
+
+  // Load persisted settings before anything that depends on them
+  load_settings();
+
   // Initialize display
   Serial.print("Initializing display... ");
   if (!setup_display()) {
@@ -187,16 +230,36 @@ void setup() {
   }
   Serial.println("OK");
 
+  // LVGL's draw tasks are running: widgets and the indev under its lock
+  lv_lock();
+
   // Setup LVGL UI
   Serial.print("Setting up UI... ");
   setup_ui();
   Serial.println("OK");
 
+  // Hardware button and touch gestures feed one UI event queue
+  Serial.print("Initializing input... ");
+  ui_events.begin();
+  button_input.begin(Constants::Buttons::BOOT_PIN);
+  if (!touch_input.begin(Constants::Touch::IRQ_PIN)) {
+    Serial.print("(no touch) ");
+  }
+  Serial.println("OK");
+  lv_unlock();
+
   // Initialize BLE
   Serial.print("Initializing BLE... ");
   setup_ble();
   Serial.println("OK");
 
+  // Watch loop() passes from here on; the task watchdog catches a pass
+  // that never returns
+  enableLoopWDT();
+  stall_monitor.begin();
+  loop_lane = stall_monitor.watch("loop", Constants::Watchdog::LOOP_SLO_US,
+                                  Constants::Watchdog::LOOP_STALL_MS);
+
   Serial.println("=== Setup completed successfully! ===");
   Serial.println("ESP32 ready for BLE connections");
 }
@@ -212,17 +275,28 @@ bool setup_display() {
   }
 
   amoled.setRotation(0);
-  amoled.setBrightness(200); // Adjust brightness (0-255)
+  amoled.setBrightness(device_settings.brightness); // 0-255
 
   // Use LV_Helper but with potential workaround for LVGL 9.3.0 API issue
   beginLvglHelper(amoled);
 
+  // Touch-to-photon latency probe (see latency_probe.h)
+  lv_display_t *display = lv_display_get_default();
+  lv_display_add_event_cb(display, display_latency_event,
+                          LV_EVENT_RENDER_START, nullptr);
+  lv_display_add_event_cb(display, display_latency_event, LV_EVENT_REFR_READY,
+                          nullptr);
+
+  // Screen mirror flush hook, idle until a phone asks for the stream
+  screen_mirror.begin(display);
+
   Serial.println("OK");
   return true;
 }
 
 void setup_ui() {
   Serial.println("Setting up UI...");
+  ui_state.begin(device_settings.brightness);
 
   // Create main screen
   main_screen = lv_obj_create(nullptr);
@@ -239,17 +313,19 @@ void setup_ui() {
 
   // Connection status label
   connection_label = lv_label_create(status_bar);
-  lv_label_set_text(connection_label, "🔴 Disconnected");
   lv_obj_set_style_text_color(connection_label, lv_color_hex(0xFFFFFF),
                               LV_PART_MAIN);
   lv_obj_set_pos(connection_label, 8, 10);
+  lv_subject_add_observer_obj(ui_state.subject(UiField::Peers),
+                              connection_observer, connection_label, nullptr);
   // Increase text size for readability
   lv_obj_set_style_text_font(connection_label, &lv_font_montserrat_16,
                              LV_PART_MAIN);
 
   // Battery status label
   battery_label = lv_label_create(status_bar);
-  lv_label_set_text(battery_label, "🔋 100%");
+  lv_label_bind_text(battery_label, ui_state.subject(UiField::Battery),
+                     "🔋 %d%%");
   lv_obj_set_style_text_color(battery_label, lv_color_hex(0xFFFFFF),
                               LV_PART_MAIN);
   lv_obj_align(battery_label, LV_ALIGN_TOP_RIGHT, -8, 10);
@@ -257,14 +333,13 @@ void setup_ui() {
   lv_obj_set_style_text_font(battery_label, &lv_font_montserrat_16,
                              LV_PART_MAIN);
 
-  // Initially hide the Ask AI button (will be shown in connected mode)
+  // Ask AI button, always shown: offline presses wait in the outbox
   btn1 = lv_button_create(status_bar);
   lv_obj_set_size(btn1, 90, 30);
   lv_obj_align(btn1, LV_ALIGN_TOP_RIGHT, -95, 7);
   lv_obj_set_style_bg_color(btn1, lv_color_hex(0x4CAF50), LV_PART_MAIN);
   lv_obj_set_style_radius(btn1, 15, LV_PART_MAIN);
   lv_obj_add_event_cb(btn1, btn1_event_handler, LV_EVENT_CLICKED, nullptr);
-  lv_obj_add_flag(btn1, LV_OBJ_FLAG_HIDDEN); // Initially hidden
 
   btn1_label = lv_label_create(btn1);
   lv_label_set_text(btn1_label, "Ask AI");
@@ -282,6 +357,8 @@ void setup_ui() {
                                 LV_PART_MAIN);
   lv_obj_set_style_border_width(message_container, 2, LV_PART_MAIN);
   lv_obj_set_style_radius(message_container, 10, LV_PART_MAIN);
+  // Drags on the message area are swipe gestures, not scrolling
+  lv_obj_remove_flag(message_container, LV_OBJ_FLAG_SCROLLABLE);
 
   // Current message label
   current_message_label = lv_label_create(message_container);
@@ -296,6 +373,11 @@ void setup_ui() {
   lv_obj_set_style_text_font(current_message_label, &lv_font_montserrat_18,
                              LV_PART_MAIN);
   lv_obj_center(current_message_label);
+  lv_subject_add_observer_obj(ui_state.subject(UiField::MessageIndex),
+                              message_observer, current_message_label,
+                              nullptr);
+  lv_subject_add_observer(ui_state.subject(UiField::Brightness),
+                          brightness_observer, nullptr);
 
   Serial.println("UI setup completed!");
 }
@@ -303,206 +385,963 @@ void setup_ui() {
 void loop() {
   static unsigned long last_heartbeat = 0;
   unsigned long current_time = millis();
+  stall_monitor.start(loop_lane);
+  // LVGL renders in its own draw tasks (LV_USE_OS): every LVGL call of
+  // this pass holds its lock, which is recursive, so lv_timer_handler()
+  // still works below. A task that needs LVGL gets it during the delay.
+  lv_lock();
 
   // Status check every 5 seconds
   if (current_time - last_heartbeat > 5000) {
     Serial.printf("Status: %s | Messages: %d\n",
-                  deviceConnected ? "Connected" : "Advertising", message_count);
+                  ble_sessions.is_connected() ? "Connected" : "Advertising",
+                  message_count);
+    if (ble_sessions.is_connected()) {
+      ble_sessions.print_stats();
+    }
+    const NotificationStats &notes = notification_center.stats();
+    if (notes.received > 0) {
+      Serial.printf("Notifications: %u received | %u coalesced | %u shown | "
+                    "%u dropped | %d pending | max wait %u ms\n",
+                    notes.received, notes.coalesced, notes.displayed,
+                    notes.dropped, notification_center.pending_apps(),
+                    notes.max_pending_ms);
+    }
+    const CacheStats &cache = response_cache.stats();
+    if (cache.lookups > 0) {
+      Serial.printf("Response cache: %u%% hits (%u/%u) | %u evicted | "
+                    "%u refreshed | %u ms saved | avg rtt %u ms\n",
+                    cache.hit_rate_percent(), cache.hits, cache.lookups,
+                    cache.evictions, cache.refreshed, cache.saved_ms,
+                    cache.completed > 0 ? cache.total_rtt_ms / cache.completed
+                                        : 0);
+    }
+    const UiEventStats &input = ui_events.stats();
+    if (input.handled > 0) {
+      Serial.printf("Input: %u gestures | %u dropped | avg recognize %u us | "
+                    "avg dispatch %u us | max %u us\n",
+                    input.handled, input.dropped,
+                    input.total_recognize_us / input.handled,
+                    input.total_dispatch_us / input.handled,
+                    input.max_latency_us);
+    }
+    const TouchStats &touch = touch_input.stats();
+    if (touch.reads > 0) {
+      uint32_t avg_read_us = touch.total_read_us / touch.reads;
+      uint32_t avoided = touch_input.polls_avoided(current_time);
+      // CPU a timer-polled indev would have spent, per second of uptime
+      uint32_t saved_us_per_s = static_cast<uint64_t>(avoided) * avg_read_us /
+                                (current_time / 1000 + 1);
+      Serial.printf("Touch: %u irqs | %u reads (%u idle, avg %u us) | "
+                    "%u polls avoided (~%u us/s CPU) | max irq->read %u us | "
+                    "%u gestures\n",
+                    touch.irqs, touch.reads, touch.idle_reads, avg_read_us,
+                    avoided, saved_us_per_s, touch.max_irq_to_read_us,
+                    touch.gestures);
+    }
+    static uint32_t reported_latency_samples = 0;
+    if (latency_probe.total().count() != reported_latency_samples) {
+      char summary[256];
+      latency_probe.format_summary(summary, sizeof(summary));
+      Serial.printf("Tap latency: %s\n", summary);
+      reported_latency_samples = latency_probe.total().count();
+    }
+    stall_monitor.print_stats();
+    screen_mirror.print_stats();
+    lvgl_heap.print_stats();
+#ifdef COUNT_ALLOCATIONS
+    if (handled_messages > 0) {
+      Serial.printf("Allocations: %u per message (%u over %u messages)\n",
+                    message_allocations / handled_messages,
+                    message_allocations, handled_messages);
+    }
+#endif
     last_heartbeat = current_time;
   }
 
   // Handle LVGL tasks (using LVGL 9.x API)
   lv_timer_handler();
 
+  // Touch reads follow the controller interrupt, see touch_input.h
+  touch_input.service(millis());
+
+  // Gestures recognized by the input paths; LVGL is only touched from here
+  UiEvent ui_event;
+  while (ui_events.next(ui_event)) {
+    handle_ui_event(ui_event);
+  }
+  update_display_sleep();
+  update_status_led();
+
+  // Per-peer connect/disconnect events queued by the BLE task
+  SessionEvent event;
+  while (ble_sessions.poll_event(event)) {
+    handle_session_event(event);
+  }
+
+  // Parse every complete frame reassembled from the centrals' writes
+  static char inbound[Constants::Bluetooth::RX_BUFFER_SIZE];
+  int8_t peer;
+  while (ble_sessions.next_inbound(peer, inbound, sizeof(inbound))) {
+    handle_incoming_message(peer, inbound);
+  }
+
+  // Same protocol over the USB-CDC link (host CLI, bench and factory tools)
+  FrameKind kind;
+  size_t length;
+  while (usb_link.next_inbound(kind, inbound, sizeof(inbound), length)) {
+    if (kind == FrameKind::Binary) {
+      handle_binary_message(USB_PEER, reinterpret_cast<uint8_t *>(inbound),
+                            length);
+    } else {
+      handle_incoming_message(USB_PEER, inbound);
+    }
+  }
+
+  // Release coalesced notifications at the display rate limit
+  static char notification_line[Constants::Notifications::MAX_TEXT_LENGTH +
+                                64];
+  if (notification_center.next_display(notification_line,
+                                       sizeof(notification_line), millis())) {
+    add_message_to_queue(notification_line);
+  }
+
+  // Greet new phones and deliver actions queued while offline once they
+  // are ready for full-size frames
+  greet_ready_peers();
+  flush_outbox();
+
+  // Wi-Fi off once the bulk task ends its session (requests run there)
+  if (wifi_bulk.poll()) {
+    finish_bulk_transfer();
+  }
+
+  // Changed screen tiles for a mirroring phone, within its budget
+  screen_mirror.service(millis());
+
+  // Drain the per-peer TX queues
+  ble_sessions.service_tx();
+
   // Handle BLE connection status changes
+  bool deviceConnected = ble_sessions.is_connected();
   if (!deviceConnected && oldDeviceConnected) {
     Serial.println("BLE: Device disconnected, restarting advertising");
-    delay(500); // Give the bluetooth stack the chance to get things ready
+    // Give the bluetooth stack the chance to get things ready, without
+    // holding up rendering
+    readvertise_at = current_time + Constants::Bluetooth::READVERTISE_DELAY_MS;
+    oldDeviceConnected = deviceConnected;
+  }
+  if (readvertise_at != 0 &&
+      static_cast<int32_t>(current_time - readvertise_at) >= 0) {
+    readvertise_at = 0;
     pServer->startAdvertising(); // Restart advertising
     Serial.println("BLE: Advertising restarted");
-    oldDeviceConnected = deviceConnected;
-    update_connection_status();
-    // Hide the Ask AI button when disconnected
-    lv_obj_add_flag(btn1, LV_OBJ_FLAG_HIDDEN);
   }
 
   // Connected to a client
   if (deviceConnected && !oldDeviceConnected) {
     Serial.println("BLE: Device connected!");
     oldDeviceConnected = deviceConnected;
-    update_connection_status();
-    // Show the Ask AI button when connected
-    lv_obj_clear_flag(btn1, LV_OBJ_FLAG_HIDDEN);
     add_message_to_queue("Ready to communicate!");
     display_next_message();
   }
 
-  // Update status indicators periodically
-  if (current_time - last_message_time > 30000) { // 30 seconds
-    update_connection_status();
+  // Reconcile the peer count periodically; redraws only if it drifted
+  if (current_time - last_message_time > device_settings.status_interval_ms) {
+    ui_state.set(UiField::Peers, ble_sessions.connected_count());
     last_message_time = current_time;
   }
 
-  if (current_time - last_battery_update > 60000) { // 1 minute
+  if (current_time - last_battery_update >
+      device_settings.battery_interval_ms) {
     update_battery_status();
     last_battery_update = current_time;
   }
 
+  // State changes from this pass: one status frame, one deferred NVS write
+  uint32_t changes = ui_state.take_changes();
+  if (changes & UiState::STATUS_FIELDS) {
+    send_device_status();
+  }
+  if (changes & UiState::PERSISTED_FIELDS) {
+    save_state_at = current_time + Constants::Settings::SAVE_DELAY_MS;
+  }
+  if (save_state_at != 0 &&
+      static_cast<int32_t>(current_time - save_state_at) >= 0) {
+    save_state_at = 0;
+    persist_ui_state();
+  }
+
+  lv_unlock();
+  stall_monitor.finish(loop_lane);
   delay(5); // Small delay for stability
 }
 
-void update_connection_status() {
-  if (deviceConnected) {
-    lv_label_set_text(connection_label, "🟢 Connected");
-  } else {
-    lv_label_set_text(connection_label, "🔴 Disconnected");
+void handle_ui_event(const UiEvent &event) {
+  // The first input on a dark panel only wakes it
+  bool was_asleep = display_asleep;
+  lv_display_trigger_activity(nullptr);
+  update_display_sleep();
+  if (was_asleep) {
+    ui_events.complete(event);
+    return;
+  }
+
+  switch (event.type) {
+  case UiEventType::NextMessage:
+    display_next_message();
+    break;
+  case UiEventType::PreviousMessage:
+    display_previous_message();
+    break;
+  case UiEventType::ShowHistory:
+    display_history();
+    break;
+  case UiEventType::QuickAction:
+    Serial.println("Quick action (long press)");
+    add_message_to_queue("⚡ Quick action sent");
+    send_ai_request("Quick action", "quick");
+    break;
+  }
+  ui_events.complete(event);
+}
+
+// Darkens the panel after SCREEN_SLEEP_MS without touch, button or message
+// activity (LVGL tracks the inactive time) and lights it again on activity
+void update_display_sleep() {
+  bool idle = lv_display_get_inactive_time(nullptr) >
+              static_cast<uint32_t>(Constants::Timing::SCREEN_SLEEP_MS);
+  if (idle != display_asleep) {
+    display_asleep = idle;
+    amoled.setBrightness(idle ? 0 : ui_state.get(UiField::Brightness));
   }
 }
 
+// Picks the LED animation; only a change of pattern costs anything
+void update_status_led() {
+  LedPattern pattern = LedPattern::Advertising;
+  if (storage_failed) {
+    pattern = LedPattern::Error;
+  } else if (wifi_bulk.active() || usb_link.asset_in_progress()) {
+    pattern = LedPattern::Streaming;
+  } else if (ui_state.get(UiField::Battery) <=
+             Constants::Battery::LOW_BATTERY_THRESHOLD) {
+    pattern = LedPattern::LowBattery;
+  } else if (ble_sessions.is_connected()) {
+    pattern = LedPattern::Connected;
+  }
+  status_led.set(pattern);
+}
+
 void update_battery_status() {
   // Battery simulation for proof of concept
   // TODO: Implement actual battery monitoring via ADC
-  battery_percentage = random(75, 100);
+  // The bound label redraws only when the reading changes
+  ui_state.set(UiField::Battery, random(75, 100));
+}
 
-  String battery_text = "🔋 " + String(battery_percentage) + "%";
-  lv_label_set_text(battery_label, battery_text.c_str());
+// Current UI state for the phones (and a USB host)
+void send_device_status() {
+  if (!ble_sessions.is_connected() && !usb_link.host_attached()) {
+    return;
+  }
+  Protocol::Message status{};
+  status.type = Protocol::MessageType::DeviceStatus;
+  Protocol::DeviceStatus &body = status.body.device_status;
+  body.peers = ui_state.get(UiField::Peers);
+  body.battery = ui_state.get(UiField::Battery);
+  body.brightness = ui_state.get(UiField::Brightness);
+  send_message(status);
 }
 
-void add_message_to_queue(const String &message) {
-  // Add message to queue
-  if (message_count < MAX_MESSAGES) {
-    message_queue[message_count] = message;
-    message_count++;
-  } else {
-    // Shift messages and add new one
-    for (int i = 0; i < MAX_MESSAGES - 1; i++) {
-      message_queue[i] = message_queue[i + 1];
-    }
-    message_queue[MAX_MESSAGES - 1] = message;
+// Writes persisted UI state back to the settings blob. Command batches
+// save their own changes, so this only writes what changed on the device.
+void persist_ui_state() {
+  uint8_t brightness = ui_state.get(UiField::Brightness);
+  if (device_settings.brightness != brightness) {
+    device_settings.brightness = brightness;
+    save_settings();
   }
+}
 
-  // Display the latest message
-  current_message_index = message_count - 1;
-  if (current_message_index >= MAX_MESSAGES) {
-    current_message_index = MAX_MESSAGES - 1;
+// Slot for the next message; the oldest one is dropped when full
+MessageText &next_message_slot() {
+  if (message_count < MAX_MESSAGES) {
+    return message_queue[message_count++];
   }
+  // Shift messages and reuse the last slot
+  for (int i = 0; i < MAX_MESSAGES - 1; i++) {
+    message_queue[i] = message_queue[i + 1];
+  }
+  return message_queue[MAX_MESSAGES - 1];
+}
 
-  // Update display
-  if (message_count > 0) {
-    lv_label_set_text(current_message_label,
-                      message_queue[current_message_index].c_str());
+void show_latest_message() {
+  // New messages light the panel
+  lv_display_trigger_activity(nullptr);
+
+  // Display the latest message; a full queue shifts under an unchanged
+  // index, so the label is told about the new text explicitly
+  int index = min(message_count, MAX_MESSAGES) - 1;
+  ui_state.set(UiField::Messages, ui_state.get(UiField::Messages) + 1);
+  if (!ui_state.set(UiField::MessageIndex, index)) {
+    ui_state.notify(UiField::MessageIndex);
   }
+  history_shown = false;
 
-  Serial.println("Added message: " + message);
+  log_line("Added message: %s", message_queue[index].c_str());
+}
+
+void add_message_to_queue(std::string_view message) {
+  next_message_slot().assign(message);
+  show_latest_message();
+}
+
+// Prefixed text (an emoji tag) goes straight into the queue slot
+void add_message_to_queue(const char *prefix, const char *text) {
+  MessageText &slot = next_message_slot();
+  slot.assign(prefix);
+  slot.append(text);
+  show_latest_message();
+}
+
+// Leaving the history view must redraw even when the index stays put
+// (a swipe past the newest message), or the history would stay on screen
+void display_message(int index) {
+  if (!ui_state.set(UiField::MessageIndex, index) && history_shown) {
+    ui_state.notify(UiField::MessageIndex);
+  }
+  history_shown = false;
 }
 
 void display_next_message() {
-  if (message_count > 0 && current_message_index < message_count - 1) {
-    current_message_index++;
-    lv_label_set_text(current_message_label,
-                      message_queue[current_message_index].c_str());
+  int index = ui_state.get(UiField::MessageIndex);
+  if (message_count > 0 && index < message_count - 1) {
+    index++;
   }
+  display_message(index);
 }
 
 void display_previous_message() {
-  if (message_count > 0 && current_message_index > 0) {
-    current_message_index--;
-    lv_label_set_text(current_message_label,
-                      message_queue[current_message_index].c_str());
+  int index = ui_state.get(UiField::MessageIndex);
+  if (message_count > 0 && index > 0) {
+    index--;
+  }
+  display_message(index);
+}
+
+// Most recent messages first; a swipe or click returns to single messages
+void display_history() {
+  static FixedString<Constants::UI::HISTORY_LINES *
+                     (MessageText::capacity() + 1)>
+      history;
+  history.clear();
+  int oldest = max(0, message_count - Constants::UI::HISTORY_LINES);
+  for (int i = message_count - 1; i >= oldest; i--) {
+    history += message_queue[i].view();
+    if (i > oldest) {
+      history += "\n";
+    }
   }
+  lv_label_set_text(current_message_label, history.c_str());
+  history_shown = true;
 }
 
 void setup_ble() {
   Serial.println("Initializing BLE...");
 
   // Initialize BLE Device
-  BLEDevice::init(device_name.c_str());
+  BLEDevice::init(device_settings.device_name);
 
   // Create BLE Server
   pServer = BLEDevice::createServer();
-  pServer->setCallbacks(new MyServerCallbacks());
-
-  // Create BLE Service
-  BLEService *pService = pServer->createService(SERVICE_UUID);
 
-  // Create BLE Characteristics
-  pTxCharacteristic = pService->createCharacteristic(
-      CHARACTERISTIC_UUID_TX,
-      BLECharacteristic::PROPERTY_NOTIFY | BLECharacteristic::PROPERTY_READ);
-  pTxCharacteristic->addDescriptor(new BLE2902());
-
-  pRxCharacteristic = pService->createCharacteristic(
-      CHARACTERISTIC_UUID_RX,
-      BLECharacteristic::PROPERTY_WRITE | BLECharacteristic::PROPERTY_READ);
-  pRxCharacteristic->setCallbacks(new MyCallbacks());
+  // Service and characteristics come from the static table in gatt_table.h
+  uint32_t table_start = micros();
+  BLEService *pService = Gatt::create_service(pServer);
+  pTxCharacteristic = &Gatt::tx_characteristic;
+  ble_sessions.begin(pServer, pTxCharacteristic);
 
   // Start the service
   pService->start();
-  Serial.println("✅ BLE service started");
+  Serial.printf("✅ BLE service started (%u us)\n", micros() - table_start);
 
-  // Negotiate larger MTU for bigger payloads
-  BLEDevice::setMTU(256); // Request 256 byte MTU (most devices support this)
-  Serial.println("📡 BLE MTU set to 256 bytes for larger payloads");
-  Serial.printf("Service UUID: %s\n", SERVICE_UUID);
-  Serial.printf("TX Characteristic: %s\n", CHARACTERISTIC_UUID_TX);
-  Serial.printf("RX Characteristic: %s\n", CHARACTERISTIC_UUID_RX);
+  // Negotiate larger MTU for bigger payloads (tracked per central)
+  BLEDevice::setMTU(Constants::Bluetooth::PREFERRED_MTU);
+  Serial.printf("📡 BLE MTU set to %d bytes for larger payloads\n",
+                Constants::Bluetooth::PREFERRED_MTU);
+  Gatt::print_table();
 
   // Start advertising
   BLEAdvertising *pAdvertising = BLEDevice::getAdvertising();
-  pAdvertising->addServiceUUID(SERVICE_UUID);
+  pAdvertising->addServiceUUID(Gatt::ble_uuid(Gatt::SERVICE));
   pAdvertising->setScanResponse(false);
   pAdvertising->setMinPreferred(
       0x0); // Set value to 0x00 to not advertise this parameter
 
   Serial.println("Starting BLE advertising...");
-  Serial.printf("Device Name: %s\n", device_name.c_str());
+  Serial.printf("Device Name: %s\n", device_settings.device_name);
 
   BLEDevice::startAdvertising();
   Serial.println("✅ BLE advertising started");
 
   Serial.printf("✅ BLE device \"%s\" is now advertising!\n",
-                device_name.c_str());
+                device_settings.device_name);
   Serial.println("📡 Broadcasting service UUID for discovery...");
   Serial.println("⏳ Waiting for phone to connect...");
 }
 
-void send_ble_message(const String &type, const String &message,
-                      const String &action) {
-  if (deviceConnected && pTxCharacteristic != nullptr) {
-    JsonDocument doc;
-    doc["type"] = type;
-    doc["message"] = message;
-    doc["action"] = action;
-
-    String json_string;
-    serializeJson(doc, json_string);
-
-    Serial.printf("📤 Original message: %s (%d bytes)\n", json_string.c_str(),
-                  json_string.length());
-
-    // MTU-aware message sizing (negotiated with client)
-    const size_t MAX_NOTIFICATION_SIZE =
-        200; // Conservative limit for reliability
-
-    if (json_string.length() <= MAX_NOTIFICATION_SIZE) {
-      // Send as notification
-      Serial.printf("📡 Sending as notification: %s\n", json_string.c_str());
-      pTxCharacteristic->setValue(json_string.c_str());
-      pTxCharacteristic->notify();
-      Serial.println("✅ BLE notification sent");
-    } else {
-      // For very large messages, log warning
-      Serial.printf("⚠️ Message too large for notification (%d > %d bytes)\n",
-                    json_string.length(), MAX_NOTIFICATION_SIZE);
-      Serial.println("💡 Message truncated to fit MTU");
-      // Truncate and send
-      String truncated = json_string.substring(0, MAX_NOTIFICATION_SIZE);
-      Serial.printf("📡 Sending truncated: %s\n", truncated.c_str());
-      pTxCharacteristic->setValue(truncated.c_str());
-      pTxCharacteristic->notify();
+void handle_session_event(const SessionEvent &event) {
+  if (event.type == SessionEventType::Delivered ||
+      event.type == SessionEventType::Undelivered) {
+    // Outbox batches are the only tracked indications
+    if (event.peer == outbox_peer) {
+      if (event.type == SessionEventType::Delivered) {
+        Serial.printf("📬 Peer %d confirmed the outbox batch\n", event.peer);
+        outbox.batch_delivered();
+      } else {
+        outbox.batch_failed();
+      }
+      outbox_peer = BLE_BROADCAST;
     }
+    return;
+  }
+
+  if (event.type == SessionEventType::Connected) {
+    Serial.printf("BLE: peer %d session opened\n", event.peer);
+    add_message_to_queue("📱 Phone connected!");
+    // Sent by greet_ready_peers() once the MTU exchange is done
+    greeting_due |= 1 << event.peer;
   } else {
+    Serial.printf("BLE: peer %d session closed\n", event.peer);
+    greeting_due &= ~(1 << event.peer);
+    if (outbox_peer == event.peer) {
+      // Never confirmed: the items go out again to the next peer
+      outbox.batch_failed();
+      outbox_peer = BLE_BROADCAST;
+    }
+    if (screen_mirror.peer() == event.peer) {
+      screen_mirror.stop();
+    }
+    add_message_to_queue("📱 Phone disconnected");
+  }
+  ui_state.set(UiField::Peers, ble_sessions.connected_count());
+}
+
+// Serial.printf allocates for lines over 64 bytes; this formats on the
+// stack instead and is used on the per-message paths
+void log_line(const char *fmt, ...) {
+  FixedString<Constants::Bluetooth::RX_BUFFER_SIZE + 64> line;
+  va_list args;
+  va_start(args, fmt);
+  line.append_vformat(fmt, args);
+  va_end(args);
+  Serial.println(line.c_str());
+}
+
+// Counts every task's allocations, so an upper bound for this message
+void note_message_allocations(uint32_t before) {
+  handled_messages++;
+  message_allocations += allocation_count() - before;
+}
+
+void handle_incoming_message(int8_t peer, const char *json) {
+  uint32_t allocations_before = allocation_count();
+  log_line("BLE Received (peer %d): %s", peer, json);
+
+  // Decoded straight into the generated structs, no key lookups later on
+  Protocol::Message msg;
+  if (!Protocol::decode_json(json, strlen(json), msg)) {
+    Serial.println("JSON parsing failed");
+    return;
+  }
+  dispatch_message(peer, msg, json);
+  note_message_allocations(allocations_before);
+}
+
+void handle_binary_message(int8_t peer, const uint8_t *data, size_t length) {
+  uint32_t allocations_before = allocation_count();
+  Protocol::Message msg;
+  if (!Protocol::decode_binary(data, length, msg)) {
+    Serial.printf("⚠️ Invalid binary message from peer %d\n", peer);
+    return;
+  }
+  log_line("Binary Received (peer %d): %s", peer,
+           Protocol::type_name(msg.type));
+  dispatch_message(peer, msg, nullptr);
+  note_message_allocations(allocations_before);
+}
+
+// json is the original text for messages with nested members (commands,
+// unknown types); binary messages never carry those
+void dispatch_message(int8_t peer, const Protocol::Message &msg,
+                      const char *json) {
+  using Protocol::MessageType;
+
+  if (msg.has_seq) {
+    ble_sessions.note_rx_seq(peer, msg.seq);
+  }
+
+  // Replies go back to the central that asked
+  switch (msg.type) {
+  case MessageType::AiRequest: {
+    char reply[sizeof(msg.body.text.message)];
+    snprintf(reply, sizeof(reply), "AI Response to: %s",
+             msg.body.text.message);
+    add_message_to_queue("🤖 Processing: ", msg.body.text.message);
+    send_text_message(MessageType::AiResponse, reply, "processed", peer);
+    display_next_message();
+    break;
+  }
+  case MessageType::Test:
+    add_message_to_queue("📱 ", msg.body.text.message);
+    send_text_message(MessageType::TestResponse, "Hello from ESP32!", "ack",
+                      peer);
+    display_next_message();
+    break;
+  case MessageType::Hello:
+    add_message_to_queue("📱 ", msg.body.text.message);
+    send_text_message(MessageType::Welcome,
+                      "Hello from ESP32! Ready to chat.", "ready", peer);
+    display_next_message();
+    break;
+  case MessageType::AiResponse: {
+    // Fresh answer to a device-originated request: refresh the cache and
+    // only touch the display if the cached answer was missing or outdated
+    const Protocol::AiResponse &response = msg.body.ai_response;
+    uint32_t now = millis();
+    uint32_t key = ResponseCache::hash_request(response.request);
+    bool changed =
+        response_cache.store(key, response.message, response.ttl_ms, now);
+    bool was_hit = response_cache.complete_request(key, now);
+    if (!was_hit) {
+      add_message_to_queue("🤖 ", response.message);
+      display_next_message();
+    } else if (changed) {
+      add_message_to_queue("🔄 ", response.message);
+      display_next_message();
+    }
+    break;
+  }
+  case MessageType::Notification: {
+    // Coalesced and rate limited; shown from loop()
+    const Protocol::Notification &note = msg.body.notification;
+    notification_center.post(
+        note.app, note.title, note.message,
+        NotificationCenter::parse_priority(
+            note.priority[0] != '\0' ? note.priority : "normal"),
+        millis());
+    break;
+  }
+  case MessageType::BulkStart: {
+    // Large transfers move to the soft-AP; BLE stays the control channel
+    Protocol::Message response{};
+    if (wifi_bulk.start(read_message_history)) {
+      Protocol::BulkReady &ready = response.body.bulk_ready;
+      response.type = MessageType::BulkReady;
+      snprintf(ready.ssid, sizeof(ready.ssid), "%s",
+               Constants::WiFi::AP_SSID);
+      snprintf(ready.password, sizeof(ready.password), "%s",
+               Constants::WiFi::AP_PASSWORD);
+      IPAddress ip = wifi_bulk.ip();
+      snprintf(ready.ip, sizeof(ready.ip), "%u.%u.%u.%u", ip[0], ip[1], ip[2],
+               ip[3]);
+      ready.port = Constants::WiFi::BULK_PORT;
+      snprintf(ready.token, sizeof(ready.token), "%s", wifi_bulk.token());
+      add_message_to_queue("📶 Wi-Fi transfer mode");
+      display_next_message();
+    } else {
+      response.type = MessageType::BulkDone;
+      response.body.status.ok = false;
+    }
+    send_message(response, peer);
+    break;
+  }
+  case MessageType::Metrics: {
+    Protocol::Message response{};
+    response.type = MessageType::Metrics;
+    fill_metrics(response.body.metrics);
+    send_message(response, peer);
+    break;
+  }
+  case MessageType::Bench: {
+    // Results are a dynamic object, so this reply stays on ArduinoJson
+    JsonDocument response;
+    response[Constants::JSON::KEY_TYPE] =
+        Protocol::type_name(MessageType::BenchResult);
+    response[Constants::JSON::KEY_OK] =
+        run_bench(msg.body.bench.name[0] != '\0' ? msg.body.bench.name : "all",
+                  response[Constants::JSON::KEY_RESULTS].to<JsonObject>());
+    send_ble_json(response, peer);
+    break;
+  }
+  case MessageType::AssetBegin: {
+    if (peer != USB_PEER) {
+      break;
+    }
+    // Raw chunks follow as AssetData frames on the USB link
+    const Protocol::AssetBegin &asset = msg.body.asset_begin;
+    Protocol::Message response{};
+    response.type = MessageType::AssetAck;
+    response.body.status.ok = usb_link.begin_asset(
+        strcmp(asset.target, "ota") == 0 ? BulkTarget::Firmware
+                                         : BulkTarget::File,
+        asset.name[0] != '\0' ? asset.name : "asset.bin", asset.size);
+    send_message(response, peer);
+    break;
+  }
+  case MessageType::AssetEnd: {
+    if (peer != USB_PEER) {
+      break;
+    }
+    Protocol::Message response{};
+    response.type = MessageType::AssetDone;
+    response.body.status.ok = usb_link.end_asset();
+    response.body.status.bytes = usb_link.asset_received();
+    send_message(response, peer);
+    if (usb_link.restart_pending()) {
+      Serial.println("⬆️ Firmware updated over USB, restarting...");
+      Serial.flush();
+      ESP.restart();
+    }
+    break;
+  }
+  case MessageType::Mirror: {
+    // fps 0 stops the stream; the reply's geometry lets the phone decode
+    // tiles, and fps 0 in it means no stream
+    const Protocol::MirrorConfig &config = msg.body.mirror_config;
+    Protocol::Message response{};
+    response.type = MessageType::MirrorInfo;
+    if (config.fps > 0 && peer >= 0 &&
+        screen_mirror.start(peer, config.fps,
+                            config.share > 0
+                                ? config.share
+                                : Constants::Mirror::DEFAULT_SHARE_PERCENT)) {
+      Protocol::MirrorInfo &info = response.body.mirror_info;
+      info.width = screen_mirror.width();
+      info.height = screen_mirror.height();
+      info.tile = Constants::Mirror::TILE_SIZE;
+      info.fps = screen_mirror.fps();
+      info.share = screen_mirror.share();
+    } else if (screen_mirror.peer() == peer) {
+      screen_mirror.stop();
+    }
+    send_message(response, peer);
+    break;
+  }
+  case MessageType::Command: {
+    // Nested ops are read with ArduinoJson by the command channel
+    JsonDocument doc;
+    if (json == nullptr || deserializeJson(doc, json)) {
+      break;
+    }
+    JsonDocument response;
+    DeviceSettings previous = device_settings;
+    if (run_command_batch(doc.as<JsonObjectConst>(), response)) {
+      apply_settings(previous);
+    }
+    send_ble_json(response, peer);
+    break;
+  }
+  case MessageType::Unknown: {
+    // Types this firmware predates still show their text, if any
+    JsonDocument doc;
+    if (json != nullptr && !deserializeJson(doc, json)) {
+      add_message_to_queue("📱 ", doc[Constants::JSON::KEY_MESSAGE] | "");
+      display_next_message();
+    }
+    break;
+  }
+  case MessageType::Btn:
+  case MessageType::Connected:
+  case MessageType::Welcome:
+  case MessageType::TestResponse:
+    add_message_to_queue("📱 ", msg.body.text.message);
+    display_next_message();
+    break;
+  default:
+    // Device-to-phone replies have no meaning in this direction
+    Serial.printf("Ignoring \"%s\" from peer %d\n",
+                  Protocol::type_name(msg.type), peer);
+    break;
+  }
+}
+
+// Reports the end of a Wi-Fi session over BLE; reboots into new firmware
+void finish_bulk_transfer() {
+  Protocol::Message done{};
+  done.type = Protocol::MessageType::BulkDone;
+  done.body.status.ok = true;
+  done.body.status.bytes = wifi_bulk.bytes_transferred();
+  send_message(done);
+
+  if (wifi_bulk.restart_pending()) {
+    add_message_to_queue("⬆️ Firmware updated, restarting...");
+    display_next_message();
+    lv_timer_handler();
+    // bulk_done is an indication: wait for the phone's confirm
+    uint32_t start = millis();
+    while (!ble_sessions.tx_idle() &&
+           millis() - start < Constants::Bluetooth::TX_DRAIN_WAIT_MS) {
+      ble_sessions.service_tx();
+      delay(10);
+    }
+    ESP.restart();
+  }
+  add_message_to_queue("📶 Transfer finished, Wi-Fi off");
+  display_next_message();
+}
+
+// Runtime counters for the USB host CLI ("metrics" message)
+void fill_metrics(Protocol::Metrics &metrics) {
+  metrics.uptime_ms = millis();
+  metrics.free_heap = ESP.getFreeHeap();
+  metrics.min_free_heap = ESP.getMinFreeHeap();
+  metrics.free_psram = ESP.getFreePsram();
+  metrics.ble_peers = ble_sessions.connected_count();
+  metrics.outbox = outbox.size();
+
+  metrics.cache_hit_rate = response_cache.stats().hit_rate_percent();
+  const NotificationStats &notes = notification_center.stats();
+  metrics.notifications = notes.received;
+  metrics.notifications_dropped = notes.dropped;
+  const FrameStats &usb = usb_link.stats();
+  metrics.usb_frames = usb.frames;
+  metrics.usb_crc_errors = usb.crc_errors;
+  metrics.stalls = stall_monitor.stalls();
+  metrics.slo_misses = stall_monitor.slo_misses();
+  metrics.loop_p99_us = stall_monitor.p99_us(loop_lane);
+  LvglHeapStats lvgl = lvgl_heap.stats();
+  metrics.lvgl_internal = lvgl.internal.bytes;
+  metrics.lvgl_psram = lvgl.psram.bytes;
+  metrics.lvgl_internal_frag = lvgl_heap.internal_frag_pct();
+  metrics.lvgl_psram_frag = lvgl_heap.psram_frag_pct();
+}
+
+// History export for the bulk endpoint: the message queue, one per line.
+// Called from the bulk task; loop() changes the queue only under the LVGL
+// lock, which it holds for a whole pass.
+size_t read_message_history(size_t offset, uint8_t *out, size_t capacity) {
+  lv_lock();
+  size_t written = 0;
+  size_t position = 0;
+  for (int i = 0; i < message_count && written < capacity; i++) {
+    std::string_view line = message_queue[i].view();
+    size_t line_length = line.size() + 1; // Plus the newline
+    size_t start = offset > position ? offset - position : 0;
+    for (size_t j = start; j < line_length && written < capacity; j++) {
+      out[written++] = j < line.size() ? line[j] : '\n';
+    }
+    position += line_length;
+  }
+  lv_unlock();
+  return written;
+}
+
+// Sends a device-originated request to the phone. A cached answer is shown
+// immediately; the phone's fresh answer reconciles it when it arrives.
+// Only one phone is asked: every central answers a broadcast, and the
+// later answers would find no pending request and show up as new ones.
+void send_ai_request(const char *request, const char *action) {
+  uint32_t now = millis();
+  uint32_t key = ResponseCache::hash_request(request);
+  const char *cached = response_cache.lookup(key, now);
+  if (cached != nullptr) {
+    add_message_to_queue("⚡ ", cached);
+  }
+  response_cache.begin_request(key, cached != nullptr, now);
+  int8_t target = first_peer(now, true);
+  if (target == BLE_BROADCAST) {
+    target = first_peer(now, false);
+  }
+  queue_user_action(Protocol::MessageType::Btn, request, action, target);
+}
+
+// Sends a user action right away, or persists it until a phone reconnects
+void queue_user_action(Protocol::MessageType type, const char *message,
+                       const char *action, int8_t peer) {
+  if (ble_sessions.is_connected()) {
+    send_text_message(type, message, action, peer);
+    return;
+  }
+
+  outbox.add(Protocol::type_name(type), message, action);
+  add_message_to_queue("📥 Saved - will send when phone reconnects");
+  Serial.printf("📥 Outbox: %d queued actions\n", outbox.size());
+}
+
+// The "connected" message does not fit a default-MTU frame, so each new
+// peer gets it once it is ready (BleSession::ready)
+void greet_ready_peers() {
+  uint32_t now = millis();
+  for (int8_t i = 0; i < Constants::Bluetooth::MAX_CENTRALS; i++) {
+    BleSession *session = ble_sessions.session(i);
+    if ((greeting_due & (1 << i)) == 0 ||
+        (session != nullptr && !session->ready(now))) {
+      continue;
+    }
+    greeting_due &= ~(1 << i);
+    if (session != nullptr) {
+      send_text_message(Protocol::MessageType::Connected,
+                        "ESP32 ready for communication", "ready", i);
+    }
+  }
+}
+
+// First connected peer (past its MTU exchange if ready_only), or
+// BLE_BROADCAST when there is none
+int8_t first_peer(uint32_t now, bool ready_only) {
+  for (int8_t i = 0; i < Constants::Bluetooth::MAX_CENTRALS; i++) {
+    BleSession *session = ble_sessions.session(i);
+    if (session != nullptr && (!ready_only || session->ready(now))) {
+      return i;
+    }
+  }
+  return BLE_BROADCAST;
+}
+
+// Flushes the outbox as batch frames sized to the first ready peer's MTU,
+// one unconfirmed batch at a time
+void flush_outbox() {
+  if (outbox.empty() || outbox.batch_pending()) {
+    return;
+  }
+
+  int8_t target = first_peer(millis(), true);
+  if (target == BLE_BROADCAST) {
+    return;
+  }
+
+  // One batch per pass so the TX queue keeps room for live traffic
+  JsonDocument batch;
+  int packed =
+      outbox.fill_batch(batch, ble_sessions.session(target)->max_message());
+  if (packed == 0) {
+    // A single item larger than the MTU would block the queue forever
+    Serial.println("⚠️ Outbox item too large for peer MTU, dropped");
+    outbox.drop_front(1);
+    return;
+  }
+
+  if (send_ble_json(batch, target, true)) {
+    Serial.printf("📬 Sent %d outbox items to peer %d\n", packed, target);
+    outbox.batch_sent(packed);
+    outbox_peer = target;
+  }
+}
+
+void send_text_message(Protocol::MessageType type, const char *message,
+                       const char *action, int8_t peer) {
+  Protocol::Message msg{};
+  msg.type = type;
+  snprintf(msg.body.text.message, sizeof(msg.body.text.message), "%s",
+           message);
+  snprintf(msg.body.text.action, sizeof(msg.body.text.action), "%s", action);
+  send_message(msg, peer);
+}
+
+// Serializes once per recipient so each frame carries that peer's sequence
+// number. serialize(seq, out, capacity) returns the length, 0 if too large.
+// BLE frames travel on the message type's virtual channel, as indications
+// when the schema asks for confirmed delivery.
+// Returns true when the frame was queued for at least one peer. Tracked
+// BLE frames report their delivery as session events.
+template <typename Serialize>
+bool deliver(int8_t peer, Protocol::MessageType type, Serialize serialize,
+             bool track = false) {
+  Channel channel = Protocol::channel_of(type);
+  bool indicate = Protocol::indicated(type);
+  // The USB host speaks the same protocol and also sees broadcasts
+  bool queued = false;
+  if (peer == USB_PEER ||
+      (peer == BLE_BROADCAST && usb_link.host_attached())) {
+    static char usb_body[Constants::Usb::MAX_PAYLOAD];
+    size_t length =
+        serialize(usb_link.next_seq(), usb_body, sizeof(usb_body));
+    queued = length > 0 &&
+             usb_link.send_payload(FrameKind::Json,
+                                   reinterpret_cast<uint8_t *>(usb_body),
+                                   length);
+    if (peer == USB_PEER) {
+      return queued;
+    }
+  }
+
+  if (!ble_sessions.is_connected() || pTxCharacteristic == nullptr) {
     Serial.println("⚠️ Cannot send BLE message - not connected or "
                    "characteristic unavailable");
+    return queued;
   }
+
+  char frame[Constants::Bluetooth::MAX_FRAME_SIZE + 1];
+  for (int8_t i = 0; i < Constants::Bluetooth::MAX_CENTRALS; i++) {
+    if (peer != BLE_BROADCAST && peer != i) {
+      continue;
+    }
+    BleSession *session = ble_sessions.session(i);
+    if (session == nullptr) {
+      continue;
+    }
+
+    size_t length = serialize(session->tx_seq++, frame, sizeof(frame));
+    if (length == 0) {
+      Serial.printf("⚠️ Message too large for peer %d, dropped\n", i);
+      continue;
+    }
+    if (ble_sessions.enqueue(i, channel, frame, length, indicate, track)) {
+      log_line("📤 Queued for peer %d: %s (%d bytes)", i, frame, length);
+      queued = true;
+    } else if (length > session->max_message()) {
+      // Never truncated: the peer's MTU (negotiated per client) is too small
+      Serial.printf("⚠️ Message larger than peer %d MTU (%d > %d bytes), "
+                    "dropped\n",
+                    i, length, session->max_message());
+    } else {
+      Serial.printf("⚠️ TX queue full for peer %d, message dropped\n", i);
+    }
+  }
+  return queued;
+}
+
+// Fixed-shape messages: encoded from the generated structs, no allocation
+bool send_message(Protocol::Message &message, int8_t peer) {
+  Protocol::MessageType type = message.type;
+  return deliver(peer, type, [&](uint32_t seq, char *out, size_t capacity) {
+    message.has_seq = true;
+    message.seq = seq;
+    return Protocol::encode_json(message, out, capacity);
+  });
+}
+
+// Dynamic messages (command responses, batches, bench results)
+bool send_ble_json(JsonDocument &doc, int8_t peer, bool track) {
+  const char *name = doc[Constants::JSON::KEY_TYPE] | "";
+  Protocol::MessageType type = Protocol::find_type(name, strlen(name));
+  return deliver(
+      peer, type,
+      [&](uint32_t seq, char *out, size_t capacity) {
+        doc["seq"] = seq;
+        if (measureJson(doc) >= capacity) {
+          return size_t(0);
+        }
+        return serializeJson(doc, out, capacity);
+      },
+      track);
+}
+
+// Pushes changed settings out to the hardware after a command batch
+void apply_settings(const DeviceSettings &previous) {
+  // The brightness observer drives the panel
+  ui_state.set(UiField::Brightness, device_settings.brightness);
+
+  if (strcmp(device_settings.device_name, previous.device_name) != 0) {
+    // Advertising data carries the name, so restart it with the new one
+    esp_ble_gap_set_device_name(device_settings.device_name);
+    BLEDevice::stopAdvertising();
+    BLEDevice::startAdvertising();
+    Serial.printf("📡 Device name changed to \"%s\"\n",
+                  device_settings.device_name);
+  }
+
+  // Intervals are read from device_settings on every loop() pass
 }
@@ -0,0 +1,162 @@
+/**
+ * Phone notification mirroring - see notification_center.h
+ */
+
+#include "notification_center.h"
+
+#include <stdio.h>
+#include <string.h>
+
+NotificationCenter notification_center;
+
+namespace {
+const uint32_t TOKEN = 1000; // Bucket is kept in milli-tokens
+const uint32_t BUCKET_MAX = Constants::Notifications::BUCKET_CAPACITY * TOKEN;
+} // namespace
+
+NotificationPriority NotificationCenter::parse_priority(const char *name) {
+  if (name != nullptr && strcmp(name, "high") == 0) {
+    return NotificationPriority::High;
+  }
+  if (name != nullptr && strcmp(name, "low") == 0) {
+    return NotificationPriority::Low;
+  }
+  return NotificationPriority::Normal;
+}
+
+void NotificationCenter::refill(uint32_t now_ms) {
+  uint32_t elapsed = now_ms - last_refill_ms;
+  uint32_t earned =
+      elapsed * TOKEN / Constants::Notifications::REFILL_INTERVAL_MS;
+  if (earned > 0) {
+    milli_tokens = milli_tokens + earned > BUCKET_MAX ? BUCKET_MAX
+                                                      : milli_tokens + earned;
+    // Only the time actually paid out; the rounding remainder carries
+    // over, or short loop passes would refill the bucket slowly
+    last_refill_ms +=
+        earned * Constants::Notifications::REFILL_INTERVAL_MS / TOKEN;
+  }
+}
+
+int NotificationCenter::find_slot(const char *app) const {
+  for (int i = 0; i < Constants::Notifications::MAX_APPS; i++) {
+    if (slots[i].used && strcmp(slots[i].app, app) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+// Returns a free slot, evicting the lowest priority / oldest one when full
+int NotificationCenter::claim_slot(uint32_t now_ms) {
+  int victim = 0;
+  for (int i = 0; i < Constants::Notifications::MAX_APPS; i++) {
+    if (!slots[i].used) {
+      return i;
+    }
+    const AppSlot &s = slots[i];
+    const AppSlot &v = slots[victim];
+    if (s.priority < v.priority ||
+        (s.priority == v.priority &&
+         now_ms - s.first_pending_ms > now_ms - v.first_pending_ms)) {
+      victim = i;
+    }
+  }
+  counters.dropped += slots[victim].count;
+  slots[victim].used = false;
+  return victim;
+}
+
+void NotificationCenter::post(const char *app, const char *title,
+                              const char *text, NotificationPriority priority,
+                              uint32_t now_ms) {
+  counters.received++;
+  if (app == nullptr || app[0] == '\0') {
+    app = "Phone";
+  }
+
+  int index = find_slot(app);
+  if (index >= 0) {
+    counters.coalesced++;
+  } else {
+    index = claim_slot(now_ms);
+    AppSlot &fresh = slots[index];
+    memset(&fresh, 0, sizeof(fresh));
+    fresh.used = true;
+    fresh.priority = priority;
+    fresh.first_pending_ms = now_ms;
+    snprintf(fresh.app, sizeof(fresh.app), "%s", app);
+  }
+
+  AppSlot &slot = slots[index];
+  slot.count++;
+  if (priority > slot.priority) {
+    slot.priority = priority;
+  }
+  if (title != nullptr && title[0] != '\0') {
+    snprintf(slot.latest, sizeof(slot.latest), "%s: %s", title,
+             text != nullptr ? text : "");
+  } else {
+    snprintf(slot.latest, sizeof(slot.latest), "%s",
+             text != nullptr ? text : "");
+  }
+}
+
+bool NotificationCenter::next_display(char *out, size_t capacity,
+                                      uint32_t now_ms) {
+  refill(now_ms);
+
+  // Pick the most urgent pending app, oldest first; expire stale low ones
+  int best = -1;
+  for (int i = 0; i < Constants::Notifications::MAX_APPS; i++) {
+    AppSlot &s = slots[i];
+    if (!s.used) {
+      continue;
+    }
+    if (s.priority == NotificationPriority::Low &&
+        now_ms - s.first_pending_ms >
+            Constants::Notifications::LOW_PRIORITY_TTL_MS) {
+      counters.dropped += s.count;
+      s.used = false;
+      continue;
+    }
+    if (best < 0 || s.priority > slots[best].priority ||
+        (s.priority == slots[best].priority &&
+         s.first_pending_ms < slots[best].first_pending_ms)) {
+      best = i;
+    }
+  }
+  if (best < 0) {
+    return false;
+  }
+
+  AppSlot &slot = slots[best];
+  bool urgent = slot.priority == NotificationPriority::High;
+  if (milli_tokens < TOKEN && !urgent) {
+    return false; // Rate limited - keep coalescing until a token frees up
+  }
+  milli_tokens = milli_tokens >= TOKEN ? milli_tokens - TOKEN : 0;
+
+  if (slot.count == 1) {
+    snprintf(out, capacity, "🔔 %s\n%s", slot.app, slot.latest);
+  } else {
+    snprintf(out, capacity, "🔔 %u new messages from %s\n%s",
+             static_cast<unsigned>(slot.count), slot.app, slot.latest);
+  }
+
+  uint32_t waited = now_ms - slot.first_pending_ms;
+  if (waited > counters.max_pending_ms) {
+    counters.max_pending_ms = waited;
+  }
+  counters.displayed++;
+  slot.used = false;
+  return true;
+}
+
+int NotificationCenter::pending_apps() const {
+  int pending = 0;
+  for (const auto &s : slots) {
+    pending += s.used ? 1 : 0;
+  }
+  return pending;
+}
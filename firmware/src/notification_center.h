@@ -0,0 +1,66 @@
+/**
+ * Phone notification mirroring with per-app coalescing and rate limiting
+ *
+ * Notifications are folded into one slot per app ("5 new messages from X")
+ * and released to the display through a token bucket, so a storm of dozens
+ * of notifications costs a handful of label updates instead of one each.
+ * High priority notifications bypass the bucket; stale low priority ones are
+ * dropped. Time is passed in explicitly so the logic has no Arduino
+ * dependency and can be driven from a host-side harness.
+ */
+
+#ifndef NOTIFICATION_CENTER_H
+#define NOTIFICATION_CENTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "constants.h"
+
+enum class NotificationPriority : uint8_t { Low, Normal, High };
+
+struct NotificationStats {
+  uint32_t received;
+  uint32_t coalesced; // Folded into an already pending slot
+  uint32_t displayed; // Lines handed to the display
+  uint32_t dropped;   // Evicted or expired before display
+  uint32_t max_pending_ms;
+};
+
+class NotificationCenter {
+public:
+  void post(const char *app, const char *title, const char *text,
+            NotificationPriority priority, uint32_t now_ms);
+
+  // Produces at most one coalesced display line when the rate limit allows
+  bool next_display(char *out, size_t capacity, uint32_t now_ms);
+
+  int pending_apps() const;
+  const NotificationStats &stats() const { return counters; }
+
+  static NotificationPriority parse_priority(const char *name);
+
+private:
+  struct AppSlot {
+    bool used;
+    char app[Constants::Notifications::MAX_APP_NAME_LENGTH + 1];
+    char latest[Constants::Notifications::MAX_TEXT_LENGTH + 1];
+    uint16_t count;
+    NotificationPriority priority; // Highest pending priority
+    uint32_t first_pending_ms;
+  };
+
+  void refill(uint32_t now_ms);
+  int find_slot(const char *app) const;
+  int claim_slot(uint32_t now_ms);
+
+  AppSlot slots[Constants::Notifications::MAX_APPS] = {};
+  uint32_t milli_tokens =
+      Constants::Notifications::BUCKET_CAPACITY * 1000; // Starts full
+  uint32_t last_refill_ms = 0;
+  NotificationStats counters = {};
+};
+
+extern NotificationCenter notification_center;
+
+#endif // NOTIFICATION_CENTER_H
@@ -0,0 +1,125 @@
+/**
+ * Persistent offline outbox - see outbox.h
+ */
+
+#include "outbox.h"
+
+#include <SPIFFS.h>
+
+#include "protocol.h"
+
+Outbox outbox;
+
+namespace {
+const uint8_t FILE_VERSION = 1;
+}
+
+void Outbox::begin() {
+  File file = SPIFFS.open(Constants::Outbox::FILE_PATH, FILE_READ);
+  if (!file) {
+    return;
+  }
+
+  uint8_t header[2] = {};
+  if (file.read(header, sizeof(header)) == sizeof(header) &&
+      header[0] == FILE_VERSION && header[1] <= Constants::Outbox::MAX_ITEMS) {
+    size_t bytes = header[1] * sizeof(OutboxItem);
+    if (file.read(reinterpret_cast<uint8_t *>(items), bytes) == bytes) {
+      item_count = header[1];
+    }
+  }
+  file.close();
+
+  if (item_count > 0) {
+    Serial.printf("📥 Outbox restored %d queued actions\n", item_count);
+  }
+}
+
+void Outbox::save() {
+  File file = SPIFFS.open(Constants::Outbox::FILE_PATH, FILE_WRITE);
+  if (!file) {
+    Serial.println("⚠️ Outbox could not be persisted");
+    return;
+  }
+  uint8_t header[2] = {FILE_VERSION, item_count};
+  file.write(header, sizeof(header));
+  file.write(reinterpret_cast<const uint8_t *>(items),
+             item_count * sizeof(OutboxItem));
+  file.close();
+}
+
+void Outbox::add(const char *type, const char *message, const char *action) {
+  // Repeated presses of the same action collapse into one counted item,
+  // unless that item is already on its way
+  for (int i = in_flight; i < item_count; i++) {
+    OutboxItem &item = items[i];
+    if (strncmp(item.type, type, sizeof(item.type) - 1) == 0 &&
+        strncmp(item.message, message, sizeof(item.message) - 1) == 0 &&
+        strncmp(item.action, action, sizeof(item.action) - 1) == 0) {
+      item.count++;
+      save();
+      return;
+    }
+  }
+
+  if (item_count == Constants::Outbox::MAX_ITEMS) {
+    // Full - the oldest action not yet sent is the least relevant one
+    if (in_flight == item_count) {
+      overflow_drops++;
+      return;
+    }
+    overflow_drops += items[in_flight].count;
+    memmove(items + in_flight, items + in_flight + 1,
+            (item_count - in_flight - 1) * sizeof(OutboxItem));
+    item_count--;
+  }
+
+  OutboxItem &item = items[item_count++];
+  memset(&item, 0, sizeof(item));
+  snprintf(item.type, sizeof(item.type), "%s", type);
+  snprintf(item.message, sizeof(item.message), "%s", message);
+  snprintf(item.action, sizeof(item.action), "%s", action);
+  item.count = 1;
+  save();
+}
+
+int Outbox::fill_batch(JsonDocument &doc, size_t max_bytes) const {
+  doc.clear();
+  doc[Constants::JSON::KEY_TYPE] =
+      Protocol::type_name(Protocol::MessageType::Batch);
+  JsonArray list = doc[Constants::JSON::KEY_ITEMS].to<JsonArray>();
+
+  int packed = 0;
+  for (int i = 0; i < item_count; i++) {
+    JsonObject entry = list.add<JsonObject>();
+    entry[Constants::JSON::KEY_TYPE] = items[i].type;
+    entry[Constants::JSON::KEY_MESSAGE] = items[i].message;
+    entry[Constants::JSON::KEY_ACTION] = items[i].action;
+    if (items[i].count > 1) {
+      entry[Constants::JSON::KEY_COUNT] = items[i].count;
+    }
+
+    if (measureJson(doc) + Constants::Outbox::SEQ_RESERVE > max_bytes) {
+      list.remove(list.size() - 1);
+      break;
+    }
+    packed++;
+  }
+  return packed;
+}
+
+void Outbox::batch_delivered() {
+  int count = in_flight;
+  in_flight = 0;
+  drop_front(count);
+}
+
+void Outbox::drop_front(int count) {
+  if (count >= item_count) {
+    item_count = 0;
+  } else {
+    memmove(items, items + count, (item_count - count) * sizeof(OutboxItem));
+    item_count -= count;
+  }
+  save();
+}
@@ -0,0 +1,59 @@
+/**
+ * Persistent offline outbox for user actions
+ *
+ * Button presses and requests made while no phone is connected are kept in
+ * SPIFFS so they survive a reboot. Repeats of the same action are folded
+ * into one item with a count, and on reconnect the queue is flushed as
+ * "batch" frames packed up to the peer's MTU - a burst of offline actions
+ * arrives as one indication instead of one per action. The items of a
+ * batch stay queued (and persisted) until the phone confirms it, so a
+ * disconnect in between only means they are sent again.
+ */
+
+#ifndef OUTBOX_H
+#define OUTBOX_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#include "constants.h"
+
+struct OutboxItem {
+  char type[Constants::Outbox::MAX_TYPE_LENGTH + 1];
+  char message[Constants::Outbox::MAX_MESSAGE_LENGTH + 1];
+  char action[Constants::Outbox::MAX_ACTION_LENGTH + 1];
+  uint16_t count;
+};
+
+class Outbox {
+public:
+  void begin();
+  void add(const char *type, const char *message, const char *action);
+
+  // Packs as many queued items as fit into one batch document
+  int fill_batch(JsonDocument &doc, size_t max_bytes) const;
+  void drop_front(int count);
+
+  // The first count items are on their way; delivered drops them, failed
+  // puts them back in line
+  void batch_sent(int count) { in_flight = count; }
+  void batch_delivered();
+  void batch_failed() { in_flight = 0; }
+  bool batch_pending() const { return in_flight > 0; }
+
+  bool empty() const { return item_count == 0; }
+  int size() const { return item_count; }
+  uint32_t dropped() const { return overflow_drops; }
+
+private:
+  void save();
+
+  OutboxItem items[Constants::Outbox::MAX_ITEMS] = {};
+  uint8_t item_count = 0;
+  uint8_t in_flight = 0; // Leading items of the unconfirmed batch
+  uint32_t overflow_drops = 0;
+};
+
+extern Outbox outbox;
+
+#endif // OUTBOX_H
@@ -0,0 +1,560 @@
+/**
+ * Protocol codecs for the BLE / USB message schema - see protocol.h
+ */
+
+#include "protocol.h"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace Protocol {
+
+namespace {
+
+const uint8_t WIRE_VARINT = 0;
+const uint8_t WIRE_BYTES = 2;
+
+struct Cursor {
+  const char *p;
+  const char *end;
+
+  void skip_ws() {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+      p++;
+    }
+  }
+  bool consume(char c) {
+    skip_ws();
+    if (p < end && *p == c) {
+      p++;
+      return true;
+    }
+    return false;
+  }
+};
+
+// Drops a multi-byte UTF-8 sequence cut off by truncation
+size_t trim_partial_utf8(const char *s, size_t length) {
+  size_t start = length;
+  while (start > 0 && (static_cast<uint8_t>(s[start - 1]) & 0xC0) == 0x80) {
+    start--;
+  }
+  if (start == 0) {
+    return length;
+  }
+  uint8_t lead = s[start - 1];
+  size_t needed = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 1;
+  return length - (start - 1) < needed ? start - 1 : length;
+}
+
+size_t put_utf8(uint32_t code, char *out) {
+  if (code < 0x80) {
+    out[0] = code;
+    return 1;
+  }
+  if (code < 0x800) {
+    out[0] = 0xC0 | (code >> 6);
+    out[1] = 0x80 | (code & 0x3F);
+    return 2;
+  }
+  if (code < 0x10000) {
+    out[0] = 0xE0 | (code >> 12);
+    out[1] = 0x80 | ((code >> 6) & 0x3F);
+    out[2] = 0x80 | (code & 0x3F);
+    return 3;
+  }
+  out[0] = 0xF0 | (code >> 18);
+  out[1] = 0x80 | ((code >> 12) & 0x3F);
+  out[2] = 0x80 | ((code >> 6) & 0x3F);
+  out[3] = 0x80 | (code & 0x3F);
+  return 4;
+}
+
+bool read_hex4(Cursor &c, uint32_t &value) {
+  if (c.end - c.p < 4) {
+    return false;
+  }
+  value = 0;
+  for (int i = 0; i < 4; i++) {
+    char h = *c.p++;
+    value <<= 4;
+    if (h >= '0' && h <= '9') {
+      value |= h - '0';
+    } else if (h >= 'a' && h <= 'f') {
+      value |= h - 'a' + 10;
+    } else if (h >= 'A' && h <= 'F') {
+      value |= h - 'A' + 10;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Reads a string value; out == nullptr only validates and skips it
+bool read_string(Cursor &c, char *out, size_t capacity) {
+  if (!c.consume('"')) {
+    return false;
+  }
+  size_t length = 0;
+  bool truncated = false;
+  while (c.p < c.end && *c.p != '"') {
+    char utf8[4];
+    size_t n = 1;
+    utf8[0] = *c.p++;
+    if (utf8[0] == '\\') {
+      if (c.p >= c.end) {
+        return false;
+      }
+      char e = *c.p++;
+      switch (e) {
+      case 'n':
+        utf8[0] = '\n';
+        break;
+      case 't':
+        utf8[0] = '\t';
+        break;
+      case 'r':
+        utf8[0] = '\r';
+        break;
+      case 'b':
+        utf8[0] = '\b';
+        break;
+      case 'f':
+        utf8[0] = '\f';
+        break;
+      case 'u': {
+        uint32_t code;
+        if (!read_hex4(c, code)) {
+          return false;
+        }
+        // Surrogate pair for characters outside the BMP (emoji)
+        uint32_t low;
+        if (code >= 0xD800 && code < 0xDC00 && c.end - c.p >= 6 &&
+            c.p[0] == '\\' && c.p[1] == 'u') {
+          c.p += 2;
+          if (!read_hex4(c, low)) {
+            return false;
+          }
+          code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+        }
+        n = put_utf8(code, utf8);
+        break;
+      }
+      default: // '"', '\\', '/'
+        utf8[0] = e;
+        break;
+      }
+    }
+    if (out == nullptr || truncated) {
+      continue;
+    }
+    if (length + n >= capacity) {
+      truncated = true;
+      continue;
+    }
+    memcpy(out + length, utf8, n);
+    length += n;
+  }
+  if (c.p >= c.end) {
+    return false;
+  }
+  c.p++; // Closing quote
+  if (out != nullptr) {
+    if (truncated) {
+      length = trim_partial_utf8(out, length);
+    }
+    out[length] = '\0';
+  }
+  return true;
+}
+
+// Raw key bytes; keys in this protocol never need unescaping
+bool read_key(Cursor &c, const char *&key, size_t &length) {
+  if (!c.consume('"')) {
+    return false;
+  }
+  key = c.p;
+  while (c.p < c.end && *c.p != '"') {
+    if (*c.p == '\\') {
+      c.p++;
+    }
+    c.p++;
+  }
+  if (c.p >= c.end) {
+    return false;
+  }
+  length = c.p - key;
+  c.p++;
+  return c.consume(':');
+}
+
+bool read_u32(Cursor &c, uint32_t &value) {
+  c.skip_ws();
+  if (c.p >= c.end || *c.p < '0' || *c.p > '9') {
+    return false;
+  }
+  uint64_t v = 0;
+  while (c.p < c.end && *c.p >= '0' && *c.p <= '9') {
+    v = v * 10 + (*c.p++ - '0');
+    if (v > UINT32_MAX) {
+      return false;
+    }
+  }
+  value = v;
+  return true;
+}
+
+bool read_literal(Cursor &c, const char *word) {
+  size_t n = strlen(word);
+  if (static_cast<size_t>(c.end - c.p) < n || memcmp(c.p, word, n) != 0) {
+    return false;
+  }
+  c.p += n;
+  return true;
+}
+
+// Skips any value including nested objects and arrays
+bool skip_value(Cursor &c) {
+  c.skip_ws();
+  if (c.p >= c.end) {
+    return false;
+  }
+  if (*c.p == '"') {
+    return read_string(c, nullptr, 0);
+  }
+  if (*c.p == '{' || *c.p == '[') {
+    int depth = 0;
+    while (c.p < c.end) {
+      if (*c.p == '"') {
+        if (!read_string(c, nullptr, 0)) {
+          return false;
+        }
+        continue;
+      }
+      if (*c.p == '{' || *c.p == '[') {
+        depth++;
+      } else if (*c.p == '}' || *c.p == ']') {
+        if (--depth == 0) {
+          c.p++;
+          return true;
+        }
+      }
+      c.p++;
+    }
+    return false;
+  }
+  // Number or literal
+  const char *start = c.p;
+  while (c.p < c.end && *c.p != ',' && *c.p != '}' && *c.p != ']' &&
+         *c.p != ' ' && *c.p != '\n' && *c.p != '\r' && *c.p != '\t') {
+    c.p++;
+  }
+  return c.p > start;
+}
+
+// Walks the members of the top-level object; visit() consumes each value
+template <typename Visitor>
+bool for_each_member(const char *json, size_t length, Visitor visit) {
+  Cursor c = {json, json + length};
+  if (!c.consume('{')) {
+    return false;
+  }
+  if (c.consume('}')) {
+    return true;
+  }
+  do {
+    const char *key;
+    size_t key_length;
+    if (!read_key(c, key, key_length) || !visit(key, key_length, c)) {
+      return false;
+    }
+  } while (c.consume(','));
+  return c.consume('}');
+}
+
+bool decode_field(const FieldDesc &field, Cursor &c, uint8_t *body) {
+  switch (field.kind) {
+  case FieldKind::String:
+    return read_string(c, reinterpret_cast<char *>(body + field.offset),
+                       field.capacity);
+  case FieldKind::U32:
+    return read_u32(c, *reinterpret_cast<uint32_t *>(body + field.offset));
+  case FieldKind::Bool: {
+    c.skip_ws();
+    bool &flag = *reinterpret_cast<bool *>(body + field.offset);
+    if (read_literal(c, "true")) {
+      flag = true;
+      return true;
+    }
+    flag = false;
+    return read_literal(c, "false");
+  }
+  }
+  return false;
+}
+
+struct Writer {
+  char *out;
+  size_t capacity;
+  size_t length;
+  bool ok;
+
+  void put(const char *s, size_t n) {
+    if (!ok || length + n >= capacity) {
+      ok = false;
+      return;
+    }
+    memcpy(out + length, s, n);
+    length += n;
+  }
+  void put(const char *s) { put(s, strlen(s)); }
+  void put_escaped(const char *s) {
+    put("\"", 1);
+    for (; *s != '\0'; s++) {
+      uint8_t ch = *s;
+      if (ch == '"' || ch == '\\') {
+        char escaped[2] = {'\\', static_cast<char>(ch)};
+        put(escaped, 2);
+      } else if (ch == '\n') {
+        put("\\n", 2);
+      } else if (ch < 0x20) {
+        char escaped[7];
+        snprintf(escaped, sizeof(escaped), "\\u%04x", ch);
+        put(escaped, 6);
+      } else {
+        put(s, 1);
+      }
+    }
+    put("\"", 1);
+  }
+  void put_u32(uint32_t value) {
+    char digits[11];
+    int n =
+        snprintf(digits, sizeof(digits), "%u", static_cast<unsigned>(value));
+    put(digits, n);
+  }
+};
+
+bool put_varint(uint8_t *out, size_t capacity, size_t &length,
+                uint32_t value) {
+  do {
+    if (length == capacity) {
+      return false;
+    }
+    uint8_t byte = value & 0x7F;
+    value >>= 7;
+    out[length++] = value != 0 ? byte | 0x80 : byte;
+  } while (value != 0);
+  return true;
+}
+
+bool get_varint(const uint8_t *data, size_t length, size_t &pos,
+                uint32_t &value) {
+  value = 0;
+  for (int shift = 0; shift < 35 && pos < length; shift += 7) {
+    uint8_t byte = data[pos++];
+    value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace
+
+const char *type_name(MessageType type) {
+  const MessageDesc *desc = describe(type);
+  return desc != nullptr ? desc->name : "unknown";
+}
+
+Channel channel_of(MessageType type) {
+  const MessageDesc *desc = describe(type);
+  return desc != nullptr ? desc->channel : Channel::Chat;
+}
+
+bool indicated(MessageType type) {
+  const MessageDesc *desc = describe(type);
+  return desc != nullptr && desc->indicate;
+}
+
+bool decode_json(const char *json, size_t length, Message &out) {
+  memset(&out, 0, sizeof(out));
+
+  // Pass 1: the type selects the field table, wherever "type" appears
+  bool parsed = for_each_member(
+      json, length, [&](const char *key, size_t key_length, Cursor &c) {
+        if (key_length == 4 && memcmp(key, "type", 4) == 0) {
+          c.skip_ws();
+          const char *start = c.p + 1;
+          if (!read_string(c, nullptr, 0)) {
+            return false;
+          }
+          out.type = find_type(start, c.p - 1 - start);
+          return true;
+        }
+        return skip_value(c);
+      });
+  if (!parsed) {
+    return false;
+  }
+
+  // Pass 2: fields straight into the struct; mismatched values are skipped
+  const MessageDesc *desc = describe(out.type);
+  uint8_t *body = reinterpret_cast<uint8_t *>(&out.body);
+  return for_each_member(
+      json, length, [&](const char *key, size_t key_length, Cursor &c) {
+        if (key_length == 3 && memcmp(key, "seq", 3) == 0) {
+          out.has_seq = read_u32(c, out.seq);
+          return out.has_seq || skip_value(c);
+        }
+        int index = desc != nullptr && desc->find_field != nullptr
+                        ? desc->find_field(key, key_length)
+                        : -1;
+        if (index < 0) {
+          return skip_value(c);
+        }
+        Cursor probe = c;
+        if (decode_field(desc->fields[index], c, body)) {
+          return true;
+        }
+        c = probe;
+        return skip_value(c);
+      });
+}
+
+size_t encode_json(const Message &message, char *out, size_t capacity) {
+  const MessageDesc *desc = describe(message.type);
+  if (desc == nullptr || capacity == 0) {
+    return 0;
+  }
+
+  Writer w = {out, capacity, 0, true};
+  const uint8_t *body = reinterpret_cast<const uint8_t *>(&message.body);
+  w.put("{\"type\":\"");
+  w.put(desc->name, desc->name_length);
+  w.put("\"");
+  for (uint8_t i = 0; i < desc->field_count; i++) {
+    const FieldDesc &field = desc->fields[i];
+    w.put(",\"");
+    w.put(field.key, field.key_length);
+    w.put("\":");
+    switch (field.kind) {
+    case FieldKind::String:
+      w.put_escaped(reinterpret_cast<const char *>(body + field.offset));
+      break;
+    case FieldKind::U32:
+      w.put_u32(*reinterpret_cast<const uint32_t *>(body + field.offset));
+      break;
+    case FieldKind::Bool:
+      w.put(*reinterpret_cast<const bool *>(body + field.offset) ? "true"
+                                                                 : "false");
+      break;
+    }
+  }
+  if (message.has_seq) {
+    w.put(",\"seq\":");
+    w.put_u32(message.seq);
+  }
+  w.put("}");
+  if (!w.ok) {
+    return 0;
+  }
+  out[w.length] = '\0';
+  return w.length;
+}
+
+bool decode_binary(const uint8_t *data, size_t length, Message &out) {
+  memset(&out, 0, sizeof(out));
+  if (length < 2) {
+    return false;
+  }
+  const MessageDesc *desc = describe(static_cast<MessageType>(data[0]));
+  if (desc == nullptr || desc->dynamic) {
+    return false;
+  }
+  out.type = desc->type;
+
+  size_t pos = 1;
+  if (!get_varint(data, length, pos, out.seq)) {
+    return false;
+  }
+  out.has_seq = true;
+
+  uint8_t *body = reinterpret_cast<uint8_t *>(&out.body);
+  while (pos < length) {
+    uint32_t key;
+    uint32_t value;
+    if (!get_varint(data, length, pos, key) ||
+        !get_varint(data, length, pos, value)) {
+      return false;
+    }
+    const FieldDesc *field = nullptr;
+    for (uint8_t i = 0; i < desc->field_count; i++) {
+      if (desc->fields[i].tag == key >> 3) {
+        field = &desc->fields[i];
+      }
+    }
+
+    if ((key & 7) == WIRE_BYTES) {
+      if (value > length - pos) {
+        return false;
+      }
+      if (field != nullptr && field->kind == FieldKind::String) {
+        char *text = reinterpret_cast<char *>(body + field->offset);
+        size_t n = value < field->capacity ? value : field->capacity - 1;
+        memcpy(text, data + pos, n);
+        n = n < value ? trim_partial_utf8(text, n) : n;
+        text[n] = '\0';
+      }
+      pos += value;
+    } else if (field != nullptr && field->kind == FieldKind::U32) {
+      *reinterpret_cast<uint32_t *>(body + field->offset) = value;
+    } else if (field != nullptr && field->kind == FieldKind::Bool) {
+      *reinterpret_cast<bool *>(body + field->offset) = value != 0;
+    }
+  }
+  return true;
+}
+
+size_t encode_binary(const Message &message, uint8_t *out, size_t capacity) {
+  const MessageDesc *desc = describe(message.type);
+  if (desc == nullptr || desc->dynamic || capacity == 0) {
+    return 0;
+  }
+
+  size_t length = 0;
+  out[length++] = static_cast<uint8_t>(message.type);
+  if (!put_varint(out, capacity, length, message.seq)) {
+    return 0;
+  }
+
+  const uint8_t *body = reinterpret_cast<const uint8_t *>(&message.body);
+  for (uint8_t i = 0; i < desc->field_count; i++) {
+    const FieldDesc &field = desc->fields[i];
+    const uint8_t *value = body + field.offset;
+    bool ok;
+    if (field.kind == FieldKind::String) {
+      size_t n = strlen(reinterpret_cast<const char *>(value));
+      ok = put_varint(out, capacity, length, field.tag << 3 | WIRE_BYTES) &&
+           put_varint(out, capacity, length, n) && capacity - length >= n;
+      if (ok) {
+        memcpy(out + length, value, n);
+        length += n;
+      }
+    } else {
+      uint32_t number = field.kind == FieldKind::U32
+                            ? *reinterpret_cast<const uint32_t *>(value)
+                            : *reinterpret_cast<const bool *>(value);
+      ok = put_varint(out, capacity, length, field.tag << 3 | WIRE_VARINT) &&
+           put_varint(out, capacity, length, number);
+    }
+    if (!ok) {
+      return 0;
+    }
+  }
+  return length;
+}
+
+} // namespace Protocol
@@ -0,0 +1,75 @@
+/**
+ * Protocol codecs for the BLE / USB message schema
+ *
+ * Message structs, type ids and per-message field tables are generated from
+ * protocol/schema.json into protocol_gen.h/.cpp (make protocol). This file
+ * holds the hand-written runtime that walks those tables:
+ *
+ * - JSON: single-buffer decode straight into a Message, keys resolved by the
+ *   generated switch dispatch, strings unescaped and truncated (on a UTF-8
+ *   boundary) to the schema limits. Encoding writes into a caller buffer.
+ * - Binary: [type id][seq varint] followed by (tag << 3 | wire type) fields,
+ *   varints for numbers and booleans, length-prefixed strings. Unknown tags
+ *   are skipped, so new fields stay backwards compatible.
+ *
+ * Neither direction allocates. Messages with nested JSON members (commands,
+ * batches) are "dynamic": their scalar fields decode normally and the rest
+ * is read with ArduinoJson by the handler. They have no binary form.
+ */
+
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "protocol_gen.h"
+
+namespace Protocol {
+
+enum class FieldKind : uint8_t { String, U32, Bool };
+
+struct FieldDesc {
+  const char *key;
+  uint8_t key_length;
+  uint8_t tag; // Binary field tag, stable across schema revisions
+  FieldKind kind;
+  uint16_t offset;   // Into Message::body
+  uint16_t capacity; // String buffer size including the terminator
+};
+
+struct MessageDesc {
+  MessageType type;
+  const char *name;
+  uint8_t name_length;
+  const FieldDesc *fields;
+  uint8_t field_count;
+  bool dynamic; // Has nested JSON members handled outside the codec
+  int (*find_field)(const char *key, size_t length);
+  Channel channel; // BLE channel the message travels on
+  bool indicate;   // BLE indication (peer confirms) instead of notify
+};
+
+// Generated (protocol_gen.cpp)
+const MessageDesc *describe(MessageType type);
+MessageType find_type(const char *name, size_t length);
+const char *channel_name(Channel channel);
+
+const char *type_name(MessageType type);
+// Chat for unknown types
+Channel channel_of(MessageType type);
+// True for types the schema sends as confirmed BLE indications
+bool indicated(MessageType type);
+
+// Returns false for malformed input; unknown types decode as Unknown
+bool decode_json(const char *json, size_t length, Message &out);
+// Returns the length written (NUL-terminated), or 0 if it does not fit
+size_t encode_json(const Message &message, char *out, size_t capacity);
+
+bool decode_binary(const uint8_t *data, size_t length, Message &out);
+// Returns 0 for dynamic messages or when the buffer is too small
+size_t encode_binary(const Message &message, uint8_t *out, size_t capacity);
+
+} // namespace Protocol
+
+#endif // PROTOCOL_H
@@ -0,0 +1,639 @@
+/**
+ * Generated by firmware/scripts/generate_protocol.py from
+ * protocol/schema.json - do not edit
+ */
+
+#include "protocol.h"
+
+#include <stddef.h>
+#include <string.h>
+
+namespace Protocol {
+
+namespace {
+
+const FieldDesc TEXT_FIELDS[] = {
+    {"message", 7, 1, FieldKind::String, offsetof(Text, message), 201},
+    {"action", 6, 2, FieldKind::String, offsetof(Text, action), 32},
+};
+
+int find_text_field(const char *key, size_t length) {
+  switch (length) {
+  case 6:
+    if (memcmp(key, "action", 6) == 0) {
+      return 1;
+    }
+    break;
+  case 7:
+    if (memcmp(key, "message", 7) == 0) {
+      return 0;
+    }
+    break;
+  }
+  return -1;
+}
+
+const FieldDesc AI_RESPONSE_FIELDS[] = {
+    {"message", 7, 1, FieldKind::String, offsetof(AiResponse, message), 201},
+    {"request", 7, 2, FieldKind::String, offsetof(AiResponse, request), 64},
+    {"ttl_ms", 6, 3, FieldKind::U32, offsetof(AiResponse, ttl_ms), 0},
+    {"action", 6, 4, FieldKind::String, offsetof(AiResponse, action), 32},
+};
+
+int find_ai_response_field(const char *key, size_t length) {
+  switch (length) {
+  case 6:
+    if (memcmp(key, "ttl_ms", 6) == 0) {
+      return 2;
+    }
+    if (memcmp(key, "action", 6) == 0) {
+      return 3;
+    }
+    break;
+  case 7:
+    if (memcmp(key, "message", 7) == 0) {
+      return 0;
+    }
+    if (memcmp(key, "request", 7) == 0) {
+      return 1;
+    }
+    break;
+  }
+  return -1;
+}
+
+const FieldDesc NOTIFICATION_FIELDS[] = {
+    {"app", 3, 1, FieldKind::String, offsetof(Notification, app), 24},
+    {"title", 5, 2, FieldKind::String, offsetof(Notification, title), 64},
+    {"message", 7, 3, FieldKind::String, offsetof(Notification, message), 121},
+    {"priority", 8, 4, FieldKind::String, offsetof(Notification, priority), 8},
+};
+
+int find_notification_field(const char *key, size_t length) {
+  switch (length) {
+  case 3:
+    if (memcmp(key, "app", 3) == 0) {
+      return 0;
+    }
+    break;
+  case 5:
+    if (memcmp(key, "title", 5) == 0) {
+      return 1;
+    }
+    break;
+  case 7:
+    if (memcmp(key, "message", 7) == 0) {
+      return 2;
+    }
+    break;
+  case 8:
+    if (memcmp(key, "priority", 8) == 0) {
+      return 3;
+    }
+    break;
+  }
+  return -1;
+}
+
+const FieldDesc BULK_READY_FIELDS[] = {
+    {"ssid", 4, 1, FieldKind::String, offsetof(BulkReady, ssid), 32},
+    {"password", 8, 2, FieldKind::String, offsetof(BulkReady, password), 64},
+    {"ip", 2, 3, FieldKind::String, offsetof(BulkReady, ip), 16},
+    {"port", 4, 4, FieldKind::U32, offsetof(BulkReady, port), 0},
+    {"token", 5, 5, FieldKind::String, offsetof(BulkReady, token), 17},
+};
+
+int find_bulk_ready_field(const char *key, size_t length) {
+  switch (length) {
+  case 2:
+    if (memcmp(key, "ip", 2) == 0) {
+      return 2;
+    }
+    break;
+  case 4:
+    if (memcmp(key, "ssid", 4) == 0) {
+      return 0;
+    }
+    if (memcmp(key, "port", 4) == 0) {
+      return 3;
+    }
+    break;
+  case 5:
+    if (memcmp(key, "token", 5) == 0) {
+      return 4;
+    }
+    break;
+  case 8:
+    if (memcmp(key, "password", 8) == 0) {
+      return 1;
+    }
+    break;
+  }
+  return -1;
+}
+
+const FieldDesc STATUS_FIELDS[] = {
+    {"ok", 2, 1, FieldKind::Bool, offsetof(Status, ok), 0},
+    {"bytes", 5, 2, FieldKind::U32, offsetof(Status, bytes), 0},
+};
+
+int find_status_field(const char *key, size_t length) {
+  switch (length) {
+  case 2:
+    if (memcmp(key, "ok", 2) == 0) {
+      return 0;
+    }
+    break;
+  case 5:
+    if (memcmp(key, "bytes", 5) == 0) {
+      return 1;
+    }
+    break;
+  }
+  return -1;
+}
+
+const FieldDesc BENCH_FIELDS[] = {
+    {"name", 4, 1, FieldKind::String, offsetof(Bench, name), 16},
+};
+
+int find_bench_field(const char *key, size_t length) {
+  switch (length) {
+  case 4:
+    if (memcmp(key, "name", 4) == 0) {
+      return 0;
+    }
+    break;
+  }
+  return -1;
+}
+
+const FieldDesc ASSET_BEGIN_FIELDS[] = {
+    {"target", 6, 1, FieldKind::String, offsetof(AssetBegin, target), 8},
+    {"name", 4, 2, FieldKind::String, offsetof(AssetBegin, name), 31},
+    {"size", 4, 3, FieldKind::U32, offsetof(AssetBegin, size), 0},
+};
+
+int find_asset_begin_field(const char *key, size_t length) {
+  switch (length) {
+  case 4:
+    if (memcmp(key, "name", 4) == 0) {
+      return 1;
+    }
+    if (memcmp(key, "size", 4) == 0) {
+      return 2;
+    }
+    break;
+  case 6:
+    if (memcmp(key, "target", 6) == 0) {
+      return 0;
+    }
+    break;
+  }
+  return -1;
+}
+
+const FieldDesc METRICS_FIELDS[] = {
+    {"uptime_ms", 9, 1, FieldKind::U32, offsetof(Metrics, uptime_ms), 0},
+    {"free_heap", 9, 2, FieldKind::U32, offsetof(Metrics, free_heap), 0},
+    {"min_free_heap", 13, 3, FieldKind::U32,
+     offsetof(Metrics, min_free_heap), 0},
+    {"free_psram", 10, 4, FieldKind::U32, offsetof(Metrics, free_psram), 0},
+    {"ble_peers", 9, 5, FieldKind::U32, offsetof(Metrics, ble_peers), 0},
+    {"outbox", 6, 6, FieldKind::U32, offsetof(Metrics, outbox), 0},
+    {"cache_hit_rate", 14, 7, FieldKind::U32,
+     offsetof(Metrics, cache_hit_rate), 0},
+    {"notifications", 13, 8, FieldKind::U32,
+     offsetof(Metrics, notifications), 0},
+    {"notifications_dropped", 21, 9, FieldKind::U32,
+     offsetof(Metrics, notifications_dropped), 0},
+    {"usb_frames", 10, 10, FieldKind::U32, offsetof(Metrics, usb_frames), 0},
+    {"usb_crc_errors", 14, 11, FieldKind::U32,
+     offsetof(Metrics, usb_crc_errors), 0},
+    {"stalls", 6, 12, FieldKind::U32, offsetof(Metrics, stalls), 0},
+    {"slo_misses", 10, 13, FieldKind::U32, offsetof(Metrics, slo_misses), 0},
+    {"loop_p99_us", 11, 14, FieldKind::U32, offsetof(Metrics, loop_p99_us), 0},
+    {"lvgl_internal", 13, 15, FieldKind::U32,
+     offsetof(Metrics, lvgl_internal), 0},
+    {"lvgl_psram", 10, 16, FieldKind::U32, offsetof(Metrics, lvgl_psram), 0},
+    {"lvgl_internal_frag", 18, 17, FieldKind::U32,
+     offsetof(Metrics, lvgl_internal_frag), 0},
+    {"lvgl_psram_frag", 15, 18, FieldKind::U32,
+     offsetof(Metrics, lvgl_psram_frag), 0},
+};
+
+int find_metrics_field(const char *key, size_t length) {
+  switch (length) {
+  case 6:
+    if (memcmp(key, "outbox", 6) == 0) {
+      return 5;
+    }
+    if (memcmp(key, "stalls", 6) == 0) {
+      return 11;
+    }
+    break;
+  case 9:
+    if (memcmp(key, "uptime_ms", 9) == 0) {
+      return 0;
+    }
+    if (memcmp(key, "free_heap", 9) == 0) {
+      return 1;
+    }
+    if (memcmp(key, "ble_peers", 9) == 0) {
+      return 4;
+    }
+    break;
+  case 10:
+    if (memcmp(key, "free_psram", 10) == 0) {
+      return 3;
+    }
+    if (memcmp(key, "usb_frames", 10) == 0) {
+      return 9;
+    }
+    if (memcmp(key, "slo_misses", 10) == 0) {
+      return 12;
+    }
+    if (memcmp(key, "lvgl_psram", 10) == 0) {
+      return 15;
+    }
+    break;
+  case 11:
+    if (memcmp(key, "loop_p99_us", 11) == 0) {
+      return 13;
+    }
+    break;
+  case 13:
+    if (memcmp(key, "min_free_heap", 13) == 0) {
+      return 2;
+    }
+    if (memcmp(key, "notifications", 13) == 0) {
+      return 7;
+    }
+    if (memcmp(key, "lvgl_internal", 13) == 0) {
+      return 14;
+    }
+    break;
+  case 14:
+    if (memcmp(key, "cache_hit_rate", 14) == 0) {
+      return 6;
+    }
+    if (memcmp(key, "usb_crc_errors", 14) == 0) {
+      return 10;
+    }
+    break;
+  case 15:
+    if (memcmp(key, "lvgl_psram_frag", 15) == 0) {
+      return 17;
+    }
+    break;
+  case 18:
+    if (memcmp(key, "lvgl_internal_frag", 18) == 0) {
+      return 16;
+    }
+    break;
+  case 21:
+    if (memcmp(key, "notifications_dropped", 21) == 0) {
+      return 8;
+    }
+    break;
+  }
+  return -1;
+}
+
+const FieldDesc DEVICE_STATUS_FIELDS[] = {
+    {"peers", 5, 1, FieldKind::U32, offsetof(DeviceStatus, peers), 0},
+    {"battery", 7, 2, FieldKind::U32, offsetof(DeviceStatus, battery), 0},
+    {"brightness", 10, 3, FieldKind::U32,
+     offsetof(DeviceStatus, brightness), 0},
+};
+
+int find_device_status_field(const char *key, size_t length) {
+  switch (length) {
+  case 5:
+    if (memcmp(key, "peers", 5) == 0) {
+      return 0;
+    }
+    break;
+  case 7:
+    if (memcmp(key, "battery", 7) == 0) {
+      return 1;
+    }
+    break;
+  case 10:
+    if (memcmp(key, "brightness", 10) == 0) {
+      return 2;
+    }
+    break;
+  }
+  return -1;
+}
+
+const FieldDesc MIRROR_CONFIG_FIELDS[] = {
+    {"fps", 3, 1, FieldKind::U32, offsetof(MirrorConfig, fps), 0},
+    {"share", 5, 2, FieldKind::U32, offsetof(MirrorConfig, share), 0},
+};
+
+int find_mirror_config_field(const char *key, size_t length) {
+  switch (length) {
+  case 3:
+    if (memcmp(key, "fps", 3) == 0) {
+      return 0;
+    }
+    break;
+  case 5:
+    if (memcmp(key, "share", 5) == 0) {
+      return 1;
+    }
+    break;
+  }
+  return -1;
+}
+
+const FieldDesc MIRROR_INFO_FIELDS[] = {
+    {"width", 5, 1, FieldKind::U32, offsetof(MirrorInfo, width), 0},
+    {"height", 6, 2, FieldKind::U32, offsetof(MirrorInfo, height), 0},
+    {"tile", 4, 3, FieldKind::U32, offsetof(MirrorInfo, tile), 0},
+    {"fps", 3, 4, FieldKind::U32, offsetof(MirrorInfo, fps), 0},
+    {"share", 5, 5, FieldKind::U32, offsetof(MirrorInfo, share), 0},
+};
+
+int find_mirror_info_field(const char *key, size_t length) {
+  switch (length) {
+  case 3:
+    if (memcmp(key, "fps", 3) == 0) {
+      return 3;
+    }
+    break;
+  case 4:
+    if (memcmp(key, "tile", 4) == 0) {
+      return 2;
+    }
+    break;
+  case 5:
+    if (memcmp(key, "width", 5) == 0) {
+      return 0;
+    }
+    if (memcmp(key, "share", 5) == 0) {
+      return 4;
+    }
+    break;
+  case 6:
+    if (memcmp(key, "height", 6) == 0) {
+      return 1;
+    }
+    break;
+  }
+  return -1;
+}
+
+const FieldDesc COMMAND_FIELDS[] = {
+    {"id", 2, 1, FieldKind::U32, offsetof(Command, id), 0},
+};
+
+int find_command_field(const char *key, size_t length) {
+  switch (length) {
+  case 2:
+    if (memcmp(key, "id", 2) == 0) {
+      return 0;
+    }
+    break;
+  }
+  return -1;
+}
+
+const FieldDesc COMMAND_RESPONSE_FIELDS[] = {
+    {"id", 2, 1, FieldKind::U32, offsetof(CommandResponse, id), 0},
+    {"ok", 2, 2, FieldKind::Bool, offsetof(CommandResponse, ok), 0},
+};
+
+int find_command_response_field(const char *key, size_t length) {
+  switch (length) {
+  case 2:
+    if (memcmp(key, "id", 2) == 0) {
+      return 0;
+    }
+    if (memcmp(key, "ok", 2) == 0) {
+      return 1;
+    }
+    break;
+  }
+  return -1;
+}
+
+const FieldDesc BENCH_RESULT_FIELDS[] = {
+    {"ok", 2, 1, FieldKind::Bool, offsetof(BenchResult, ok), 0},
+};
+
+int find_bench_result_field(const char *key, size_t length) {
+  switch (length) {
+  case 2:
+    if (memcmp(key, "ok", 2) == 0) {
+      return 0;
+    }
+    break;
+  }
+  return -1;
+}
+
+} // namespace
+
+const MessageDesc *describe(MessageType type) {
+  static const MessageDesc MESSAGES[] = {
+      {MessageType::Btn, "btn", 3,
+       TEXT_FIELDS, 2, false, find_text_field, Channel::Chat, false},
+      {MessageType::Connected, "connected", 9,
+       TEXT_FIELDS, 2, false, find_text_field, Channel::Control, true},
+      {MessageType::Welcome, "welcome", 7,
+       TEXT_FIELDS, 2, false, find_text_field, Channel::Control, true},
+      {MessageType::Test, "test", 4,
+       TEXT_FIELDS, 2, false, find_text_field, Channel::Chat, false},
+      {MessageType::TestResponse, "test_response", 13,
+       TEXT_FIELDS, 2, false, find_text_field, Channel::Chat, false},
+      {MessageType::Hello, "hello", 5,
+       TEXT_FIELDS, 2, false, find_text_field, Channel::Control, false},
+      {MessageType::AiRequest, "ai_request", 10,
+       TEXT_FIELDS, 2, false, find_text_field, Channel::Chat, false},
+      {MessageType::AiResponse, "ai_response", 11,
+       AI_RESPONSE_FIELDS, 4, false, find_ai_response_field,
+       Channel::Chat, false},
+      {MessageType::Notification, "notification", 12,
+       NOTIFICATION_FIELDS, 4, false, find_notification_field,
+       Channel::Chat, false},
+      {MessageType::Command, "command", 7,
+       COMMAND_FIELDS, 1, true, find_command_field, Channel::Control, false},
+      {MessageType::CommandResponse, "command_response", 16,
+       COMMAND_RESPONSE_FIELDS, 2, true, find_command_response_field,
+       Channel::Control, true},
+      {MessageType::Batch, "batch", 5,
+       nullptr, 0, true, nullptr, Channel::Chat, true},
+      {MessageType::BulkStart, "bulk_start", 10,
+       nullptr, 0, false, nullptr, Channel::Asset, false},
+      {MessageType::BulkReady, "bulk_ready", 10,
+       BULK_READY_FIELDS, 5, false, find_bulk_ready_field,
+       Channel::Asset, true},
+      {MessageType::BulkDone, "bulk_done", 9,
+       STATUS_FIELDS, 2, false, find_status_field, Channel::Asset, true},
+      {MessageType::Metrics, "metrics", 7,
+       METRICS_FIELDS, 18, false, find_metrics_field,
+       Channel::Diagnostics, false},
+      {MessageType::Bench, "bench", 5,
+       BENCH_FIELDS, 1, false, find_bench_field, Channel::Diagnostics, false},
+      {MessageType::BenchResult, "bench_result", 12,
+       BENCH_RESULT_FIELDS, 1, true, find_bench_result_field,
+       Channel::Diagnostics, false},
+      {MessageType::AssetBegin, "asset_begin", 11,
+       ASSET_BEGIN_FIELDS, 3, false, find_asset_begin_field,
+       Channel::Asset, false},
+      {MessageType::AssetAck, "asset_ack", 9,
+       STATUS_FIELDS, 2, false, find_status_field, Channel::Asset, false},
+      {MessageType::AssetEnd, "asset_end", 9,
+       nullptr, 0, false, nullptr, Channel::Asset, false},
+      {MessageType::AssetDone, "asset_done", 10,
+       STATUS_FIELDS, 2, false, find_status_field, Channel::Asset, false},
+      {MessageType::Credit, "credit", 6,
+       nullptr, 0, false, nullptr, Channel::Control, false},
+      {MessageType::DeviceStatus, "device_status", 13,
+       DEVICE_STATUS_FIELDS, 3, false, find_device_status_field,
+       Channel::Control, false},
+      {MessageType::Mirror, "mirror", 6,
+       MIRROR_CONFIG_FIELDS, 2, false, find_mirror_config_field,
+       Channel::Control, false},
+      {MessageType::MirrorInfo, "mirror_info", 11,
+       MIRROR_INFO_FIELDS, 5, false, find_mirror_info_field,
+       Channel::Control, false},
+  };
+  for (const MessageDesc &desc : MESSAGES) {
+    if (desc.type == type) {
+      return &desc;
+    }
+  }
+  return nullptr;
+}
+
+const char *channel_name(Channel channel) {
+  switch (channel) {
+  case Channel::Chat:
+    return "chat";
+  case Channel::Control:
+    return "control";
+  case Channel::Diagnostics:
+    return "diagnostics";
+  case Channel::Logs:
+    return "logs";
+  case Channel::Ota:
+    return "ota";
+  case Channel::Asset:
+    return "asset";
+  case Channel::Mirror:
+    return "mirror";
+  }
+  return "unknown";
+}
+
+MessageType find_type(const char *key, size_t length) {
+  switch (length) {
+  case 3:
+    if (memcmp(key, "btn", 3) == 0) {
+      return MessageType::Btn;
+    }
+    break;
+  case 4:
+    if (memcmp(key, "test", 4) == 0) {
+      return MessageType::Test;
+    }
+    break;
+  case 5:
+    if (memcmp(key, "hello", 5) == 0) {
+      return MessageType::Hello;
+    }
+    if (memcmp(key, "batch", 5) == 0) {
+      return MessageType::Batch;
+    }
+    if (memcmp(key, "bench", 5) == 0) {
+      return MessageType::Bench;
+    }
+    break;
+  case 6:
+    if (memcmp(key, "credit", 6) == 0) {
+      return MessageType::Credit;
+    }
+    if (memcmp(key, "mirror", 6) == 0) {
+      return MessageType::Mirror;
+    }
+    break;
+  case 7:
+    if (memcmp(key, "welcome", 7) == 0) {
+      return MessageType::Welcome;
+    }
+    if (memcmp(key, "command", 7) == 0) {
+      return MessageType::Command;
+    }
+    if (memcmp(key, "metrics", 7) == 0) {
+      return MessageType::Metrics;
+    }
+    break;
+  case 9:
+    if (memcmp(key, "connected", 9) == 0) {
+      return MessageType::Connected;
+    }
+    if (memcmp(key, "bulk_done", 9) == 0) {
+      return MessageType::BulkDone;
+    }
+    if (memcmp(key, "asset_ack", 9) == 0) {
+      return MessageType::AssetAck;
+    }
+    if (memcmp(key, "asset_end", 9) == 0) {
+      return MessageType::AssetEnd;
+    }
+    break;
+  case 10:
+    if (memcmp(key, "ai_request", 10) == 0) {
+      return MessageType::AiRequest;
+    }
+    if (memcmp(key, "bulk_start", 10) == 0) {
+      return MessageType::BulkStart;
+    }
+    if (memcmp(key, "bulk_ready", 10) == 0) {
+      return MessageType::BulkReady;
+    }
+    if (memcmp(key, "asset_done", 10) == 0) {
+      return MessageType::AssetDone;
+    }
+    break;
+  case 11:
+    if (memcmp(key, "ai_response", 11) == 0) {
+      return MessageType::AiResponse;
+    }
+    if (memcmp(key, "asset_begin", 11) == 0) {
+      return MessageType::AssetBegin;
+    }
+    if (memcmp(key, "mirror_info", 11) == 0) {
+      return MessageType::MirrorInfo;
+    }
+    break;
+  case 12:
+    if (memcmp(key, "notification", 12) == 0) {
+      return MessageType::Notification;
+    }
+    if (memcmp(key, "bench_result", 12) == 0) {
+      return MessageType::BenchResult;
+    }
+    break;
+  case 13:
+    if (memcmp(key, "test_response", 13) == 0) {
+      return MessageType::TestResponse;
+    }
+    if (memcmp(key, "device_status", 13) == 0) {
+      return MessageType::DeviceStatus;
+    }
+    break;
+  case 16:
+    if (memcmp(key, "command_response", 16) == 0) {
+      return MessageType::CommandResponse;
+    }
+    break;
+  }
+  return MessageType::Unknown;
+}
+
+} // namespace Protocol
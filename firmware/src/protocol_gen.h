@@ -0,0 +1,184 @@
+/**
+ * Generated by firmware/scripts/generate_protocol.py from
+ * protocol/schema.json - do not edit
+ *
+ * Message structs for the BLE / USB protocol. Strings are fixed-size
+ * NUL-terminated buffers sized from the schema limits; nested JSON
+ * members (command ops, batch items, ...) are not part of the structs
+ * and are read with ArduinoJson by the message handler.
+ */
+
+#ifndef PROTOCOL_GEN_H
+#define PROTOCOL_GEN_H
+
+#include <stdint.h>
+
+namespace Protocol {
+
+enum class MessageType : uint8_t {
+  Unknown = 0,
+  Btn = 1,
+  Connected = 2,
+  Welcome = 3,
+  Test = 4,
+  TestResponse = 5,
+  Hello = 6,
+  AiRequest = 7,
+  AiResponse = 8,
+  Notification = 9,
+  Command = 10,
+  CommandResponse = 11,
+  Batch = 12,
+  BulkStart = 13,
+  BulkReady = 14,
+  BulkDone = 15,
+  Metrics = 16,
+  Bench = 17,
+  BenchResult = 18,
+  AssetBegin = 19,
+  AssetAck = 20,
+  AssetEnd = 21,
+  AssetDone = 22,
+  Credit = 23,
+  DeviceStatus = 24,
+  Mirror = 25,
+  MirrorInfo = 26,
+};
+
+static const uint8_t MAX_MESSAGE_ID = 26;
+
+// BLE frames start with their channel id, see channel_scheduler.h
+enum class Channel : uint8_t {
+  Chat = 0,
+  Control = 1,
+  Diagnostics = 2,
+  Logs = 3,
+  Ota = 4,
+  Asset = 5,
+  Mirror = 6,
+};
+
+static const uint8_t CHANNEL_COUNT = 7;
+
+struct Text {
+  char message[201];
+  char action[32];
+};
+
+struct AiResponse {
+  char message[201];
+  char request[64];
+  uint32_t ttl_ms;
+  char action[32];
+};
+
+struct Notification {
+  char app[24];
+  char title[64];
+  char message[121];
+  char priority[8];
+};
+
+struct BulkReady {
+  char ssid[32];
+  char password[64];
+  char ip[16];
+  uint32_t port;
+  char token[17];
+};
+
+struct Status {
+  bool ok;
+  uint32_t bytes;
+};
+
+struct Bench {
+  char name[16];
+};
+
+struct AssetBegin {
+  char target[8];
+  char name[31];
+  uint32_t size;
+};
+
+struct Metrics {
+  uint32_t uptime_ms;
+  uint32_t free_heap;
+  uint32_t min_free_heap;
+  uint32_t free_psram;
+  uint32_t ble_peers;
+  uint32_t outbox;
+  uint32_t cache_hit_rate;
+  uint32_t notifications;
+  uint32_t notifications_dropped;
+  uint32_t usb_frames;
+  uint32_t usb_crc_errors;
+  uint32_t stalls;
+  uint32_t slo_misses;
+  uint32_t loop_p99_us;
+  uint32_t lvgl_internal;
+  uint32_t lvgl_psram;
+  uint32_t lvgl_internal_frag;
+  uint32_t lvgl_psram_frag;
+};
+
+struct DeviceStatus {
+  uint32_t peers;
+  uint32_t battery;
+  uint32_t brightness;
+};
+
+struct MirrorConfig {
+  uint32_t fps;
+  uint32_t share;
+};
+
+struct MirrorInfo {
+  uint32_t width;
+  uint32_t height;
+  uint32_t tile;
+  uint32_t fps;
+  uint32_t share;
+};
+
+struct Command {
+  uint32_t id;
+};
+
+struct CommandResponse {
+  uint32_t id;
+  bool ok;
+};
+
+struct BenchResult {
+  bool ok;
+};
+
+union Body {
+  Text text;
+  AiResponse ai_response;
+  Notification notification;
+  BulkReady bulk_ready;
+  Status status;
+  Bench bench;
+  AssetBegin asset_begin;
+  Metrics metrics;
+  DeviceStatus device_status;
+  MirrorConfig mirror_config;
+  MirrorInfo mirror_info;
+  Command command;
+  CommandResponse command_response;
+  BenchResult bench_result;
+};
+
+struct Message {
+  MessageType type;
+  bool has_seq;
+  uint32_t seq;
+  Body body;
+};
+
+} // namespace Protocol
+
+#endif // PROTOCOL_GEN_H
@@ -0,0 +1,150 @@
+/**
+ * On-device LRU cache for AI responses - see response_cache.h
+ */
+
+#include "response_cache.h"
+
+#include <ctype.h>
+#include <string.h>
+
+ResponseCache response_cache;
+
+// FNV-1a over the normalized request: lowercase ASCII, punctuation dropped,
+// whitespace runs collapsed and trimmed. UTF-8 bytes are hashed unchanged.
+uint32_t ResponseCache::hash_request(const char *request) {
+  uint32_t hash = 2166136261u;
+  bool pending_space = false;
+  bool started = false;
+
+  for (const unsigned char *p = reinterpret_cast<const unsigned char *>(
+           request != nullptr ? request : "");
+       *p != '\0'; p++) {
+    unsigned char c = *p;
+    if (c < 0x80) {
+      if (isspace(c)) {
+        pending_space = started;
+        continue;
+      }
+      if (!isalnum(c)) {
+        continue;
+      }
+      c = tolower(c);
+    }
+    if (pending_space) {
+      hash = (hash ^ ' ') * 16777619u;
+      pending_space = false;
+    }
+    hash = (hash ^ c) * 16777619u;
+    started = true;
+  }
+  return hash;
+}
+
+int ResponseCache::find(uint32_t key) const {
+  for (int i = 0; i < Constants::Cache::ENTRIES; i++) {
+    if (entries[i].used && entries[i].key == key) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+const char *ResponseCache::lookup(uint32_t key, uint32_t now_ms) {
+  counters.lookups++;
+  int index = find(key);
+  if (index < 0) {
+    return nullptr;
+  }
+
+  Entry &entry = entries[index];
+  if (now_ms - entry.stored_ms > entry.ttl_ms) {
+    entry.used = false;
+    counters.expired++;
+    return nullptr;
+  }
+
+  entry.last_used = ++tick;
+  counters.hits++;
+  return entry.answer;
+}
+
+bool ResponseCache::store(uint32_t key, const char *answer, uint32_t ttl_ms,
+                          uint32_t now_ms) {
+  int index = find(key);
+  bool changed =
+      index < 0 || strncmp(entries[index].answer, answer,
+                           Constants::Cache::MAX_ANSWER_LENGTH) != 0;
+
+  if (ttl_ms == 0) {
+    // Phone marked the answer uncacheable - forget any stale copy
+    if (index >= 0) {
+      entries[index].used = false;
+    }
+    return changed;
+  }
+
+  if (index < 0) {
+    // Reuse a free entry, otherwise evict the least recently used one
+    index = 0;
+    for (int i = 0; i < Constants::Cache::ENTRIES; i++) {
+      if (!entries[i].used) {
+        index = i;
+        break;
+      }
+      if (entries[i].last_used < entries[index].last_used) {
+        index = i;
+      }
+    }
+    if (entries[index].used) {
+      counters.evictions++;
+    }
+  } else if (changed) {
+    counters.refreshed++;
+  }
+
+  Entry &entry = entries[index];
+  entry.used = true;
+  entry.key = key;
+  entry.stored_ms = now_ms;
+  entry.ttl_ms = ttl_ms < Constants::Cache::MAX_TTL_MS
+                     ? ttl_ms
+                     : Constants::Cache::MAX_TTL_MS;
+  entry.last_used = ++tick;
+  strncpy(entry.answer, answer, Constants::Cache::MAX_ANSWER_LENGTH);
+  entry.answer[Constants::Cache::MAX_ANSWER_LENGTH] = '\0';
+  return changed;
+}
+
+void ResponseCache::begin_request(uint32_t key, bool hit, uint32_t now_ms) {
+  // Take a free slot, recycling timed-out requests or the oldest one
+  int slot = 0;
+  for (int i = 0; i < Constants::Cache::MAX_PENDING; i++) {
+    bool stale = pending[i].used && now_ms - pending[i].sent_ms >
+                                        Constants::Cache::PENDING_TIMEOUT_MS;
+    if (!pending[i].used || stale) {
+      slot = i;
+      break;
+    }
+    if (pending[i].sent_ms < pending[slot].sent_ms) {
+      slot = i;
+    }
+  }
+  pending[slot] = {true, hit, key, now_ms};
+}
+
+bool ResponseCache::complete_request(uint32_t key, uint32_t now_ms) {
+  for (auto &p : pending) {
+    if (!p.used || p.key != key) {
+      continue;
+    }
+    uint32_t rtt = now_ms - p.sent_ms;
+    counters.completed++;
+    counters.total_rtt_ms += rtt;
+    if (p.hit) {
+      counters.saved_ms += rtt;
+    }
+    p.used = false;
+    return p.hit;
+  }
+  return false;
+}
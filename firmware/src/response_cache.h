@@ -0,0 +1,79 @@
+/**
+ * On-device LRU cache for AI responses
+ *
+ * Requests are keyed by a hash of their normalized text (case, whitespace
+ * and punctuation folded), so "What's next on my calendar?" and "whats next
+ * on my calendar" share an entry. The phone decides how long an answer stays
+ * valid via "ttl_ms". A hit is shown immediately while the request still goes
+ * out; when the fresh answer arrives it replaces the cached one and the time
+ * the user did not have to wait is recorded as latency saved.
+ */
+
+#ifndef RESPONSE_CACHE_H
+#define RESPONSE_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "constants.h"
+
+struct CacheStats {
+  uint32_t lookups;
+  uint32_t hits;
+  uint32_t expired;
+  uint32_t evictions;
+  uint32_t refreshed; // Fresh answers that differed from the cached one
+  uint32_t completed; // Requests answered by the phone
+  uint32_t total_rtt_ms;
+  uint32_t saved_ms; // Sum of round trips hidden by a cache hit
+
+  uint32_t hit_rate_percent() const {
+    return lookups > 0 ? hits * 100 / lookups : 0;
+  }
+};
+
+class ResponseCache {
+public:
+  static uint32_t hash_request(const char *request);
+
+  // Returns the cached answer or nullptr on miss / expiry
+  const char *lookup(uint32_t key, uint32_t now_ms);
+
+  // Stores a fresh answer; returns true when it differs from the cached one
+  bool store(uint32_t key, const char *answer, uint32_t ttl_ms,
+             uint32_t now_ms);
+
+  // Round-trip bookkeeping for latency-saved accounting
+  void begin_request(uint32_t key, bool hit, uint32_t now_ms);
+  bool complete_request(uint32_t key, uint32_t now_ms);
+
+  const CacheStats &stats() const { return counters; }
+
+private:
+  struct Entry {
+    bool used;
+    uint32_t key;
+    uint32_t stored_ms;
+    uint32_t ttl_ms;
+    uint32_t last_used; // LRU tick
+    char answer[Constants::Cache::MAX_ANSWER_LENGTH + 1];
+  };
+
+  struct Pending {
+    bool used;
+    bool hit;
+    uint32_t key;
+    uint32_t sent_ms;
+  };
+
+  int find(uint32_t key) const;
+
+  Entry entries[Constants::Cache::ENTRIES] = {};
+  Pending pending[Constants::Cache::MAX_PENDING] = {};
+  uint32_t tick = 0;
+  CacheStats counters = {};
+};
+
+extern ResponseCache response_cache;
+
+#endif // RESPONSE_CACHE_H
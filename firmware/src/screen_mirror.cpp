@@ -0,0 +1,383 @@
+/**
+ * Framebuffer mirror to a phone - see screen_mirror.h
+ */
+
+#include "screen_mirror.h"
+
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+
+#include "ble_session.h"
+
+ScreenMirror screen_mirror;
+
+namespace {
+
+const int TILE = Constants::Mirror::TILE_SIZE;
+const int MAX_RUN = 128; // Pixels per RLE token
+
+// Frame seq and flags; tile index and length per record
+const size_t CHUNK_HEADER = 2;
+const size_t RECORD_HEADER = 3;
+// An incompressible tile: literal tokens only
+const size_t MAX_TILE_RLE =
+    (TILE * TILE + MAX_RUN - 1) / MAX_RUN + 2 * TILE * TILE;
+const size_t MIN_CHUNK = CHUNK_HEADER + RECORD_HEADER + MAX_TILE_RLE;
+
+static_assert(MAX_TILE_RLE <= 255, "tile record length is one byte");
+static_assert(MIN_CHUNK <= Constants::Bluetooth::MAX_FRAME_SIZE -
+                               Constants::Bluetooth::FRAME_HEADER,
+              "a whole tile has to fit one frame");
+
+void set_bit(uint32_t *bits, int n) { bits[n / 32] |= 1u << (n % 32); }
+void clear_bit(uint32_t *bits, int n) { bits[n / 32] &= ~(1u << (n % 32)); }
+
+// First set bit in [from, limit), or -1
+int next_bit(const uint32_t *bits, int from, int limit) {
+  for (int word = from / 32; word * 32 < limit; word++) {
+    uint32_t w = bits[word];
+    if (word == from / 32) {
+      w &= ~0u << (from % 32);
+    }
+    if (w != 0) {
+      int n = word * 32 + __builtin_ctz(w);
+      return n < limit ? n : -1;
+    }
+  }
+  return -1;
+}
+
+void put_pixel(uint8_t *out, size_t &at, uint16_t pixel) {
+  out[at++] = pixel & 0xFF;
+  out[at++] = pixel >> 8;
+}
+
+// Two or more equal pixels become a run token, anything else literals
+size_t rle_encode(const uint16_t *pixels, size_t count, uint8_t *out) {
+  size_t at = 0;
+  size_t i = 0;
+  while (i < count) {
+    size_t run = 1;
+    while (i + run < count && run < MAX_RUN && pixels[i + run] == pixels[i]) {
+      run++;
+    }
+    if (run >= 2) {
+      out[at++] = 0x80 | (run - 1);
+      put_pixel(out, at, pixels[i]);
+      i += run;
+      continue;
+    }
+    size_t start = i;
+    while (i < count && i - start < MAX_RUN &&
+           (i + 1 >= count || pixels[i + 1] != pixels[i])) {
+      i++;
+    }
+    out[at++] = i - start - 1;
+    for (size_t j = start; j < i; j++) {
+      put_pixel(out, at, pixels[j]);
+    }
+  }
+  return at;
+}
+
+} // namespace
+
+void ScreenMirror::begin(lv_display_t *target) {
+  display = target;
+  screen_width = lv_display_get_horizontal_resolution(display);
+  screen_height = lv_display_get_vertical_resolution(display);
+  columns = (screen_width + TILE - 1) / TILE;
+  int tiles = columns * ((screen_height + TILE - 1) / TILE);
+  // A display with more tiles than the bitmaps hold cannot be mirrored
+  tile_count = tiles <= Constants::Mirror::MAX_TILES ? tiles : 0;
+  lv_display_add_event_cb(display, on_flush_start, LV_EVENT_FLUSH_START,
+                          this);
+}
+
+bool ScreenMirror::start(int8_t peer, uint32_t fps, uint32_t share) {
+  if (display == nullptr || tile_count == 0 ||
+      lv_display_get_color_format(display) != LV_COLOR_FORMAT_RGB565) {
+    Serial.println("⚠️ Screen mirror not supported on this display");
+    return false;
+  }
+
+  size_t bytes = static_cast<size_t>(screen_width) * screen_height *
+                 sizeof(uint16_t);
+  if (canvas == nullptr) {
+    canvas = static_cast<uint16_t *>(
+        heap_caps_calloc(1, bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT));
+    shadow = static_cast<uint16_t *>(
+        heap_caps_calloc(1, bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT));
+    if (canvas == nullptr || shadow == nullptr) {
+      heap_caps_free(canvas);
+      heap_caps_free(shadow);
+      canvas = shadow = nullptr;
+      Serial.println("❌ No PSRAM for the screen mirror");
+      return false;
+    }
+  }
+
+  peer_id = peer;
+  frame_fps = constrain(fps, 1u, uint32_t(Constants::Mirror::MAX_FPS));
+  share_percent = constrain(
+      share, 1u, uint32_t(Constants::Mirror::MAX_SHARE_PERCENT));
+  bytes_per_s = Constants::Mirror::LINK_BYTES_PER_S * share_percent / 100;
+  tokens = 0;
+  last_refill = millis();
+  next_frame_at = last_refill;
+  BleSession *session = ble_sessions.session(peer);
+  drops_seen = session != nullptr
+                   ? session->tx_queue.stats(Channel::Mirror).frames_dropped
+                   : 0;
+  resync();
+
+  // One full redraw fills the canvas
+  lv_obj_invalidate(lv_display_get_screen_active(display));
+  Serial.printf("🪞 Screen mirror to peer %d: %u fps, %u%% share (%u B/s)\n",
+                peer, frame_fps, share_percent, bytes_per_s);
+  return true;
+}
+
+void ScreenMirror::stop() {
+  if (!active()) {
+    return;
+  }
+  Serial.printf("🪞 Screen mirror to peer %d stopped\n", peer_id);
+  peer_id = -1;
+  frame_open = false;
+  heap_caps_free(canvas);
+  heap_caps_free(shadow);
+  canvas = shadow = nullptr;
+}
+
+// Runs inside lv_timer_handler() before the panel flush; kept to a copy
+void ScreenMirror::on_flush_start(lv_event_t *e) {
+  ScreenMirror *mirror =
+      static_cast<ScreenMirror *>(lv_event_get_user_data(e));
+  if (!mirror->active()) {
+    return;
+  }
+  const lv_area_t *area = static_cast<lv_area_t *>(lv_event_get_param(e));
+  lv_draw_buf_t *buffer = lv_display_get_buf_active(mirror->display);
+  if (area == nullptr || buffer == nullptr) {
+    return;
+  }
+
+  uint32_t start = esp_timer_get_time();
+  mirror->capture(*area, *buffer);
+  uint32_t spent = esp_timer_get_time() - start;
+  MirrorStats &counters = mirror->counters;
+  counters.captures++;
+  counters.capture_us_total += spent;
+  if (spent > counters.capture_us_max) {
+    counters.capture_us_max = spent;
+  }
+}
+
+void ScreenMirror::capture(const lv_area_t &area,
+                           const lv_draw_buf_t &buffer) {
+  lv_area_t clipped = {max<int32_t>(area.x1, 0), max<int32_t>(area.y1, 0),
+                       min<int32_t>(area.x2, screen_width - 1),
+                       min<int32_t>(area.y2, screen_height - 1)};
+  if (clipped.x1 > clipped.x2 || clipped.y1 > clipped.y2) {
+    return;
+  }
+
+  // Partial rendering (LV_Helper) hands over the area alone; direct and
+  // full rendering the whole screen, with the area at its own position
+  int32_t buffer_w = buffer.header.w;
+  int32_t buffer_h = buffer.header.h;
+  bool whole_screen = buffer_w != lv_area_get_width(&area) ||
+                      buffer_h != lv_area_get_height(&area);
+  int32_t origin_x = whole_screen ? 0 : area.x1;
+  int32_t origin_y = whole_screen ? 0 : area.y1;
+  size_t row_bytes = (clipped.x2 - clipped.x1 + 1) * sizeof(uint16_t);
+  for (int32_t y = clipped.y1; y <= clipped.y2; y++) {
+    const uint8_t *row = buffer.data + (y - origin_y) * buffer.header.stride +
+                         (clipped.x1 - origin_x) * sizeof(uint16_t);
+    memcpy(canvas + y * screen_width + clipped.x1, row, row_bytes);
+  }
+  mark_tiles(clipped);
+}
+
+void ScreenMirror::mark_tiles(const lv_area_t &area) {
+  for (int row = area.y1 / TILE; row <= area.y2 / TILE; row++) {
+    for (int column = area.x1 / TILE; column <= area.x2 / TILE; column++) {
+      set_bit(dirty, row * columns + column);
+    }
+  }
+}
+
+// Both shadows back to zero and every tile due, so the phone gets the
+// whole screen again
+void ScreenMirror::resync() {
+  memset(shadow, 0,
+         static_cast<size_t>(screen_width) * screen_height * sizeof(uint16_t));
+  memset(dirty, 0xFF, sizeof(dirty));
+  memset(pending, 0, sizeof(pending));
+  frame_open = false;
+  reset_pending = true;
+}
+
+void ScreenMirror::open_frame(uint32_t now) {
+  memcpy(pending, dirty, sizeof(pending));
+  memset(dirty, 0, sizeof(dirty));
+  cursor = 0;
+  frame_open = true;
+  frame_has_tiles = false;
+  frame_seq++;
+  counters.frames++;
+  next_frame_at = now + 1000 / frame_fps;
+}
+
+void ScreenMirror::service(uint32_t now) {
+  if (!active()) {
+    return;
+  }
+  BleSession *session = ble_sessions.session(peer_id);
+  if (session == nullptr) {
+    stop();
+    return;
+  }
+
+  // A dropped mirror frame leaves the phone's shadow behind: start over
+  uint32_t drops = session->tx_queue.stats(Channel::Mirror).frames_dropped;
+  if (drops != drops_seen) {
+    drops_seen = drops;
+    counters.resyncs++;
+    resync();
+  }
+
+  // Token bucket at the configured share of the link
+  uint32_t elapsed = min<uint32_t>(now - last_refill, 1000);
+  last_refill = now;
+  tokens += elapsed * bytes_per_s / 1000;
+  const int32_t burst = Constants::Mirror::MAX_QUEUED_FRAMES *
+                        Constants::Bluetooth::MAX_FRAME_SIZE;
+  if (tokens > burst) {
+    tokens = burst;
+  }
+
+  if (!frame_open && static_cast<int32_t>(now - next_frame_at) >= 0 &&
+      next_bit(dirty, 0, tile_count) >= 0) {
+    open_frame(now);
+  }
+
+  uint16_t capacity = session->max_message();
+  if (capacity < MIN_CHUNK) {
+    return; // Until the MTU exchange makes room for a whole tile
+  }
+  while (frame_open && tokens > 0 &&
+         session->tx_queue.queued(Channel::Mirror) <
+             Constants::Mirror::MAX_QUEUED_FRAMES) {
+    if (!send_chunk(capacity)) {
+      break;
+    }
+  }
+}
+
+// Queues one mirror frame with as many pending tiles as fit; false when
+// nothing more can go this pass
+bool ScreenMirror::send_chunk(uint16_t capacity) {
+  uint8_t chunk[Constants::Bluetooth::MAX_FRAME_SIZE];
+  uint8_t record[MAX_TILE_RLE];
+  size_t length = CHUNK_HEADER;
+  uint8_t flags = reset_pending ? FLAG_RESET : 0;
+
+  while (true) {
+    int tile = next_bit(pending, cursor, tile_count);
+    if (tile < 0) {
+      flags |= FLAG_LAST;
+      frame_open = false;
+      break;
+    }
+    size_t encoded = encode_tile(tile, record);
+    if (encoded == 0) {
+      clear_bit(pending, tile);
+      cursor = tile + 1;
+      counters.tiles_unchanged++;
+      continue;
+    }
+    if (length + RECORD_HEADER + encoded > capacity) {
+      break; // Next chunk
+    }
+    chunk[length++] = tile & 0xFF;
+    chunk[length++] = tile >> 8;
+    chunk[length++] = encoded;
+    memcpy(chunk + length, record, encoded);
+    length += encoded;
+    commit_tile(tile);
+    clear_bit(pending, tile);
+    cursor = tile + 1;
+    counters.tiles_sent++;
+    frame_has_tiles = true;
+  }
+
+  // A frame whose tiles all came out unchanged is not sent at all
+  if (length == CHUNK_HEADER && !((flags & FLAG_LAST) && frame_has_tiles)) {
+    return false;
+  }
+  chunk[0] = frame_seq;
+  chunk[1] = flags;
+  if (!ble_sessions.enqueue(peer_id, Channel::Mirror,
+                            reinterpret_cast<const char *>(chunk), length)) {
+    return false; // Counted as dropped; the next pass resyncs
+  }
+  reset_pending = false;
+  tokens -= length;
+  counters.bytes_sent += length;
+  return frame_open;
+}
+
+// XOR against the phone's copy and RLE; 0 when the tile is unchanged.
+// The pixels are kept in snapshot for commit_tile().
+size_t ScreenMirror::encode_tile(uint16_t tile, uint8_t *out) {
+  int x0 = tile % columns * TILE;
+  int y0 = tile / columns * TILE;
+  int w = min(TILE, screen_width - x0);
+  int h = min(TILE, screen_height - y0);
+  uint16_t delta[TILE_PIXELS];
+  uint16_t changed = 0;
+  int n = 0;
+  for (int y = y0; y < y0 + h; y++) {
+    const uint16_t *shown = canvas + y * screen_width + x0;
+    const uint16_t *seen = shadow + y * screen_width + x0;
+    for (int x = 0; x < w; x++, n++) {
+      snapshot[n] = shown[x];
+      delta[n] = shown[x] ^ seen[x];
+      changed |= delta[n];
+    }
+  }
+  return changed != 0 ? rle_encode(delta, n, out) : 0;
+}
+
+void ScreenMirror::commit_tile(uint16_t tile) {
+  int x0 = tile % columns * TILE;
+  int y0 = tile / columns * TILE;
+  int w = min(TILE, screen_width - x0);
+  int h = min(TILE, screen_height - y0);
+  for (int y = 0; y < h; y++) {
+    memcpy(shadow + (y0 + y) * screen_width + x0, snapshot + y * w,
+           w * sizeof(uint16_t));
+  }
+}
+
+void ScreenMirror::print_stats() {
+  if (!active()) {
+    return;
+  }
+  uint32_t raw = counters.tiles_sent * TILE_PIXELS * sizeof(uint16_t);
+  Serial.printf("Mirror: peer %d | %u frames | %u tiles sent, %u unchanged | "
+                "%u bytes (%u%% of raw) | %u resyncs | capture avg %u us, "
+                "max %u us\n",
+                peer_id, counters.frames, counters.tiles_sent,
+                counters.tiles_unchanged, counters.bytes_sent,
+                raw > 0 ? static_cast<uint32_t>(
+                              uint64_t(counters.bytes_sent) * 100 / raw)
+                        : 0,
+                counters.resyncs,
+                counters.captures > 0
+                    ? counters.capture_us_total / counters.captures
+                    : 0,
+                counters.capture_us_max);
+}
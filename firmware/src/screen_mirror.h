@@ -0,0 +1,130 @@
+/**
+ * Framebuffer mirror to a phone
+ *
+ * Support and demo stream of exactly what the panel shows. A phone starts
+ * it with a "mirror" message (fps, bandwidth share) and gets a
+ * "mirror_info" reply with the geometry; fps 0 or a disconnect stops it.
+ *
+ * Rendering pays only for a copy: an LV_EVENT_FLUSH_START handler copies
+ * each flushed area row by row into a PSRAM canvas and marks the tiles it
+ * touched. Nothing else happens on the render path, and while the mirror
+ * is off the handler returns at once and no canvas is allocated. LVGL's
+ * draw tasks only render into the draw buffer; flushes, and so this
+ * handler, stay in loop()'s lv_timer_handler(), as does service().
+ *
+ * service() runs from loop(). At most fps times a second it takes the
+ * dirty tiles as a new frame, then encodes them into binary frames on the
+ * mirror channel while the budget lasts:
+ *  - Each tile is XORed with the copy the phone already has (a shadow kept
+ *    in step on both sides), so unchanged pixels become zero runs and
+ *    tiles LVGL redrew identically are not sent at all.
+ *  - The delta is run-length coded per RGB565 pixel.
+ *  - A token bucket holds the stream to share percent of
+ *    LINK_BYTES_PER_S, at most MAX_QUEUED_FRAMES wait in the peer's queue,
+ *    and the mirror channel has the lowest scheduler weight, so chat and
+ *    control never queue behind it. A frame still sending at the next fps
+ *    tick holds the next one back, so the frame rate drops to what the
+ *    budget carries.
+ * A mirror frame the link drops leaves the shadows apart; the stream then
+ * restarts from a cleared shadow, flagged so the phone clears its own.
+ *
+ * Mirror frame payload (after the channel header):
+ *   [frame seq][flags: bit 0 last chunk of the frame, bit 1 clear shadow]
+ *   then per tile [tile index u16 LE][length u8][RLE tokens]
+ * Tiles are TILE_SIZE square, numbered row-major. An RLE token is
+ * 0x80 | (n - 1) followed by one pixel repeated n times, or n - 1
+ * followed by n literal pixels (n <= 128); pixels are RGB565 as LVGL
+ * renders them, little-endian, XORed with the shadow.
+ */
+
+#ifndef SCREEN_MIRROR_H
+#define SCREEN_MIRROR_H
+
+#include <Arduino.h>
+#include <lvgl.h>
+
+#include "constants.h"
+
+struct MirrorStats {
+  uint32_t frames;          // Frames started
+  uint32_t tiles_sent;
+  uint32_t tiles_unchanged; // Flushed, but identical to the phone's copy
+  uint32_t bytes_sent;      // Mirror payload, before BLE headers
+  uint32_t resyncs;         // Restarts after a dropped mirror frame
+  uint32_t captures;        // Flushes copied into the canvas
+  uint32_t capture_us_total;
+  uint32_t capture_us_max;
+};
+
+class ScreenMirror {
+public:
+  static const uint8_t FLAG_LAST = 0x01;  // Frame complete, present it
+  static const uint8_t FLAG_RESET = 0x02; // Clear the shadow first
+
+  // Hooks the display's flushes; allocates nothing until start()
+  void begin(lv_display_t *display);
+
+  // Streams to one peer; a new request replaces the current stream.
+  // False when the canvas cannot be allocated.
+  bool start(int8_t peer, uint32_t fps, uint32_t share_percent);
+  void stop();
+
+  bool active() const { return peer_id >= 0; }
+  int8_t peer() const { return peer_id; }
+  uint8_t fps() const { return frame_fps; }
+  uint8_t share() const { return share_percent; }
+  uint16_t width() const { return screen_width; }
+  uint16_t height() const { return screen_height; }
+
+  // Starts frames at the fps limit and queues what the budget allows
+  void service(uint32_t now);
+
+  const MirrorStats &stats() const { return counters; }
+  void print_stats();
+
+private:
+  static const int TILE_PIXELS =
+      Constants::Mirror::TILE_SIZE * Constants::Mirror::TILE_SIZE;
+  static const int TILE_WORDS = (Constants::Mirror::MAX_TILES + 31) / 32;
+
+  static void on_flush_start(lv_event_t *e);
+  void capture(const lv_area_t &area, const lv_draw_buf_t &buffer);
+  void mark_tiles(const lv_area_t &area);
+  void resync();
+  void open_frame(uint32_t now);
+  bool send_chunk(uint16_t capacity);
+  size_t encode_tile(uint16_t tile, uint8_t *out);
+  void commit_tile(uint16_t tile);
+
+  lv_display_t *display = nullptr;
+  uint16_t *canvas = nullptr; // What the panel shows (PSRAM)
+  uint16_t *shadow = nullptr; // What the phone has (PSRAM)
+  uint16_t screen_width = 0;
+  uint16_t screen_height = 0;
+  uint16_t columns = 0; // Tiles per row
+  uint16_t tile_count = 0;
+
+  uint32_t dirty[TILE_WORDS] = {};   // Touched since the last frame began
+  uint32_t pending[TILE_WORDS] = {}; // Still to send in the current frame
+  uint16_t cursor = 0;               // First tile that may be pending
+  bool frame_open = false;
+  bool frame_has_tiles = false;
+  bool reset_pending = false; // Next chunk carries FLAG_RESET
+  uint8_t frame_seq = 0;
+  uint16_t snapshot[TILE_PIXELS]; // Pixels of the tile last encoded
+
+  int8_t peer_id = -1;
+  uint8_t frame_fps = 0;
+  uint8_t share_percent = 0;
+  uint32_t bytes_per_s = 0;
+  int32_t tokens = 0;
+  uint32_t last_refill = 0;
+  uint32_t next_frame_at = 0;
+  uint32_t drops_seen = 0; // Mirror frames the session had dropped
+
+  MirrorStats counters = {};
+};
+
+extern ScreenMirror screen_mirror;
+
+#endif // SCREEN_MIRROR_H
@@ -0,0 +1,63 @@
+/**
+ * Persistent device settings - see settings.h
+ */
+
+#include "settings.h"
+
+#include <Preferences.h>
+
+DeviceSettings device_settings;
+
+static void reset_to_defaults(DeviceSettings &settings) {
+  memset(&settings, 0, sizeof(settings));
+  settings.version = Constants::Settings::VERSION;
+  settings.brightness = Constants::Settings::DEFAULT_BRIGHTNESS;
+  strlcpy(settings.device_name, Constants::Bluetooth::DEVICE_NAME,
+          sizeof(settings.device_name));
+  settings.status_interval_ms = Constants::Settings::DEFAULT_STATUS_INTERVAL_MS;
+  settings.battery_interval_ms =
+      Constants::Settings::DEFAULT_BATTERY_INTERVAL_MS;
+}
+
+void load_settings() {
+  reset_to_defaults(device_settings);
+
+  Preferences prefs;
+  if (!prefs.begin(Constants::Storage::PREFS_NAMESPACE, true)) {
+    Serial.println("⚠️ Settings namespace missing, using defaults");
+    return;
+  }
+
+  DeviceSettings stored;
+  size_t length = prefs.getBytes(Constants::Storage::KEY_USER_SETTINGS,
+                                 &stored, sizeof(stored));
+  prefs.end();
+
+  if (length == sizeof(stored) &&
+      stored.version == Constants::Settings::VERSION) {
+    stored.device_name[sizeof(stored.device_name) - 1] = '\0';
+    device_settings = stored;
+    Serial.println("Settings loaded from NVS");
+  } else {
+    Serial.println("Settings not found or outdated, using defaults");
+  }
+}
+
+bool save_settings() {
+  Preferences prefs;
+  if (!prefs.begin(Constants::Storage::PREFS_NAMESPACE, false)) {
+    Serial.println("❌ Failed to open settings namespace");
+    return false;
+  }
+
+  size_t written = prefs.putBytes(Constants::Storage::KEY_USER_SETTINGS,
+                                  &device_settings, sizeof(device_settings));
+  prefs.end();
+
+  if (written != sizeof(device_settings)) {
+    Serial.println("❌ Failed to write settings");
+    return false;
+  }
+  Serial.println("💾 Settings saved");
+  return true;
+}
@@ -0,0 +1,28 @@
+/**
+ * Persistent device settings
+ *
+ * All user-configurable values live in one struct that is stored as a single
+ * NVS blob, so a batch of changes costs exactly one flash write.
+ */
+
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include <Arduino.h>
+
+#include "constants.h"
+
+struct DeviceSettings {
+  uint8_t version;
+  uint8_t brightness;
+  char device_name[Constants::Settings::MAX_DEVICE_NAME_LENGTH + 1];
+  uint32_t status_interval_ms;
+  uint32_t battery_interval_ms;
+};
+
+extern DeviceSettings device_settings;
+
+void load_settings();
+bool save_settings();
+
+#endif // SETTINGS_H
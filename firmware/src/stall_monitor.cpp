@@ -0,0 +1,220 @@
+/**
+ * Main-loop stall detector - see stall_monitor.h
+ */
+
+#include "stall_monitor.h"
+
+#include <esp_debug_helpers.h>
+#include <esp_timer.h>
+#include <freertos/xtensa_context.h>
+
+StallMonitor stall_monitor;
+
+namespace {
+
+// Return address -> its call instruction, as the panic handler prints it
+uint32_t call_site(uint32_t pc) {
+  if (pc & 0x80000000) {
+    pc = (pc & 0x3FFFFFFF) | 0x40000000;
+  }
+  return pc - 3;
+}
+
+uint32_t now_us() { return static_cast<uint32_t>(esp_timer_get_time()); }
+
+bool running_on_a_core(TaskHandle_t task) {
+  for (int core = 0; core < portNUM_PROCESSORS; core++) {
+    if (xTaskGetCurrentTaskHandleForCPU(core) == task) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace
+
+void StallMonitor::begin() {
+  xTaskCreatePinnedToCore(task_main, "stall_monitor",
+                          Constants::Watchdog::TASK_STACK_SIZE, this,
+                          Constants::Watchdog::TASK_PRIORITY, &task, 0);
+}
+
+int8_t StallMonitor::watch(const char *name, uint32_t slo_us,
+                           uint32_t stall_ms) {
+  int8_t id = -1;
+  portENTER_CRITICAL(&lock);
+  if (lane_count < Constants::Watchdog::MAX_LANES) {
+    id = lane_count;
+    Lane &lane = lanes[id];
+    lane.name = name;
+    lane.task = xTaskGetCurrentTaskHandle();
+    lane.slo_us = slo_us;
+    lane.stall_us = stall_ms * 1000;
+    lane_count = id + 1;
+  }
+  portEXIT_CRITICAL(&lock);
+  return id;
+}
+
+void StallMonitor::start(int8_t id) {
+  if (id < 0) {
+    return;
+  }
+  Lane &lane = lanes[id];
+  portENTER_CRITICAL(&lock);
+  lane.started_us = now_us();
+  lane.iteration++;
+  lane.running = true;
+  portEXIT_CRITICAL(&lock);
+}
+
+void StallMonitor::finish(int8_t id) {
+  if (id < 0) {
+    return;
+  }
+  Lane &lane = lanes[id];
+  uint32_t elapsed = now_us() - lane.started_us;
+
+  StallReport report;
+  bool stalled = false;
+  portENTER_CRITICAL(&lock);
+  lane.running = false;
+  if (lane.report.depth > 0 && lane.report.iteration == lane.iteration) {
+    report = lane.report;
+    lane.report.depth = 0;
+    stalled = true;
+  }
+  portEXIT_CRITICAL(&lock);
+
+  lane.histogram.record(elapsed);
+  lane.stats.iterations++;
+  lane.stats.total_us += elapsed;
+  if (elapsed > lane.slo_us) {
+    lane.stats.slo_misses++;
+  }
+
+  if (stalled) {
+    Serial.printf("⏱️ Stall: %s iteration took %u ms (threshold %u ms)\n",
+                  lane.name, elapsed / 1000, lane.stall_us / 1000);
+    Serial.print("Backtrace:");
+    for (uint8_t i = 0; i < report.depth; i++) {
+      Serial.printf(" 0x%08x:0x%08x", report.pc[i], report.sp[i]);
+    }
+    Serial.println();
+  }
+}
+
+void StallMonitor::task_main(void *arg) {
+  StallMonitor *self = static_cast<StallMonitor *>(arg);
+  while (true) {
+    vTaskDelay(pdMS_TO_TICKS(Constants::Watchdog::POLL_MS));
+    self->check(now_us());
+  }
+}
+
+void StallMonitor::check(uint32_t now) {
+  for (uint8_t i = 0; i < lane_count; i++) {
+    Lane &lane = lanes[i];
+    portENTER_CRITICAL(&lock);
+    uint32_t iteration = lane.iteration;
+    // Once per iteration: report.iteration is only set by a capture
+    bool stuck = lane.running && lane.report.iteration != iteration &&
+                 now - lane.started_us > lane.stall_us;
+    portEXIT_CRITICAL(&lock);
+    if (stuck) {
+      capture(lane, iteration);
+    }
+  }
+}
+
+void StallMonitor::capture(Lane &lane, uint32_t iteration) {
+  // A blocked task's saved frame is current. One that is running or ready
+  // is suspended so its context is saved, and waited for until it is off
+  // the other core.
+  eTaskState state = eTaskGetState(lane.task);
+  bool suspend = state == eRunning || state == eReady;
+  if (suspend) {
+    vTaskSuspend(lane.task);
+    for (int spins = 0; spins < 100 && running_on_a_core(lane.task);
+         spins++) {
+      delayMicroseconds(10);
+    }
+  }
+
+  StallReport report = {};
+  report.iteration = iteration;
+  // pxTopOfStack is the first member of every FreeRTOS TCB; exit == 0
+  // marks the solicited frame of a voluntary yield
+  const long *top = *reinterpret_cast<long *const *>(lane.task);
+  esp_backtrace_frame_t frame = {};
+  if (top[0] == 0) {
+    const XtSolFrame *saved = reinterpret_cast<const XtSolFrame *>(top);
+    frame.pc = saved->pc;
+    frame.sp = saved->a1;
+    frame.next_pc = saved->a0;
+  } else {
+    const XtExcFrame *saved = reinterpret_cast<const XtExcFrame *>(top);
+    frame.pc = saved->pc;
+    frame.sp = saved->a1;
+    frame.next_pc = saved->a0;
+  }
+  while (report.depth < Constants::Watchdog::BACKTRACE_DEPTH) {
+    report.pc[report.depth] = call_site(frame.pc);
+    report.sp[report.depth] = frame.sp;
+    report.depth++;
+    if (frame.next_pc == 0 || !esp_backtrace_get_next_frame(&frame)) {
+      break;
+    }
+  }
+
+  if (suspend) {
+    vTaskResume(lane.task);
+  }
+
+  portENTER_CRITICAL(&lock);
+  lane.stats.stalls++;
+  if (lane.iteration == iteration) {
+    lane.report = report;
+  }
+  portEXIT_CRITICAL(&lock);
+}
+
+uint32_t StallMonitor::stalls() const {
+  uint32_t total = 0;
+  for (uint8_t i = 0; i < lane_count; i++) {
+    total += lanes[i].stats.stalls;
+  }
+  return total;
+}
+
+uint32_t StallMonitor::slo_misses() const {
+  uint32_t total = 0;
+  for (uint8_t i = 0; i < lane_count; i++) {
+    total += lanes[i].stats.slo_misses;
+  }
+  return total;
+}
+
+uint32_t StallMonitor::p99_us(int8_t id) const {
+  return id >= 0 && id < lane_count ? lanes[id].histogram.percentile(99) : 0;
+}
+
+void StallMonitor::print_stats() const {
+  for (uint8_t i = 0; i < lane_count; i++) {
+    const Lane &lane = lanes[i];
+    const LaneStats &stats = lane.stats;
+    if (stats.iterations == 0) {
+      continue;
+    }
+    Serial.printf("Lane %s: %u iterations | %.2f%% within %u us SLO (%u "
+                  "misses) | avg %u us p50 %u us p99 %u us max %u us | "
+                  "%u stalls\n",
+                  lane.name, stats.iterations,
+                  100.0f * (stats.iterations - stats.slo_misses) /
+                      stats.iterations,
+                  lane.slo_us, stats.slo_misses,
+                  static_cast<uint32_t>(stats.total_us / stats.iterations),
+                  lane.histogram.percentile(50), lane.histogram.percentile(99),
+                  lane.histogram.max(), stats.stalls);
+  }
+}
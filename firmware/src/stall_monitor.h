@@ -0,0 +1,87 @@
+/**
+ * Main-loop stall detector with per-iteration latency SLOs
+ *
+ * loop() and the app's own tasks mark every iteration with start() and
+ * finish(). finish() records the duration in a LatencyHistogram and counts
+ * iterations over the lane's SLO. A monitor task pinned to core 0 (loop()
+ * runs on core 1) checks every POLL_MS for an iteration that has run past
+ * its lane's stall threshold, and captures that task's backtrace while it
+ * is still stuck: a blocked task's saved frame already shows where it
+ * waits, a running one is suspended for the moment it takes to walk its
+ * stack.
+ *
+ * The lane prints the stall once the iteration finishes, with a
+ * "Backtrace:" line in the panic handler's format, so the
+ * esp32_exception_decoder monitor filter resolves it to file:line. An
+ * iteration that never finishes is left to the ESP-IDF task watchdog,
+ * which loop() (enableLoopWDT) and the button task subscribe to as the
+ * last resort.
+ */
+
+#ifndef STALL_MONITOR_H
+#define STALL_MONITOR_H
+
+#include <Arduino.h>
+
+#include "constants.h"
+#include "latency_probe.h"
+
+struct StallReport {
+  uint32_t pc[Constants::Watchdog::BACKTRACE_DEPTH];
+  uint32_t sp[Constants::Watchdog::BACKTRACE_DEPTH];
+  uint8_t depth;
+  uint32_t iteration; // Lane iteration the backtrace belongs to
+};
+
+struct LaneStats {
+  uint32_t iterations;
+  uint32_t slo_misses;
+  uint32_t stalls;
+  uint64_t total_us;
+};
+
+class StallMonitor {
+public:
+  void begin();
+
+  // Registers the calling task; -1 when every lane is taken
+  int8_t watch(const char *name, uint32_t slo_us, uint32_t stall_ms);
+  void start(int8_t lane);
+  void finish(int8_t lane);
+
+  // Over all lanes
+  uint32_t stalls() const;
+  uint32_t slo_misses() const;
+  // 99th percentile iteration time of a lane, in us
+  uint32_t p99_us(int8_t lane) const;
+
+  void print_stats() const;
+
+private:
+  struct Lane {
+    const char *name;
+    TaskHandle_t task;
+    uint32_t slo_us;
+    uint32_t stall_us;
+    // Shared with the monitor task, under the lock
+    bool running;
+    uint32_t started_us;
+    uint32_t iteration;
+    LatencyHistogram histogram;
+    LaneStats stats;
+    StallReport report;
+  };
+
+  static void task_main(void *arg);
+  void check(uint32_t now_us);
+  void capture(Lane &lane, uint32_t iteration);
+
+  Lane lanes[Constants::Watchdog::MAX_LANES] = {};
+  volatile uint8_t lane_count = 0;
+  TaskHandle_t task = nullptr;
+  portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+};
+
+extern StallMonitor stall_monitor;
+
+#endif // STALL_MONITOR_H
@@ -0,0 +1,152 @@
+/**
+ * WS2812 status LED animations on the RMT peripheral - see status_led.h
+ */
+
+#include "status_led.h"
+
+#include "constants.h"
+
+StatusLed status_led;
+
+namespace {
+
+const rmt_channel_t CHANNEL = RMT_CHANNEL_0;
+const int BITS_PER_PIXEL = 24;
+
+// 80 MHz APB / 2 = 25 ns per RMT tick; WS2812 bit timings in ticks
+const uint8_t CLOCK_DIVIDER = 2;
+const uint16_t T0H = 16; // 0.40 us
+const uint16_t T0L = 34; // 0.85 us
+const uint16_t T1H = 32; // 0.80 us
+const uint16_t T1L = 18; // 0.45 us
+
+enum class Shape : uint8_t { Steady, Breathe, Pulse, Blink };
+
+struct Animation {
+  uint8_t red, green, blue;
+  Shape shape;
+  uint8_t steps;
+  uint16_t step_ms;
+};
+
+// Indexed by LedPattern
+const Animation ANIMATIONS[] = {
+    {0, 0, 0, Shape::Steady, 1, 0},       // Off
+    {0, 0, 255, Shape::Breathe, 16, 125}, // Advertising: 2 s cycle
+    {0, 255, 0, Shape::Steady, 1, 0},     // Connected
+    {0, 255, 255, Shape::Pulse, 8, 40},   // Streaming
+    {255, 160, 0, Shape::Blink, 2, 500},  // LowBattery
+    {255, 0, 0, Shape::Blink, 2, 150},    // Error
+};
+static_assert(sizeof(ANIMATIONS) / sizeof(ANIMATIONS[0]) ==
+                  static_cast<size_t>(LedPattern::Count),
+              "one animation per LedPattern");
+
+const int MAX_FRAMES = 32;
+rmt_item32_t frame_pool[MAX_FRAMES][BITS_PER_PIXEL];
+uint8_t first_frame[static_cast<int>(LedPattern::Count)];
+
+// Brightness of one animation step, 0-255
+uint8_t level(const Animation &animation, int step) {
+  int steps = animation.steps;
+  switch (animation.shape) {
+  case Shape::Breathe: {
+    int half = steps / 2;
+    int distance = step < half ? step : steps - step;
+    return 16 + 239 * distance / half; // Never fully dark
+  }
+  case Shape::Pulse:
+    return 255 * (steps - step) / steps;
+  case Shape::Blink:
+    return step < steps / 2 ? 255 : 0;
+  default:
+    return 255;
+  }
+}
+
+void encode(uint8_t red, uint8_t green, uint8_t blue, rmt_item32_t *out) {
+  // WS2812 expects green, red, blue, most significant bit first
+  uint32_t grb = (green << 16) | (red << 8) | blue;
+  for (int i = 0; i < BITS_PER_PIXEL; i++) {
+    bool one = grb & (1u << (BITS_PER_PIXEL - 1 - i));
+    out[i].level0 = 1;
+    out[i].duration0 = one ? T1H : T0H;
+    out[i].level1 = 0;
+    out[i].duration1 = one ? T1L : T0L;
+  }
+}
+
+uint8_t scale(uint8_t channel, uint8_t step_level) {
+  return channel * step_level / 255 * Constants::Led::MAX_BRIGHTNESS / 255;
+}
+
+} // namespace
+
+bool StatusLed::begin(int pin) {
+  if (pin < 0) {
+    return false;
+  }
+
+  rmt_config_t config =
+      RMT_DEFAULT_CONFIG_TX(static_cast<gpio_num_t>(pin), CHANNEL);
+  config.clk_div = CLOCK_DIVIDER;
+  if (rmt_config(&config) != ESP_OK ||
+      rmt_driver_install(CHANNEL, 0, 0) != ESP_OK) {
+    Serial.println("⚠️ Status LED: RMT channel unavailable");
+    return false;
+  }
+
+  // All animation frames are RMT symbols from here on
+  int next = 0;
+  for (int p = 0; p < static_cast<int>(LedPattern::Count); p++) {
+    const Animation &animation = ANIMATIONS[p];
+    first_frame[p] = next;
+    for (int step = 0; step < animation.steps && next < MAX_FRAMES; step++) {
+      uint8_t step_level = level(animation, step);
+      encode(scale(animation.red, step_level),
+             scale(animation.green, step_level),
+             scale(animation.blue, step_level), frame_pool[next++]);
+    }
+  }
+
+  esp_timer_create_args_t args = {};
+  args.callback = on_tick;
+  args.arg = this;
+  args.name = "status_led";
+  if (esp_timer_create(&args, &timer) != ESP_OK) {
+    return false;
+  }
+
+  ready = true;
+  send(first_frame[static_cast<int>(LedPattern::Off)]);
+  return true;
+}
+
+void StatusLed::set(LedPattern pattern) {
+  if (!ready || pattern == current) {
+    return;
+  }
+  esp_timer_stop(timer); // Not running for single-frame patterns
+  current = pattern;
+  step = 0;
+
+  const Animation &animation = ANIMATIONS[static_cast<int>(pattern)];
+  send(first_frame[static_cast<int>(pattern)]);
+  if (animation.steps > 1) {
+    esp_timer_start_periodic(timer, animation.step_ms * 1000ULL);
+  }
+}
+
+// esp_timer task: one precomputed frame per step, no encoding work
+void StatusLed::on_tick(void *arg) {
+  StatusLed *self = static_cast<StatusLed *>(arg);
+  int p = static_cast<int>(self->current);
+  self->step = (self->step + 1) % ANIMATIONS[p].steps;
+  self->send(first_frame[p] + self->step);
+}
+
+void StatusLed::send(uint8_t frame) {
+  // Returns at once; the RMT peripheral clocks the 24 bits out (~30 us)
+  rmt_write_items(CHANNEL, frame_pool[frame], BITS_PER_PIXEL, false);
+  frames++;
+}
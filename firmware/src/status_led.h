@@ -0,0 +1,53 @@
+/**
+ * WS2812 status LED animations on the RMT peripheral
+ *
+ * Every frame of every animation is converted to RMT symbols once in
+ * begin(). Afterwards an esp_timer steps through the current animation and
+ * hands the next precomputed frame to rmt_write_items() without waiting, so
+ * the RMT hardware clocks the bits out while the CPU does nothing. Unlike
+ * Adafruit_NeoPixel::show() this never disables interrupts, so BLE and
+ * display flushes are not disturbed.
+ *
+ * The stock board has no pixel: set -DSTATUS_LED_PIN=<gpio> to enable.
+ */
+
+#ifndef STATUS_LED_H
+#define STATUS_LED_H
+
+#include <Arduino.h>
+#include <driver/rmt.h>
+
+enum class LedPattern : uint8_t {
+  Off,
+  Advertising, // Slow blue breathing
+  Connected,   // Steady dim green
+  Streaming,   // Fast cyan pulse during bulk or USB transfers
+  LowBattery,  // Amber blink
+  Error,       // Fast red blink
+  Count,
+};
+
+class StatusLed {
+public:
+  // Returns false (and stays off) without a pin or RMT channel
+  bool begin(int pin);
+  // Cheap when the pattern is unchanged; call from loop()
+  void set(LedPattern pattern);
+
+  LedPattern pattern() const { return current; }
+  uint32_t frames_sent() const { return frames; }
+
+private:
+  static void on_tick(void *arg);
+  void send(uint8_t frame);
+
+  esp_timer_handle_t timer = nullptr;
+  bool ready = false;
+  LedPattern current = LedPattern::Off;
+  uint8_t step = 0;
+  volatile uint32_t frames = 0;
+};
+
+extern StatusLed status_led;
+
+#endif // STATUS_LED_H
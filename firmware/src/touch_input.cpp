@@ -0,0 +1,112 @@
+/**
+ * Interrupt-driven touch reads with a swipe gesture layer - see
+ * touch_input.h
+ */
+
+#include "touch_input.h"
+
+#include "constants.h"
+#include "ui_events.h"
+
+TouchInput touch_input;
+
+bool TouchInput::begin(uint8_t irq_pin) {
+  for (lv_indev_t *i = lv_indev_get_next(nullptr); i != nullptr;
+       i = lv_indev_get_next(i)) {
+    if (lv_indev_get_type(i) == LV_INDEV_TYPE_POINTER) {
+      indev = i;
+      break;
+    }
+  }
+  if (indev == nullptr) {
+    return false;
+  }
+
+  // Stops LVGL's read timer; reads now happen only from service()
+  lv_indev_set_mode(indev, LV_INDEV_MODE_EVENT);
+  pinMode(irq_pin, INPUT_PULLUP);
+  attachInterruptArg(irq_pin, on_irq, this, FALLING);
+
+  lv_obj_add_event_cb(lv_screen_active(), on_gesture, LV_EVENT_GESTURE, this);
+  started_ms = millis();
+  return true;
+}
+
+void IRAM_ATTR TouchInput::on_irq(void *arg) {
+  TouchInput *self = static_cast<TouchInput *>(arg);
+  self->irq_us = esp_timer_get_time();
+  self->irq_count++;
+  self->irq_pending = true;
+}
+
+void TouchInput::service(uint32_t now_ms) {
+  if (indev == nullptr) {
+    return;
+  }
+
+  bool irq = irq_pending;
+  bool idle_due = now_ms - last_read_ms >= Constants::Touch::IDLE_READ_MS;
+  bool tracking = pressed && now_ms - last_read_ms >= Constants::Touch::POLL_MS;
+  if (!irq && !tracking && !idle_due) {
+    return;
+  }
+
+  uint32_t start_us = esp_timer_get_time();
+  if (irq) {
+    irq_pending = false;
+    uint32_t wait_us = start_us - irq_us;
+    if (wait_us > counters.max_irq_to_read_us) {
+      counters.max_irq_to_read_us = wait_us;
+    }
+  } else if (!tracking) {
+    counters.idle_reads++;
+  }
+
+  read_us = irq ? irq_us : start_us;
+  lv_indev_read(indev);
+  counters.total_read_us += static_cast<uint32_t>(esp_timer_get_time()) -
+                            start_us;
+  counters.reads++;
+  counters.irqs = irq_count;
+  last_read_ms = now_ms;
+
+  bool now_pressed = lv_indev_get_state(indev) == LV_INDEV_STATE_PRESSED;
+  if (now_pressed && !irq && !tracking) {
+    Serial.println("⚠️ Touch seen without an interrupt, check IRQ pin");
+  }
+  pressed = now_pressed;
+}
+
+uint32_t TouchInput::polls_avoided(uint32_t now_ms) const {
+  uint32_t timer_reads = (now_ms - started_ms) / LV_DEF_REFR_PERIOD;
+  return timer_reads > counters.reads ? timer_reads - counters.reads : 0;
+}
+
+void TouchInput::on_gesture(lv_event_t *e) {
+  TouchInput *self = static_cast<TouchInput *>(lv_event_get_user_data(e));
+  uint32_t now_ms = millis();
+  // One swipe can report several gesture events before the finger lifts
+  if (now_ms - self->last_gesture_ms < Constants::Timing::TOUCH_DEBOUNCE_MS) {
+    return;
+  }
+
+  UiEventType type;
+  switch (lv_indev_get_gesture_dir(lv_indev_active())) {
+  case LV_DIR_LEFT:
+    type = UiEventType::NextMessage;
+    break;
+  case LV_DIR_RIGHT:
+    type = UiEventType::PreviousMessage;
+    break;
+  case LV_DIR_BOTTOM:
+    type = UiEventType::ShowHistory;
+    break;
+  default:
+    return;
+  }
+  self->last_gesture_ms = now_ms;
+  self->counters.gestures++;
+  // Latency is measured from the last interrupt of the swipe
+  ui_events.post(type, UiEventSource::Touch, self->irq_us);
+  lv_indev_wait_release(lv_indev_active());
+}
@@ -0,0 +1,64 @@
+/**
+ * Interrupt-driven touch reads with a swipe gesture layer
+ *
+ * LV_Helper registers the touch controller as a timer-polled LVGL indev,
+ * which costs an I2C read every refresh period even when nobody touches
+ * the screen. This switches that indev to LV_INDEV_MODE_EVENT and reads it
+ * only when the controller raises its interrupt line, then every POLL_MS
+ * while a finger stays down so drags and gestures track smoothly. A slow
+ * idle read is kept as a safety net in case the interrupt is not wired.
+ *
+ * LVGL's own gesture detection feeds the UI event queue:
+ * swipe left / right for next / previous message, swipe down for history.
+ */
+
+#ifndef TOUCH_INPUT_H
+#define TOUCH_INPUT_H
+
+#include <Arduino.h>
+#include <lvgl.h>
+
+struct TouchStats {
+  uint32_t irqs;
+  uint32_t reads;
+  uint32_t idle_reads; // Safety-net reads without an interrupt
+  uint32_t total_read_us;
+  uint32_t max_irq_to_read_us;
+  uint32_t gestures;
+};
+
+class TouchInput {
+public:
+  // Takes over the pointer indev created by LV_Helper; call after the UI
+  // is set up. Returns false when the board has no touch controller.
+  bool begin(uint8_t irq_pin);
+  void service(uint32_t now_ms);
+
+  // Interrupt (or read) time of the latest read, esp_timer clock. LVGL
+  // raises CLICKED from inside the read that saw the finger lift, so in a
+  // click handler this is the release.
+  uint32_t input_us() const { return read_us; }
+
+  // Reads a timer-polled indev would have made that were skipped
+  uint32_t polls_avoided(uint32_t now_ms) const;
+  const TouchStats &stats() const { return counters; }
+
+private:
+  static void IRAM_ATTR on_irq(void *arg);
+  static void on_gesture(lv_event_t *e);
+
+  lv_indev_t *indev = nullptr;
+  volatile bool irq_pending = false;
+  volatile uint32_t irq_us = 0;
+  volatile uint32_t irq_count = 0;
+  bool pressed = false;
+  uint32_t read_us = 0;
+  uint32_t started_ms = 0;
+  uint32_t last_read_ms = 0;
+  uint32_t last_gesture_ms = 0;
+  TouchStats counters = {};
+};
+
+extern TouchInput touch_input;
+
+#endif // TOUCH_INPUT_H
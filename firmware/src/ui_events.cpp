@@ -0,0 +1,40 @@
+/**
+ * UI event queue shared by the physical input paths - see ui_events.h
+ */
+
+#include "ui_events.h"
+
+#include "constants.h"
+
+UiEventQueue ui_events;
+
+void UiEventQueue::begin() {
+  queue = xQueueCreate(Constants::UI::EVENT_QUEUE_DEPTH, sizeof(UiEvent));
+}
+
+bool UiEventQueue::post(UiEventType type, UiEventSource source,
+                        uint32_t input_us) {
+  UiEvent event = {type, source, input_us,
+                   static_cast<uint32_t>(esp_timer_get_time())};
+  if (queue == nullptr || xQueueSend(queue, &event, 0) != pdTRUE) {
+    counters.dropped++;
+    return false;
+  }
+  counters.posted++;
+  return true;
+}
+
+bool UiEventQueue::next(UiEvent &out) {
+  return queue != nullptr && xQueueReceive(queue, &out, 0) == pdTRUE;
+}
+
+void UiEventQueue::complete(const UiEvent &event) {
+  uint32_t now_us = esp_timer_get_time();
+  uint32_t latency = now_us - event.input_us;
+  counters.handled++;
+  counters.total_recognize_us += event.posted_us - event.input_us;
+  counters.total_dispatch_us += now_us - event.posted_us;
+  if (latency > counters.max_latency_us) {
+    counters.max_latency_us = latency;
+  }
+}
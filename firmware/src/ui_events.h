@@ -0,0 +1,60 @@
+/**
+ * UI event queue shared by the physical input paths
+ *
+ * Button (and touch gesture) recognizers run in their own tasks and post
+ * high-level events here; loop() drains the queue and owns every LVGL call
+ * (made under lv_lock(), as LVGL's draw tasks render in parallel).
+ * Each event carries the time of the input edge that completed it, so the
+ * queue can report how long recognition and dispatch took.
+ */
+
+#ifndef UI_EVENTS_H
+#define UI_EVENTS_H
+
+#include <Arduino.h>
+
+enum class UiEventType : uint8_t {
+  NextMessage,
+  PreviousMessage,
+  QuickAction,
+  ShowHistory,
+};
+enum class UiEventSource : uint8_t { Button, Touch };
+
+struct UiEvent {
+  UiEventType type;
+  UiEventSource source;
+  uint32_t input_us;  // Input edge (esp_timer clock)
+  uint32_t posted_us; // Gesture recognized and queued
+};
+
+struct UiEventStats {
+  uint32_t posted;
+  uint32_t dropped; // Queue full
+  uint32_t handled;
+  uint32_t total_recognize_us; // Input edge to queued
+  uint32_t total_dispatch_us;  // Queued to handled in loop()
+  uint32_t max_latency_us;     // Input edge to handled
+};
+
+class UiEventQueue {
+public:
+  void begin();
+
+  // Task context only (not ISR)
+  bool post(UiEventType type, UiEventSource source, uint32_t input_us);
+
+  bool next(UiEvent &out);
+  // Called once the event's UI change has been applied
+  void complete(const UiEvent &event);
+
+  const UiEventStats &stats() const { return counters; }
+
+private:
+  QueueHandle_t queue = nullptr;
+  UiEventStats counters = {};
+};
+
+extern UiEventQueue ui_events;
+
+#endif // UI_EVENTS_H
@@ -0,0 +1,48 @@
+/**
+ * Reactive UI state store - see ui_state.h
+ */
+
+#include "ui_state.h"
+
+UiState ui_state;
+
+void UiState::begin(uint8_t brightness) {
+  lv_subject_init_int(subject(UiField::Peers), 0);
+  lv_subject_init_int(subject(UiField::Battery), 100);
+  lv_subject_init_int(subject(UiField::Brightness), brightness);
+  lv_subject_init_int(subject(UiField::MessageIndex), 0);
+  lv_subject_init_int(subject(UiField::Messages), 0);
+
+  // Store-wide observer feeding the change mask; adding it calls it once
+  for (lv_subject_t &field : subjects) {
+    lv_subject_add_observer(&field, on_change, this);
+  }
+  changes = 0;
+}
+
+bool UiState::set(UiField field, int32_t value) {
+  // lv_subject_set_int() notifies even when the value is the same
+  if (lv_subject_get_int(subject(field)) == value) {
+    return false;
+  }
+  lv_subject_set_int(subject(field), value);
+  return true;
+}
+
+int32_t UiState::get(UiField field) const {
+  return lv_subject_get_int(
+      const_cast<lv_subject_t *>(&subjects[static_cast<uint8_t>(field)]));
+}
+
+void UiState::notify(UiField field) { lv_subject_notify(subject(field)); }
+
+uint32_t UiState::take_changes() {
+  uint32_t taken = changes;
+  changes = 0;
+  return taken;
+}
+
+void UiState::on_change(lv_observer_t *observer, lv_subject_t *subject) {
+  UiState *state = static_cast<UiState *>(lv_observer_get_user_data(observer));
+  state->changes |= 1u << (subject - state->subjects);
+}
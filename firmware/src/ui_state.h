@@ -0,0 +1,73 @@
+/**
+ * Reactive UI state store
+ *
+ * The values the panel shows (connected peers, battery, brightness, the
+ * message on screen) live in LVGL subjects instead of loose globals, and
+ * widgets are bound to them as observers. Setting a value that did not
+ * change costs one compare and redraws nothing; a real change notifies the
+ * bound widgets once.
+ *
+ * Every change also sets the field's bit in a change mask that loop()
+ * collects with take_changes(): status fields (peers, battery, brightness)
+ * go to the phones as one device_status frame per pass, persisted fields are written back to the
+ * settings blob. Subjects are only touched from the loop() task, which
+ * also runs the LVGL timer handler.
+ */
+
+#ifndef UI_STATE_H
+#define UI_STATE_H
+
+#include <Arduino.h>
+#include <lvgl.h>
+
+enum class UiField : uint8_t {
+  Peers,        // Connected centrals
+  Battery,      // Percent
+  Brightness,   // Panel brightness while awake, 0-255
+  MessageIndex, // Queue slot on screen
+  Messages,     // Messages added since boot
+  Count
+};
+
+// Flag for one field in the change mask
+constexpr uint32_t field_bit(UiField field) {
+  return 1u << static_cast<uint8_t>(field);
+}
+
+class UiState {
+public:
+  // What the phones show; message changes already reach them as messages
+  static constexpr uint32_t STATUS_FIELDS = field_bit(UiField::Peers) |
+                                            field_bit(UiField::Battery) |
+                                            field_bit(UiField::Brightness);
+  static constexpr uint32_t PERSISTED_FIELDS = field_bit(UiField::Brightness);
+
+  // After lv_init(); seeds the subjects without reporting a change
+  void begin(uint8_t brightness);
+
+  // False (and nothing notified) when the value is unchanged
+  bool set(UiField field, int32_t value);
+  int32_t get(UiField field) const;
+
+  // Notifies observers without a value change, for content that moved
+  // under an unchanged value (a full message queue shifting)
+  void notify(UiField field);
+
+  // For binding widgets (lv_label_bind_text, lv_subject_add_observer_obj)
+  lv_subject_t *subject(UiField field) {
+    return &subjects[static_cast<uint8_t>(field)];
+  }
+
+  // Fields changed since the last call, as field_bit() flags
+  uint32_t take_changes();
+
+private:
+  static void on_change(lv_observer_t *observer, lv_subject_t *subject);
+
+  lv_subject_t subjects[static_cast<uint8_t>(UiField::Count)];
+  uint32_t changes = 0;
+};
+
+extern UiState ui_state;
+
+#endif // UI_STATE_H
@@ -0,0 +1,99 @@
+/**
+ * Framed transport on the USB-CDC console - see usb_link.h
+ */
+
+#include "usb_link.h"
+
+#include "protocol.h"
+
+UsbLink usb_link;
+
+bool UsbLink::host_attached() const {
+  return seen_host && millis() - last_rx_ms < Constants::Usb::HOST_TIMEOUT_MS;
+}
+
+bool UsbLink::next_inbound(FrameKind &kind, char *out, size_t capacity,
+                           size_t &length) {
+  // Bounded per pass so a bulk upload cannot starve LVGL and BLE
+  for (int budget = Constants::Usb::BYTES_PER_LOOP;
+       budget > 0 && Serial.available() > 0; budget--) {
+    if (decoder.feed(Serial.read()) != FeedResult::Frame) {
+      continue;
+    }
+    last_rx_ms = millis();
+    seen_host = true;
+
+    if (decoder.kind() == FrameKind::AssetData) {
+      on_asset_data(decoder.body(), decoder.body_length());
+      continue;
+    }
+    kind = decoder.kind();
+    length = decoder.body_length();
+    if ((kind != FrameKind::Json && kind != FrameKind::Binary) ||
+        length + 1 > capacity) {
+      continue;
+    }
+    memcpy(out, decoder.body(), length);
+    out[length] = '\0';
+    return true;
+  }
+  return false;
+}
+
+bool UsbLink::send_payload(FrameKind kind, const uint8_t *body,
+                           size_t length) {
+  static uint8_t frame[Constants::Usb::MAX_ENCODED];
+
+  size_t encoded = encode_frame(kind, body, length, frame, sizeof(frame));
+  if (encoded == 0) {
+    Serial.println("⚠️ USB frame too large, dropped");
+    return false;
+  }
+  // Leading delimiter ends any debug text the host is still collecting
+  Serial.write(static_cast<uint8_t>(0x00));
+  return Serial.write(frame, encoded) == encoded;
+}
+
+bool UsbLink::begin_asset(BulkTarget target, const char *name, size_t size) {
+  if (asset_active) {
+    store.end_upload(false);
+  }
+  asset_active = store.begin_upload(target, name, size);
+  asset_ok = asset_active;
+  asset_size = size;
+  asset_bytes = 0;
+  return asset_active;
+}
+
+void UsbLink::on_asset_data(const uint8_t *data, size_t length) {
+  if (!asset_active || !asset_ok) {
+    return;
+  }
+  if (asset_bytes + length > asset_size ||
+      !store.write_upload(data, length)) {
+    asset_ok = false; // Reported by end_asset; remaining chunks are ignored
+    return;
+  }
+  asset_bytes += length;
+
+  // Acknowledge each chunk; the host keeps a small window in flight so the
+  // CDC receive buffer never overflows while flash writes are in progress
+  Protocol::Message ack{};
+  ack.type = Protocol::MessageType::AssetAck;
+  ack.has_seq = true;
+  ack.seq = next_seq();
+  ack.body.status.ok = true;
+  ack.body.status.bytes = asset_bytes;
+  char body[64];
+  size_t length = Protocol::encode_json(ack, body, sizeof(body));
+  send_payload(FrameKind::Json, reinterpret_cast<const uint8_t *>(body),
+               length);
+}
+
+bool UsbLink::end_asset() {
+  if (!asset_active) {
+    return false;
+  }
+  asset_active = false;
+  return store.end_upload(asset_ok && asset_bytes == asset_size);
+}
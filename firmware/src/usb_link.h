@@ -0,0 +1,60 @@
+/**
+ * Framed transport on the USB-CDC console
+ *
+ * Carries the same protocol as BLE inside frame_codec frames, so a host
+ * CLI (tools/host_cli) can drive the device at USB speed with no phone:
+ * commands, metrics, benchmarks and asset uploads. Debug prints keep using
+ * the same port; the host tells them apart from frames by the CRC. The host
+ * counts as attached while it has sent a valid frame recently, and only then
+ * are broadcasts mirrored to it. Inbound messages may use either the JSON or
+ * the binary encoding from protocol.h; replies are always JSON.
+ */
+
+#ifndef USB_LINK_H
+#define USB_LINK_H
+
+#include <Arduino.h>
+
+#include "device_store.h"
+#include "frame_codec.h"
+
+// Peer id for the USB host, next to the BLE session indices
+static const int8_t USB_PEER = -2;
+
+class UsbLink {
+public:
+  // Reads pending USB bytes; true with one complete message in out. JSON
+  // bodies are NUL-terminated, binary ones are not.
+  bool next_inbound(FrameKind &kind, char *out, size_t capacity,
+                    size_t &length);
+  uint32_t next_seq() { return tx_seq++; }
+  bool send_payload(FrameKind kind, const uint8_t *body, size_t length);
+
+  // Chunked asset upload: asset_begin, AssetData frames, asset_end
+  bool begin_asset(BulkTarget target, const char *name, size_t size);
+  bool end_asset();
+  size_t asset_received() const { return asset_bytes; }
+  bool asset_in_progress() const { return asset_active; }
+  bool restart_pending() const { return store.firmware_ready(); }
+
+  bool host_attached() const;
+  const FrameStats &stats() const { return decoder.stats(); }
+
+private:
+  void on_asset_data(const uint8_t *data, size_t length);
+
+  FrameDecoder decoder;
+  DeviceStore store;
+  uint32_t last_rx_ms = 0;
+  bool seen_host = false;
+  uint32_t tx_seq = 0;
+
+  bool asset_active = false;
+  bool asset_ok = false;
+  size_t asset_size = 0;
+  size_t asset_bytes = 0;
+};
+
+extern UsbLink usb_link;
+
+#endif // USB_LINK_H
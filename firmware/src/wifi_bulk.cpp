@@ -0,0 +1,136 @@
+/**
+ * On-demand Wi-Fi soft-AP for bulk transfers - see wifi_bulk.h
+ */
+
+#include "wifi_bulk.h"
+
+WifiBulk wifi_bulk;
+
+namespace {
+
+// WiFiClient with the blocking-with-timeout semantics BulkServer expects
+class ClientStream : public BulkStream {
+public:
+  explicit ClientStream(WiFiClient &client) : client(client) {}
+
+  size_t read(uint8_t *buffer, size_t length) override {
+    uint32_t start = millis();
+    while (client.connected() || client.available() > 0) {
+      int n = client.read(buffer, length);
+      if (n > 0) {
+        return n;
+      }
+      if (millis() - start > Constants::WiFi::BULK_IO_TIMEOUT_MS) {
+        break;
+      }
+      delay(1);
+    }
+    return 0;
+  }
+
+  size_t write(const uint8_t *data, size_t length) override {
+    return client.write(data, length);
+  }
+
+private:
+  WiFiClient &client;
+};
+
+} // namespace
+
+bool WifiBulk::start(HistoryReader reader) {
+  if (running) {
+    return true;
+  }
+
+  // Fresh token per session so a stale phone cannot reuse an old one
+  char token[Constants::WiFi::BULK_TOKEN_LENGTH + 1];
+  for (int i = 0; i < Constants::WiFi::BULK_TOKEN_LENGTH; i += 8) {
+    snprintf(token + i, sizeof(token) - i, "%08x",
+             static_cast<unsigned>(esp_random()));
+  }
+  server.begin(token);
+
+  WiFi.mode(WIFI_AP);
+  if (!WiFi.softAP(Constants::WiFi::AP_SSID, Constants::WiFi::AP_PASSWORD)) {
+    Serial.println("⚠️ Soft-AP failed to start");
+    WiFi.mode(WIFI_OFF);
+    return false;
+  }
+  listener.begin();
+
+  store = DeviceStore(reader);
+  last_activity_ms = millis();
+  ended = false;
+  running = true;
+  if (task == nullptr) {
+    xTaskCreatePinnedToCore(task_main, "wifi_bulk",
+                            Constants::WiFi::BULK_TASK_STACK_SIZE, this,
+                            Constants::WiFi::BULK_TASK_PRIORITY, &task,
+                            Constants::WiFi::BULK_TASK_CORE);
+  }
+  xTaskNotifyGive(task);
+  IPAddress ip = WiFi.softAPIP();
+  Serial.printf("📶 Bulk transfer AP up: %s at %u.%u.%u.%u:%d\n",
+                Constants::WiFi::AP_SSID, ip[0], ip[1], ip[2], ip[3],
+                Constants::WiFi::BULK_PORT);
+  return true;
+}
+
+void WifiBulk::stop() {
+  if (!running) {
+    return;
+  }
+  listener.end();
+  WiFi.softAPdisconnect(true);
+  WiFi.mode(WIFI_OFF);
+  running = false;
+
+  const BulkStats &stats = server.stats();
+  Serial.printf("📶 Bulk transfer AP off: %u requests | %u rejected | "
+                "%u bytes in | %u bytes out\n",
+                stats.requests, stats.rejected, stats.bytes_in,
+                stats.bytes_out);
+}
+
+bool WifiBulk::poll() {
+  if (!running || !ended) {
+    return false;
+  }
+  stop();
+  return true;
+}
+
+// Sleeps between sessions; start() wakes it
+void WifiBulk::task_main(void *arg) {
+  WifiBulk *self = static_cast<WifiBulk *>(arg);
+  while (true) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    self->serve_session();
+  }
+}
+
+// Accepts and serves requests until the session ends. A request blocks
+// only this task; the radio is turned off by loop() through poll().
+void WifiBulk::serve_session() {
+  while (true) {
+    WiFiClient client = listener.available();
+    if (!client) {
+      if (millis() - last_activity_ms > Constants::WiFi::BULK_IDLE_TIMEOUT_MS) {
+        Serial.println("📶 Bulk transfer idle, turning Wi-Fi off");
+        break;
+      }
+      vTaskDelay(pdMS_TO_TICKS(Constants::WiFi::BULK_ACCEPT_POLL_MS));
+      continue;
+    }
+
+    ClientStream stream(client);
+    BulkResult result = server.serve(stream, store);
+    client.stop();
+    last_activity_ms = millis();
+    if (result == BulkResult::Done || store.firmware_ready()) {
+      break;
+    }
+  }
+  ended = true;
+}
@@ -0,0 +1,57 @@
+/**
+ * On-demand Wi-Fi soft-AP for bulk transfers
+ *
+ * The radio stays off until the phone asks for a transfer over BLE
+ * ("bulk_start"). The device then brings up its soft-AP with a one-time
+ * token, serves the HTTP endpoint from bulk_http.h, and turns Wi-Fi back off
+ * after "POST /done" or a minute without requests. BLE stays connected the
+ * whole time and remains the control channel.
+ *
+ * One request can run for many seconds (a multi-megabyte OTA image), so
+ * requests are served by a task of their own, outside the LVGL lock;
+ * rendering, input and the BLE TX queues carry on in loop() meanwhile.
+ * loop() only sees the end of the session, through poll().
+ */
+
+#ifndef WIFI_BULK_H
+#define WIFI_BULK_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+
+#include "bulk_http.h"
+#include "device_store.h"
+
+class WifiBulk {
+public:
+  bool start(HistoryReader history);
+
+  // Turns Wi-Fi off once the serving task ended the session; returns true
+  // when the session just ended
+  bool poll();
+
+  bool active() const { return running; }
+  bool restart_pending() const { return store.firmware_ready(); }
+  const char *token() const { return server.token(); }
+  IPAddress ip() const { return WiFi.softAPIP(); }
+  uint32_t bytes_transferred() const {
+    return server.stats().bytes_in + server.stats().bytes_out;
+  }
+
+private:
+  static void task_main(void *arg);
+  void serve_session();
+  void stop();
+
+  BulkServer server;
+  WiFiServer listener{Constants::WiFi::BULK_PORT};
+  DeviceStore store;
+  TaskHandle_t task = nullptr;
+  uint32_t last_activity_ms = 0;
+  bool running = false;
+  volatile bool ended = false; // Set by the task, handled by poll()
+};
+
+extern WifiBulk wifi_bulk;
+
+#endif // WIFI_BULK_H
@@ -0,0 +1,141 @@
+/**
+ * Host-side harness for the Wi-Fi bulk endpoint
+ *
+ * Runs the firmware's BulkServer (src/bulk_http.cpp) behind a POSIX socket
+ * on 127.0.0.1 so uploads, history export and session end can be exercised
+ * with curl on a Linux machine, without a device or soft-AP:
+ *
+ *   make bulk-host
+ *   ./build/bulk_host 8080 /tmp/bulk localtest
+ *   curl -H "Authorization: Bearer localtest" localhost:8080/history
+ *   curl -T logo.bin -H "Authorization: Bearer localtest" \
+ *        localhost:8080/files/logo.bin
+ *   curl -X POST -H "Authorization: Bearer localtest" localhost:8080/done
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "bulk_http.h"
+
+namespace {
+
+class SocketStream : public BulkStream {
+public:
+  explicit SocketStream(int fd) : fd(fd) {}
+
+  size_t read(uint8_t *buffer, size_t length) override {
+    pollfd p = {fd, POLLIN, 0};
+    if (::poll(&p, 1, Constants::WiFi::BULK_IO_TIMEOUT_MS) <= 0) {
+      return 0;
+    }
+    ssize_t n = ::recv(fd, buffer, length, 0);
+    return n > 0 ? n : 0;
+  }
+
+  size_t write(const uint8_t *data, size_t length) override {
+    ssize_t n = ::send(fd, data, length, MSG_NOSIGNAL);
+    return n > 0 ? n : 0;
+  }
+
+private:
+  int fd;
+};
+
+// Uploads land in a directory; the firmware image is kept as firmware.bin
+class DirectoryStore : public BulkStore {
+public:
+  explicit DirectoryStore(const char *directory) : directory(directory) {}
+
+  bool begin_upload(BulkTarget target, const char *name,
+                    size_t length) override {
+    snprintf(path, sizeof(path), "%s/%s", directory,
+             target == BulkTarget::Firmware ? "firmware.bin" : name);
+    file = fopen(path, "wb");
+    printf("upload %s (%zu bytes)\n", path, length);
+    return file != nullptr;
+  }
+
+  bool write_upload(const uint8_t *data, size_t length) override {
+    return fwrite(data, 1, length, file) == length;
+  }
+
+  bool end_upload(bool complete) override {
+    fclose(file);
+    file = nullptr;
+    if (!complete) {
+      remove(path);
+    }
+    return complete;
+  }
+
+  size_t read_history(size_t offset, uint8_t *out, size_t capacity) override {
+    static const char history[] = "Welcome to your AI Companion!\n"
+                                  "📱 Phone connected!\n"
+                                  "🤖 How can I help you today?\n";
+    size_t length = sizeof(history) - 1;
+    if (offset >= length) {
+      return 0;
+    }
+    size_t n = length - offset < capacity ? length - offset : capacity;
+    memcpy(out, history + offset, n);
+    return n;
+  }
+
+private:
+  const char *directory;
+  char path[512];
+  FILE *file = nullptr;
+};
+
+} // namespace
+
+int main(int argc, char **argv) {
+  int port = argc > 1 ? atoi(argv[1]) : Constants::WiFi::BULK_PORT;
+  const char *directory = argc > 2 ? argv[2] : ".";
+  const char *token = argc > 3 ? argv[3] : "localtest";
+
+  int listener = socket(AF_INET, SOCK_STREAM, 0);
+  int reuse = 1;
+  setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (bind(listener, reinterpret_cast<sockaddr *>(&address),
+           sizeof(address)) != 0 ||
+      listen(listener, 1) != 0) {
+    perror("bind");
+    return 1;
+  }
+  printf("bulk endpoint on 127.0.0.1:%d, token %s, storing in %s\n", port,
+         token, directory);
+
+  BulkServer server;
+  server.begin(token);
+  DirectoryStore store(directory);
+
+  BulkResult result = BulkResult::Served;
+  while (result != BulkResult::Done) {
+    int client = accept(listener, nullptr, nullptr);
+    if (client < 0) {
+      continue;
+    }
+    SocketStream stream(client);
+    result = server.serve(stream, store);
+    close(client);
+  }
+  close(listener);
+
+  const BulkStats &stats = server.stats();
+  printf("session done: %u requests | %u rejected | %u bytes in | "
+         "%u bytes out\n",
+         stats.requests, stats.rejected, stats.bytes_in, stats.bytes_out);
+  return 0;
+}
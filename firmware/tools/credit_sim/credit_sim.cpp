@@ -0,0 +1,155 @@
+/**
+ * Host simulation of BLE receive credit (src/credit_window.h)
+ *
+ * Models one phone writing chunked messages the way App.tsx does (chunks
+ * of up to MAX_WRITE_CHUNK, never past the granted limit, giving up after
+ * CREDIT_WAIT_MS) against the device's reassembly buffer, which loop()
+ * drains one complete message per pass. The device sends no replies, so
+ * standalone grants are the only way credit reaches the phone:
+ *
+ *   make credit-sim
+ *
+ * Scenarios:
+ *  - storm: a sender at full rate with mixed message sizes
+ *  - partial: a 100-byte message, then a 450-byte one in 200/200/50
+ *    chunks; parsing the first frees less than CREDIT_UPDATE_BYTES while
+ *    the last chunk waits for room
+ *
+ * Exits non-zero when a scenario overflows the buffer, stalls past the
+ * app's credit timeout or loses a message.
+ */
+
+#include <stdio.h>
+
+#include "credit_window.h"
+
+namespace {
+
+const uint32_t LOOP_MS = 5;           // loop() pass; parses one message
+const uint32_t CREDIT_WAIT_MS = 5000; // App.tsx gives up after this
+const uint32_t RUN_MS = 60000;
+const int WRITES_PER_PASS = 4; // Write-without-response, back to back
+const int MAX_MESSAGES = 64;
+
+struct Result {
+  int delivered;
+  int overflows;
+  uint32_t longest_wait_ms;
+  uint32_t grants;
+  uint32_t finished_ms;
+};
+
+Result run(const uint16_t *sizes, int count) {
+  Result result = {};
+  CreditWindow credit{};
+
+  // Device: bytes held, and the complete messages at the front
+  uint16_t buffered = 0;
+  uint16_t complete[MAX_MESSAGES];
+  int complete_head = 0;
+  int complete_count = 0;
+
+  // Phone: next message and offset in it, bytes sent, granted limit
+  int message = 0;
+  uint16_t offset = 0;
+  uint16_t sent = 0;
+  uint16_t limit = 0;
+  bool has_limit = false;
+  uint32_t waiting_since = 0;
+  bool waiting = false;
+
+  for (uint32_t now = 0; now < RUN_MS; now += LOOP_MS) {
+    // Device pass: parse one message, then grant if worthwhile
+    if (complete_count > 0) {
+      buffered -= complete[complete_head];
+      complete_head = (complete_head + 1) % MAX_MESSAGES;
+      complete_count--;
+      result.delivered++;
+      result.finished_ms = now;
+    }
+    uint16_t free_space = Constants::Bluetooth::RX_BUFFER_SIZE - buffered;
+    if (credit.grant_due(free_space, true)) {
+      uint16_t granted = credit.limit(free_space, true);
+      credit.advertise(granted);
+      limit = granted;
+      has_limit = true;
+      result.grants++;
+    }
+    if (message == count && complete_count == 0) {
+      break;
+    }
+
+    // Phone: as many chunks as the credit allows
+    for (int w = 0; w < WRITES_PER_PASS && message < count; w++) {
+      uint16_t left = sizes[message] - offset;
+      uint16_t chunk = left < Constants::Bluetooth::MAX_WRITE_CHUNK
+                           ? left
+                           : Constants::Bluetooth::MAX_WRITE_CHUNK;
+      if (has_limit &&
+          static_cast<int16_t>(limit - static_cast<uint16_t>(sent + chunk)) <
+              0) {
+        if (!waiting) {
+          waiting = true;
+          waiting_since = now;
+        }
+        break;
+      }
+      if (waiting) {
+        uint32_t waited = now - waiting_since;
+        if (waited > result.longest_wait_ms) {
+          result.longest_wait_ms = waited;
+        }
+        waiting = false;
+      }
+
+      sent += chunk;
+      offset += chunk;
+      if (buffered + chunk > Constants::Bluetooth::RX_BUFFER_SIZE) {
+        result.overflows++;
+        return result;
+      }
+      buffered += chunk;
+      credit.received(chunk);
+      if (offset == sizes[message]) {
+        complete[(complete_head + complete_count) % MAX_MESSAGES] = offset;
+        complete_count++;
+        message++;
+        offset = 0;
+      }
+    }
+    if (waiting && now - waiting_since > CREDIT_WAIT_MS) {
+      result.longest_wait_ms = now - waiting_since;
+      return result;
+    }
+  }
+  return result;
+}
+
+bool report(const char *name, const Result &result, int expected) {
+  bool ok = result.delivered == expected && result.overflows == 0 &&
+            result.longest_wait_ms <= CREDIT_WAIT_MS;
+  printf("%-8s %s | delivered %d/%d | overflows %d | %u grants | longest "
+         "credit wait %u ms | done at %u ms\n",
+         name, ok ? "ok  " : "FAIL", result.delivered, expected,
+         result.overflows, result.grants,
+         static_cast<unsigned>(result.longest_wait_ms),
+         static_cast<unsigned>(result.finished_ms));
+  return ok;
+}
+
+} // namespace
+
+int main() {
+  // Mixed sizes up to the largest message the buffer holds
+  uint16_t storm[40];
+  uint32_t state = 0x12345678;
+  for (int i = 0; i < 40; i++) {
+    state = state * 1664525 + 1013904223;
+    storm[i] = 20 + (state >> 8) % 480;
+  }
+  const uint16_t partial[] = {100, 450};
+
+  bool ok = report("storm", run(storm, 40), 40);
+  ok = report("partial", run(partial, 2), 2) && ok;
+  return ok ? 0 : 1;
+}
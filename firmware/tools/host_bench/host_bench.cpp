@@ -0,0 +1,61 @@
+/**
+ * Host run of the pipeline benchmarks
+ *
+ * Runs the kernels from src/bench_cases.cpp on the build machine and prints
+ * one JSON object in the same shape as the device's bench_result, so
+ * scripts/profile_bench.py can record host and device timings side by side:
+ *
+ *   host_bench [rounds]
+ *
+ * Each kernel runs `rounds` times (default 20) and the fastest round is
+ * reported, which filters out scheduler noise on a desktop OS. The fast
+ * draw kernels are first checked against their references; any mismatch
+ * fails the run with exit status 1 before anything is timed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+
+#include "bench_cases.h"
+
+int main(int argc, char **argv) {
+  int rounds = argc > 1 ? atoi(argv[1]) : 20;
+  if (rounds < 1) {
+    fprintf(stderr, "usage: host_bench [rounds]\n");
+    return 2;
+  }
+
+  uint32_t mismatches = BenchCases::check_draw_kernels();
+  if (mismatches > 0) {
+    fprintf(stderr, "draw kernels differ from reference in %u cases\n",
+            static_cast<unsigned>(mismatches));
+    return 1;
+  }
+
+  printf("{");
+  for (size_t i = 0; i < BenchCases::CASE_COUNT; i++) {
+    const BenchCases::Case &benchmark = BenchCases::CASES[i];
+    long best_ns = -1;
+    uint32_t bytes = 0;
+    for (int round = 0; round < rounds; round++) {
+      auto start = std::chrono::steady_clock::now();
+      bytes = benchmark.run(BenchCases::ITERATIONS);
+      long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+      if (best_ns < 0 || ns < best_ns) {
+        best_ns = ns;
+      }
+    }
+    printf("%s\"%s\":{\"iterations\":%d,\"ns_per_op\":%ld,\"kb_per_s\":%ld}",
+           i > 0 ? "," : "", benchmark.name, BenchCases::ITERATIONS,
+           best_ns / BenchCases::ITERATIONS,
+           best_ns > 0 ? static_cast<long>(bytes * 1000000000ull / best_ns /
+                                           1024)
+                       : 0);
+  }
+  printf("}\n");
+  return 0;
+}
@@ -0,0 +1,254 @@
+/**
+ * Host control CLI for the USB-CDC framed transport
+ *
+ * Talks to the device over its USB console using the same frames as
+ * src/usb_link.cpp, so bench and factory workflows need no phone:
+ *
+ *   host_cli /dev/ttyACM0 send '{"type":"test","message":"hi"}'
+ *   host_cli /dev/ttyACM0 send-binary '{"type":"test","message":"hi"}'
+ *   host_cli /dev/ttyACM0 metrics
+ *   host_cli /dev/ttyACM0 bench [name|all]
+ *   host_cli /dev/ttyACM0 upload <file> [name]
+ *   host_cli /dev/ttyACM0 ota <firmware.bin>
+ *   host_cli /dev/ttyACM0 monitor
+ *
+ * Replies are printed one JSON object per line on stdout; the device's debug
+ * output arrives on the same port and is passed through to stderr.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "frame_codec.h"
+#include "protocol.h"
+
+namespace {
+
+const int REPLY_TIMEOUT_MS = 10000;
+const int ASSET_CHUNK = 1000; // Fits a frame with room for the kind byte
+const int ASSET_WINDOW = 2;   // Chunks in flight; device RX buffer is 4 KB
+
+int serial_fd = -1;
+FrameDecoder decoder;
+char reply[Constants::Usb::MAX_PAYLOAD + 1];
+
+long now_ms() {
+  timeval tv;
+  gettimeofday(&tv, nullptr);
+  return tv.tv_sec * 1000L + tv.tv_usec / 1000;
+}
+
+bool open_port(const char *path) {
+  serial_fd = open(path, O_RDWR | O_NOCTTY);
+  if (serial_fd < 0) {
+    fprintf(stderr, "cannot open %s: %s\n", path, strerror(errno));
+    return false;
+  }
+  termios tio;
+  tcgetattr(serial_fd, &tio);
+  cfmakeraw(&tio);
+  cfsetspeed(&tio, B115200); // Ignored by USB-CDC, required by termios
+  tcsetattr(serial_fd, TCSANOW, &tio);
+  tcflush(serial_fd, TCIOFLUSH);
+  return true;
+}
+
+bool send_frame(FrameKind kind, const void *body, size_t length) {
+  uint8_t frame[Constants::Usb::MAX_ENCODED + 1];
+  frame[0] = 0x00; // Flush anything half-received on the device side
+  size_t encoded = encode_frame(kind, static_cast<const uint8_t *>(body),
+                                length, frame + 1, sizeof(frame) - 1);
+  if (encoded == 0) {
+    fprintf(stderr, "message too large for one frame\n");
+    return false;
+  }
+  return write(serial_fd, frame, encoded + 1) ==
+         static_cast<ssize_t>(encoded + 1);
+}
+
+bool send_json(const char *json) {
+  return send_frame(FrameKind::Json, json, strlen(json));
+}
+
+// Re-encodes a JSON message with the shared codec and sends it in the
+// compact binary form
+bool send_binary(const char *json) {
+  Protocol::Message message;
+  uint8_t body[Constants::Usb::MAX_PAYLOAD];
+  if (!Protocol::decode_json(json, strlen(json), message) ||
+      message.type == Protocol::MessageType::Unknown) {
+    fprintf(stderr, "not a known protocol message\n");
+    return false;
+  }
+  size_t length = Protocol::encode_binary(message, body, sizeof(body));
+  if (length == 0) {
+    fprintf(stderr, "%s has no binary form\n",
+            Protocol::type_name(message.type));
+    return false;
+  }
+  fprintf(stderr, "binary: %zu bytes (JSON: %zu)\n", length, strlen(json));
+  return send_frame(FrameKind::Binary, body, length);
+}
+
+// Waits for the next JSON frame; debug text is echoed to stderr meanwhile.
+// Bytes after a complete frame stay buffered for the next call.
+bool next_reply(int timeout_ms) {
+  static uint8_t buffer[256];
+  static ssize_t filled = 0;
+  static ssize_t consumed = 0;
+  long deadline = now_ms() + timeout_ms;
+  while (true) {
+    while (consumed < filled) {
+      FeedResult result = decoder.feed(buffer[consumed++]);
+      if (result == FeedResult::Invalid) {
+        fwrite(decoder.raw(), 1, decoder.raw_length(), stderr);
+      } else if (result == FeedResult::Frame &&
+                 decoder.kind() == FrameKind::Json) {
+        memcpy(reply, decoder.body(), decoder.body_length());
+        reply[decoder.body_length()] = '\0';
+        return true;
+      }
+    }
+
+    pollfd p = {serial_fd, POLLIN, 0};
+    long remaining = deadline - now_ms();
+    if (remaining <= 0 || poll(&p, 1, remaining) <= 0) {
+      return false;
+    }
+    filled = read(serial_fd, buffer, sizeof(buffer));
+    consumed = 0;
+    if (filled <= 0) {
+      filled = 0;
+      return false;
+    }
+  }
+}
+
+// Prints replies until one of the wanted type arrives
+bool await_type(const char *type, int timeout_ms = REPLY_TIMEOUT_MS) {
+  char needle[64];
+  snprintf(needle, sizeof(needle), "\"type\":\"%s\"", type);
+  while (next_reply(timeout_ms)) {
+    printf("%s\n", reply);
+    if (strstr(reply, needle) != nullptr) {
+      return true;
+    }
+  }
+  fprintf(stderr, "timed out waiting for %s\n", type);
+  return false;
+}
+
+int upload(const char *path, const char *name, const char *target) {
+  FILE *file = fopen(path, "rb");
+  if (file == nullptr) {
+    fprintf(stderr, "cannot open %s\n", path);
+    return 1;
+  }
+  fseek(file, 0, SEEK_END);
+  long size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+
+  char begin[160];
+  snprintf(begin, sizeof(begin),
+           "{\"type\":\"asset_begin\",\"target\":\"%s\",\"name\":\"%s\","
+           "\"size\":%ld}",
+           target, name, size);
+  if (!send_json(begin) || !await_type("asset_ack") ||
+      strstr(reply, "\"ok\":true") == nullptr) {
+    fclose(file);
+    return 1;
+  }
+
+  long start = now_ms();
+  uint8_t chunk[ASSET_CHUNK];
+  int in_flight = 0;
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+    if (in_flight == ASSET_WINDOW) {
+      if (!next_reply(REPLY_TIMEOUT_MS)) {
+        fprintf(stderr, "no ack from device\n");
+        fclose(file);
+        return 1;
+      }
+      in_flight--;
+    }
+    send_frame(FrameKind::AssetData, chunk, n);
+    in_flight++;
+  }
+  fclose(file);
+  while (in_flight-- > 0 && next_reply(REPLY_TIMEOUT_MS)) {
+  }
+
+  send_json("{\"type\":\"asset_end\"}");
+  bool ok = await_type("asset_done") && strstr(reply, "\"ok\":true");
+  long elapsed = now_ms() - start;
+  fprintf(stderr, "%ld bytes in %ld ms (%ld KB/s)\n", size, elapsed,
+          elapsed > 0 ? size * 1000 / 1024 / elapsed : 0);
+  return ok ? 0 : 1;
+}
+
+void usage() {
+  fprintf(stderr, "usage: host_cli <port> send <json> | send-binary <json> | "
+                  "metrics | bench [name] | upload <file> [name] | "
+                  "ota <file> | monitor\n");
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    usage();
+    return 2;
+  }
+  if (!open_port(argv[1])) {
+    return 1;
+  }
+
+  const char *command = argv[2];
+  if (strcmp(command, "send") == 0 && argc > 3) {
+    send_json(argv[3]);
+    return next_reply(REPLY_TIMEOUT_MS) ? (printf("%s\n", reply), 0) : 1;
+  }
+  if (strcmp(command, "send-binary") == 0 && argc > 3) {
+    if (!send_binary(argv[3])) {
+      return 1;
+    }
+    return next_reply(REPLY_TIMEOUT_MS) ? (printf("%s\n", reply), 0) : 1;
+  }
+  if (strcmp(command, "metrics") == 0) {
+    send_json("{\"type\":\"metrics\"}");
+    return await_type("metrics") ? 0 : 1;
+  }
+  if (strcmp(command, "bench") == 0) {
+    char request[96];
+    snprintf(request, sizeof(request), "{\"type\":\"bench\",\"name\":\"%s\"}",
+             argc > 3 ? argv[3] : "all");
+    send_json(request);
+    return await_type("bench_result", 60000) ? 0 : 1;
+  }
+  if (strcmp(command, "upload") == 0 && argc > 3) {
+    const char *name = argc > 4 ? argv[4] : strrchr(argv[3], '/');
+    name = name == nullptr ? argv[3] : (name[0] == '/' ? name + 1 : name);
+    return upload(argv[3], name, "file");
+  }
+  if (strcmp(command, "ota") == 0 && argc > 3) {
+    return upload(argv[3], "firmware.bin", "ota");
+  }
+  if (strcmp(command, "monitor") == 0) {
+    while (true) {
+      if (next_reply(60000)) {
+        printf("%s\n", reply);
+        fflush(stdout);
+      }
+    }
+  }
+  usage();
+  return 2;
+}
@@ -0,0 +1,78 @@
+/**
+ * Host replay of touch-to-photon latency traces
+ *
+ * Feeds the "LAT <input> <event> <render> <flush>" lines the device logs
+ * (see src/latency_probe.h) through the same LatencyProbe, so a captured
+ * serial log yields the device's distribution offline:
+ *
+ *   make latency-replay
+ *   pio device monitor | tee tap.log      # tap "Ask AI" a few dozen times
+ *   ./build/latency_replay tap.log
+ *
+ * With --refresh-ms N the render start of each sample is moved to the next
+ * N ms refresh tick after its event (render and flush time kept), to
+ * estimate what a different LVGL refresh period would change.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "latency_probe.h"
+
+namespace {
+
+void replay(FILE *in, LatencyProbe &probe, uint32_t refresh_us) {
+  char line[512];
+  while (fgets(line, sizeof(line), in) != nullptr) {
+    const char *tag = strstr(line, "LAT ");
+    LatencySample s;
+    if (tag == nullptr ||
+        sscanf(tag, "LAT %u %u %u %u", &s.input_us, &s.event_us, &s.render_us,
+               &s.flush_us) != 4) {
+      continue;
+    }
+
+    uint32_t render_us = s.render_us;
+    uint32_t flush_us = s.flush_us;
+    if (refresh_us > 0) {
+      render_us = (s.event_us / refresh_us + 1) * refresh_us;
+      flush_us = render_us + (s.flush_us - s.render_us);
+    }
+
+    LatencySample out;
+    probe.event(s.event_us, s.input_us);
+    probe.render_start(render_us);
+    probe.flush_done(flush_us, out);
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  uint32_t refresh_us = 0;
+  int first = 1;
+  if (argc > 2 && strcmp(argv[1], "--refresh-ms") == 0) {
+    refresh_us = static_cast<uint32_t>(atoi(argv[2])) * 1000;
+    first = 3;
+  }
+
+  LatencyProbe probe;
+  if (first >= argc) {
+    replay(stdin, probe, refresh_us);
+  }
+  for (int i = first; i < argc; i++) {
+    FILE *in = fopen(argv[i], "r");
+    if (in == nullptr) {
+      fprintf(stderr, "cannot open %s\n", argv[i]);
+      return 1;
+    }
+    replay(in, probe, refresh_us);
+    fclose(in);
+  }
+
+  char summary[256];
+  probe.format_summary(summary, sizeof(summary));
+  printf("%s\n", summary);
+  return probe.total().count() > 0 ? 0 : 1;
+}
@@ -0,0 +1,130 @@
+/**
+ * Host replay of a notification storm through NotificationCenter
+ *
+ * Posts STORM_SIZE notifications from STORM_APPS apps, one every
+ * STORM_GAP_MS, and drains the center once per loop() pass, on a simulated
+ * clock. The coalescing and the token bucket must turn the storm into
+ * EXPECTED_DURING_STORM label updates while it lasts and EXPECTED_DISPLAYS
+ * in all, with nothing dropped and every app shown:
+ *
+ *   make notification-storm
+ *
+ * The replay runs at several loop periods, odd ones included: a refill that
+ * loses the rounding remainder of each pass shows up there as a late last
+ * update. Exits non-zero when a count, the pacing or any invariant is off.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "notification_center.h"
+
+namespace {
+
+const int STORM_SIZE = 60;
+const int STORM_APPS = 5;
+const uint32_t STORM_GAP_MS = 100; // 60 notifications in 6 s
+const uint32_t DRAIN_MS = 30000;   // Run on after the storm until quiet
+
+// loop() passes to replay at; each drains one line at most
+const uint32_t LOOP_PERIODS_MS[] = {10, 5, 7};
+
+// Burst of BUCKET_CAPACITY, then one line per REFILL_INTERVAL_MS while the
+// storm lasts; afterwards one more for each app still pending
+const uint32_t EXPECTED_DURING_STORM = 6;
+const uint32_t EXPECTED_DISPLAYS = 10;
+const uint32_t EXPECTED_LAST_MS =
+    (EXPECTED_DISPLAYS - Constants::Notifications::BUCKET_CAPACITY) *
+    Constants::Notifications::REFILL_INTERVAL_MS;
+
+const char *const APPS[STORM_APPS] = {"Messages", "Mail", "Slack", "Calendar",
+                                      "News"};
+
+// One replay; an update may land up to one pass after its ideal time
+bool replay(uint32_t loop_ms) {
+  NotificationCenter center;
+  bool shown[STORM_APPS] = {};
+  char line[Constants::Notifications::MAX_TEXT_LENGTH + 64];
+  uint32_t last_display_ms = 0;
+  uint32_t during_storm = 0;
+  const uint32_t storm_end_ms = STORM_SIZE * STORM_GAP_MS + loop_ms;
+
+  printf("loop every %u ms\n", static_cast<unsigned>(loop_ms));
+  int posted = 0;
+  for (uint32_t now = 0; now <= STORM_SIZE * STORM_GAP_MS + DRAIN_MS;
+       now += loop_ms) {
+    while (posted < STORM_SIZE && posted * STORM_GAP_MS <= now) {
+      char text[32];
+      snprintf(text, sizeof(text), "Notification %d", posted + 1);
+      center.post(APPS[posted % STORM_APPS], "Storm", text,
+                  NotificationPriority::Normal, posted * STORM_GAP_MS);
+      posted++;
+    }
+    if (!center.next_display(line, sizeof(line), now)) {
+      continue;
+    }
+    for (int i = 0; i < STORM_APPS; i++) {
+      if (strstr(line, APPS[i]) != nullptr) {
+        shown[i] = true;
+      }
+    }
+    const char *newline = strchr(line, '\n');
+    int head = newline != nullptr ? static_cast<int>(newline - line)
+                                  : static_cast<int>(strlen(line));
+    printf("%6u ms  %.*s\n", static_cast<unsigned>(now), head, line);
+    last_display_ms = now;
+    if (now < storm_end_ms) {
+      during_storm++;
+    }
+  }
+
+  const NotificationStats &stats = center.stats();
+  printf("received %u | coalesced %u | displayed %u (%u during the storm) | "
+         "dropped %u | max pending %u ms | last update at %u ms\n",
+         stats.received, stats.coalesced, stats.displayed,
+         static_cast<unsigned>(during_storm), stats.dropped,
+         stats.max_pending_ms, static_cast<unsigned>(last_display_ms));
+
+  bool ok = true;
+  if (during_storm != EXPECTED_DURING_STORM) {
+    fprintf(stderr, "expected %u display updates during the storm, got %u\n",
+            static_cast<unsigned>(EXPECTED_DURING_STORM),
+            static_cast<unsigned>(during_storm));
+    ok = false;
+  }
+  if (stats.displayed != EXPECTED_DISPLAYS) {
+    fprintf(stderr, "expected %u display updates, got %u\n",
+            static_cast<unsigned>(EXPECTED_DISPLAYS), stats.displayed);
+    ok = false;
+  }
+  if (last_display_ms >= EXPECTED_LAST_MS + loop_ms) {
+    fprintf(stderr, "last update at %u ms, expected by %u ms: the bucket "
+                    "refills too slowly\n",
+            static_cast<unsigned>(last_display_ms),
+            static_cast<unsigned>(EXPECTED_LAST_MS));
+    ok = false;
+  }
+  if (stats.received != STORM_SIZE || stats.dropped != 0 ||
+      stats.coalesced + stats.displayed != STORM_SIZE ||
+      center.pending_apps() != 0) {
+    fprintf(stderr, "notifications lost or left pending\n");
+    ok = false;
+  }
+  for (int i = 0; i < STORM_APPS; i++) {
+    if (!shown[i]) {
+      fprintf(stderr, "%s never shown\n", APPS[i]);
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+} // namespace
+
+int main() {
+  bool ok = true;
+  for (uint32_t loop_ms : LOOP_PERIODS_MS) {
+    ok = replay(loop_ms) && ok;
+  }
+  return ok ? 0 : 1;
+}
@@ -21,6 +21,7 @@ import {
   Platform,
   PermissionsAndroid,
   TextInput,
+  Image,
 } from 'react-native';
 import {
   SafeAreaProvider,
@@ -29,6 +30,17 @@ import {
 
 // BLE imports
 import { BleManager, Device } from 'react-native-ble-plx';
+import { MirrorDecoder } from './mirror';
+import {
+  BatchItem,
+  BulkReadyMessage,
+  Channel,
+  MESSAGE_CHANNEL,
+  MessageType,
+  MirrorInfoFields,
+  ProtocolMessage,
+  TextMessage,
+} from './protocol';
 
 interface Message {
   id: string;
@@ -44,6 +56,13 @@ interface QRData {
   rxUUID: string;
 }
 
+interface DeviceConfig {
+  brightness: number;
+  device_name: string;
+  status_interval_ms: number;
+  battery_interval_ms: number;
+}
+
 type AppMode = 'chat' | 'qr_scanner';
 type QRMode = 'camera' | 'text';
 
@@ -52,6 +71,29 @@ const SERVICE_UUID = '6E400001-B5A3-F393-E0A9-E50E24DCCA9E';
 const CHARACTERISTIC_UUID_RX = '6E400002-B5A3-F393-E0A9-E50E24DCCA9E';
 const CHARACTERISTIC_UUID_TX = '6E400003-B5A3-F393-E0A9-E50E24DCCA9E';
 
+// Bytes per write; the ESP32 reassembles JSON split across several writes
+const MAX_WRITE_CHUNK = 200; // Conservative limit for 256-byte MTU
+
+// Device frames start with [channel id][receive credit, u16 LE]
+const FRAME_HEADER = 3;
+// Give up on a write when the device grants no credit for this long
+const CREDIT_WAIT_MS = 5000;
+
+// Screen mirror: frame rate and percent of the link the device may use
+const MIRROR_FPS = 4;
+const MIRROR_SHARE_PERCENT = 25;
+
+// How long the device may answer a repeated request from its cache
+const AI_RESPONSE_TTL_MS = 5 * 60 * 1000;
+
+// Settings pushed to the device by "Sync Settings"
+const DEVICE_CONFIG: DeviceConfig = {
+  brightness: 200,
+  device_name: 'AI-Companion',
+  status_interval_ms: 30000,
+  battery_interval_ms: 60000,
+};
+
 function App() {
   const isDarkMode = useColorScheme() === 'dark';
 
@@ -67,6 +109,12 @@ function AppContent() {
   const safeAreaInsets = useSafeAreaInsets();
   const [isConnected, setIsConnected] = useState(false);
   const [deviceName, setDeviceName] = useState('');
+  // From the device's status frames, sent whenever its UI state changes
+  const [deviceBattery, setDeviceBattery] = useState<number | null>(null);
+  // Screen mirror: the decoder lives in a ref for the notification handler
+  const [mirrorInfo, setMirrorInfo] = useState<MirrorInfoFields | null>(null);
+  const [mirrorImage, setMirrorImage] = useState<string | null>(null);
+  const mirrorRef = useRef<MirrorDecoder | null>(null);
   const [isScanning, setIsScanning] = useState(false);
   const [bleManager] = useState(() => new BleManager());
   const [connectedDevice, setConnectedDevice] = useState<Device | null>(null);
@@ -210,6 +258,52 @@ function AppContent() {
   // Unique ID counter to prevent duplicate keys
   const messageIdCounter = useRef(0);
 
+  // Receive credit from the device: a wrapping byte offset we may write up
+  // to, against the bytes written since connecting. No limit until the
+  // first grant arrives, so older firmware keeps working.
+  const credit = useRef<{ sent: number; limit: number | null }>({
+    sent: 0,
+    limit: null,
+  });
+  const creditWaiters = useRef<(() => void)[]>([]);
+
+  const resetCredit = () => {
+    credit.current = { sent: 0, limit: null };
+  };
+
+  const grantCredit = (limit: number) => {
+    credit.current.limit = limit;
+    const waiters = creditWaiters.current;
+    creditWaiters.current = [];
+    waiters.forEach(wake => wake());
+  };
+
+  // Resolves once `bytes` fit in the granted credit; false on timeout
+  const waitForCredit = async (bytes: number): Promise<boolean> => {
+    const deadline = Date.now() + CREDIT_WAIT_MS;
+    for (;;) {
+      const { sent, limit } = credit.current;
+      if (limit === null) {
+        return true;
+      }
+      const room = (limit - sent) & 0xffff;
+      if (room < 0x8000 && bytes <= room) {
+        return true;
+      }
+      const remaining = deadline - Date.now();
+      if (remaining <= 0) {
+        return false;
+      }
+      await new Promise<void>(resolve => {
+        const timer = setTimeout(resolve, remaining);
+        creditWaiters.current.push(() => {
+          clearTimeout(timer);
+          resolve();
+        });
+      });
+    }
+  };
+
   const addMessage = (text: string, type: 'ai' | 'user' | 'device') => {
     const newMessage: Message = {
       id: `${Date.now()}-${messageIdCounter.current++}`,
@@ -347,9 +441,14 @@ function AppContent() {
       console.log('Attempting to connect...');
       const deviceConnection = await device.connect();
       console.log('Device connected successfully');
+      resetCredit();
       setConnectedDevice(deviceConnection);
       setIsConnected(true);
       setDeviceName(device.name || 'ESP32');
+      setDeviceBattery(null);
+      mirrorRef.current = null;
+      setMirrorInfo(null);
+      setMirrorImage(null);
 
       addMessage('✅ Connected to ' + device.name, 'ai');
 
@@ -385,7 +484,7 @@ function AppContent() {
       // Send a welcome message
       console.log('Sending welcome message...');
       await sendBLEMessage(
-        'hello',
+        MessageType.Hello,
         'Connected from React Native app!',
         'connection_established',
       );
@@ -462,10 +561,23 @@ function AppContent() {
         console.log('Received notification:', characteristic?.value);
         if (characteristic?.value) {
           try {
-            const decodedValue = Buffer.from(
-              characteristic.value,
-              'base64',
-            ).toString('utf-8');
+            const raw = Buffer.from(characteristic.value, 'base64');
+            // Strip [channel id][credit]; the credit may unblock writes
+            const framed = raw.length >= FRAME_HEADER && raw[0] < 0x20;
+            if (framed) {
+              grantCredit(raw.readUInt16LE(1));
+            }
+            // Mirror frames are binary tiles, not JSON
+            if (framed && raw[0] === Channel.Mirror) {
+              const decoder = mirrorRef.current;
+              if (decoder && decoder.apply(raw.subarray(FRAME_HEADER))) {
+                setMirrorImage(decoder.toDataUri());
+              }
+              return;
+            }
+            const decodedValue = raw
+              .subarray(framed ? FRAME_HEADER : 0)
+              .toString('utf-8');
             console.log('Decoded value:', decodedValue);
             console.log('Decoded length:', decodedValue.length, 'characters');
 
@@ -474,25 +586,16 @@ function AppContent() {
               console.log('⚠️ Large message received, may be at MTU limit');
             }
 
-            const jsonData = JSON.parse(decodedValue);
+            const jsonData: ProtocolMessage = JSON.parse(decodedValue);
             console.log('Parsed JSON:', jsonData);
 
-            // Handle different message types
-            if (jsonData.type === 'connected') {
-              addMessage('✅ ' + jsonData.message, 'device');
-            } else if (jsonData.type === 'ai_response') {
-              addMessage('🤖 ' + jsonData.message, 'device');
-            } else if (jsonData.type === 'welcome') {
-              addMessage('👋 ' + jsonData.message, 'device');
-            } else if (jsonData.type === 'test_response') {
-              addMessage('📱 ' + jsonData.message, 'device');
-            } else if (jsonData.type === 'btn') {
-              addMessage(
-                '🎯 ESP32 Button Press: ' + jsonData.message,
-                'device',
+            if (jsonData.type === MessageType.Batch) {
+              // Actions the device queued while offline, in one frame
+              (jsonData.items ?? []).forEach(item =>
+                handleDeviceMessage(item, device),
               );
-            } else if (jsonData.message) {
-              addMessage('📱 ' + jsonData.message, 'device');
+            } else {
+              handleDeviceMessage(jsonData, device);
             }
           } catch (parseError) {
             console.log('Parse error:', parseError);
@@ -512,32 +615,100 @@ function AppContent() {
     }
   };
 
+  // Handle one message from the device (batch items arrive one by one)
+  const handleDeviceMessage = (jsonData: BatchItem, device: Device) => {
+    if (jsonData.type === MessageType.Connected) {
+      addMessage('✅ ' + jsonData.message, 'device');
+    } else if (jsonData.type === MessageType.AiResponse) {
+      addMessage('🤖 ' + jsonData.message, 'device');
+    } else if (jsonData.type === MessageType.Welcome) {
+      addMessage('👋 ' + jsonData.message, 'device');
+    } else if (jsonData.type === MessageType.TestResponse) {
+      addMessage('📱 ' + jsonData.message, 'device');
+    } else if (jsonData.type === MessageType.CommandResponse) {
+      addMessage(
+        jsonData.ok
+          ? '⚙️ Device settings: ' + JSON.stringify(jsonData.results)
+          : '❌ Settings rejected: ' + JSON.stringify(jsonData.errors),
+        'device',
+      );
+    } else if (jsonData.type === MessageType.Btn) {
+      const repeats =
+        jsonData.count && jsonData.count > 1 ? ` (x${jsonData.count})` : '';
+      addMessage(
+        '🎯 ESP32 Button Press: ' + jsonData.message + repeats,
+        'device',
+      );
+      // Answer the device request; ttl_ms lets the device cache it
+      writeBLEPayload(
+        {
+          type: MessageType.AiResponse,
+          request: jsonData.message,
+          message: 'How can I help you today?',
+          ttl_ms: AI_RESPONSE_TTL_MS,
+          action: 'answer',
+        },
+        device,
+      );
+    } else if (jsonData.type === MessageType.DeviceStatus) {
+      setDeviceBattery(jsonData.battery);
+    } else if (jsonData.type === MessageType.MirrorInfo) {
+      // fps 0: the stream stopped or the device could not start it
+      const streaming = jsonData.fps > 0;
+      mirrorRef.current = streaming ? new MirrorDecoder(jsonData) : null;
+      setMirrorInfo(streaming ? jsonData : null);
+      setMirrorImage(null);
+      addMessage(
+        streaming
+          ? `🪞 Mirroring ${jsonData.width}x${jsonData.height} at ` +
+              `${jsonData.fps} fps`
+          : '🪞 Screen mirror stopped',
+        'device',
+      );
+    } else if (jsonData.type === MessageType.BulkReady) {
+      runBulkExport(jsonData);
+    } else if (jsonData.type === MessageType.BulkDone) {
+      addMessage(
+        jsonData.ok
+          ? `📶 Wi-Fi transfer finished (${jsonData.bytes} bytes)`
+          : '❌ Device could not start Wi-Fi transfer',
+        'device',
+      );
+    } else if ('message' in jsonData && jsonData.message) {
+      addMessage('📱 ' + jsonData.message, 'device');
+    }
+  };
+
   // Send BLE Message
   const sendBLEMessage = async (
-    type: string,
+    type: TextMessage['type'],
     message: string,
     action: string = '',
   ) => {
-    if (!connectedDevice || !isConnected) {
+    console.log('Sending BLE message:', type, message);
+    const sent = await writeBLEPayload({ type, message, action });
+    if (sent) {
+      addMessage('📤 Sent: ' + message, 'user');
+    }
+  };
+
+  // Write a JSON payload to the RX characteristic
+  const writeBLEPayload = async (
+    payload: ProtocolMessage,
+    device: Device | null = isConnected ? connectedDevice : null,
+  ): Promise<boolean> => {
+    if (!device) {
       console.log('Cannot send - not connected');
       addMessage('❌ Not connected to device', 'ai');
-      return;
+      return false;
     }
 
     try {
-      console.log('Sending BLE message:', type, message);
-      const messageData = {
-        type,
-        message,
-        action,
-        timestamp: Date.now(),
-      };
-
-      const jsonString = JSON.stringify(messageData);
+      const jsonString = JSON.stringify(payload);
       console.log('JSON message:', jsonString);
 
       console.log('Getting services...');
-      const services = await connectedDevice.services();
+      const services = await device.services();
       console.log('Found', services.length, 'services');
 
       // Log all service UUIDs
@@ -554,7 +725,7 @@ function AppContent() {
 
       if (!targetService) {
         addMessage('❌ BLE service not found for sending', 'ai');
-        return;
+        return false;
       }
 
       console.log('Getting characteristics...');
@@ -577,52 +748,116 @@ function AppContent() {
 
       if (!rxCharacteristic) {
         addMessage('❌ RX characteristic not found', 'ai');
-        return;
-      }
-
-      console.log('Writing to RX characteristic...');
-      const encodedMessage = Buffer.from(jsonString, 'utf-8').toString(
-        'base64',
-      );
-      console.log(
-        'Encoded message length:',
-        encodedMessage.length,
-        'characters',
-      );
-
-      // Check if message fits in negotiated MTU
-      const maxPayloadSize = 200; // Conservative limit for 256-byte MTU
-      if (encodedMessage.length > maxPayloadSize) {
-        console.log(
-          '⚠️ Message exceeds MTU limit, truncating for reliability...',
-        );
-        const truncatedMessage = encodedMessage.substring(0, maxPayloadSize);
-        console.log('Truncated to:', truncatedMessage.length, 'characters');
+        return false;
       }
 
-      const finalMessage =
-        encodedMessage.length > maxPayloadSize
-          ? encodedMessage.substring(0, maxPayloadSize)
-          : encodedMessage;
-
-      try {
-        // Try writeWithoutResponse first (better for reliability)
-        await rxCharacteristic.writeWithoutResponse(finalMessage);
-        console.log('Message sent successfully (without response)');
-        addMessage('📤 Sent: ' + message, 'user');
-      } catch (writeError) {
-        console.log('Write without response failed, trying with response...');
-        // Fallback to write with response if without response fails
-        await rxCharacteristic.writeWithResponse(finalMessage);
-        console.log('Message sent successfully (with response)');
-        addMessage('📤 Sent: ' + message, 'user');
+      // Split into MTU-sized writes instead of truncating; the device
+      // reassembles the JSON object from consecutive writes. The leading
+      // byte names the virtual channel the message travels on.
+      const bytes = Buffer.concat([
+        Buffer.from([MESSAGE_CHANNEL[payload.type]]),
+        Buffer.from(jsonString, 'utf-8'),
+      ]);
+      console.log('Writing to RX characteristic...', bytes.length, 'bytes');
+
+      for (let offset = 0; offset < bytes.length; offset += MAX_WRITE_CHUNK) {
+        const slice = bytes.slice(offset, offset + MAX_WRITE_CHUNK);
+        // Only write what the device has buffer space for
+        if (!(await waitForCredit(slice.length))) {
+          throw new Error('device granted no receive credit');
+        }
+        const chunk = slice.toString('base64');
+        try {
+          // Without response is the fast path; credit prevents overruns
+          await rxCharacteristic.writeWithoutResponse(chunk);
+        } catch (writeError) {
+          console.log(
+            'Write without response failed, trying with response...',
+          );
+          // Fallback to write with response if without response fails
+          await rxCharacteristic.writeWithResponse(chunk);
+        }
+        credit.current.sent = (credit.current.sent + slice.length) & 0xffff;
       }
+      console.log('Message sent successfully');
+      return true;
     } catch (error) {
       console.error('Send message error:', error);
       addMessage(
         '❌ Failed to send message: ' + (error as Error).message,
         'ai',
       );
+      return false;
+    }
+  };
+
+  // Push the whole device configuration in one command batch; the device
+  // applies every set together and answers with one command_response
+  const commandIdCounter = useRef(0);
+
+  const syncDeviceSettings = async () => {
+    if (!isConnected) {
+      Alert.alert('Not Connected', 'Please connect to a device first.');
+      return;
+    }
+
+    const ops = [
+      ...Object.entries(DEVICE_CONFIG).map(([key, value]) => ({
+        op: 'set',
+        key,
+        value,
+      })),
+      { op: 'get_all' },
+    ];
+    const sent = await writeBLEPayload({
+      type: MessageType.Command,
+      id: ++commandIdCounter.current,
+      ops,
+    });
+    if (sent) {
+      addMessage('⚙️ Syncing device settings...', 'user');
+    }
+  };
+
+  // Large transfers go over the device's Wi-Fi soft-AP instead of BLE. The
+  // device answers bulk_start with bulk_ready carrying the AP and a token.
+  const requestHistoryExport = async () => {
+    if (!isConnected) {
+      Alert.alert('Not Connected', 'Please connect to a device first.');
+      return;
+    }
+    const sent = await writeBLEPayload({ type: MessageType.BulkStart });
+    if (sent) {
+      addMessage('📶 Requesting Wi-Fi transfer...', 'user');
+    }
+  };
+
+  // Starts or stops the device's screen mirror stream
+  const toggleMirror = async () => {
+    await writeBLEPayload({
+      type: MessageType.Mirror,
+      fps: mirrorInfo ? 0 : MIRROR_FPS,
+      share: MIRROR_SHARE_PERCENT,
+    });
+  };
+
+  const runBulkExport = async (info: BulkReadyMessage) => {
+    addMessage(
+      `📶 Join Wi-Fi "${info.ssid}" (password ${info.password}) to transfer`,
+      'device',
+    );
+    const baseUrl = `http://${info.ip}:${info.port}`;
+    const headers = { Authorization: `Bearer ${info.token}` };
+    try {
+      const response = await fetch(`${baseUrl}/history`, { headers });
+      const history = await response.text();
+      addMessage('📜 Device history:\n' + history, 'device');
+    } catch (error) {
+      console.log('Bulk export error:', error);
+      addMessage('❌ Could not reach device over Wi-Fi', 'ai');
+    } finally {
+      // Either way the device turns its radio back off
+      fetch(`${baseUrl}/done`, { method: 'POST', headers }).catch(() => {});
     }
   };
 
@@ -763,7 +998,7 @@ function AppContent() {
   const sendTestMessage = async () => {
     if (isConnected) {
       await sendBLEMessage(
-        'test',
+        MessageType.Test,
         'Hello from React Native app!',
         'test_message',
       );
@@ -942,12 +1177,25 @@ function AppContent() {
                 {isScanning
                   ? 'Scanning...'
                   : isConnected
-                  ? `Connected to ${deviceName}`
+                  ? `Connected to ${deviceName}` +
+                    (deviceBattery !== null ? ` · 🔋 ${deviceBattery}%` : '')
                   : 'Ready to Connect'}
               </Text>
             </View>
           </View>
 
+          {/* Screen mirror */}
+          {isConnected && mirrorInfo && mirrorImage && (
+            <Image
+              source={{ uri: mirrorImage }}
+              style={[
+                styles.mirror,
+                { aspectRatio: mirrorInfo.width / mirrorInfo.height },
+              ]}
+              resizeMode="contain"
+            />
+          )}
+
           {/* Messages */}
           <ScrollView
             ref={scrollViewRef}
@@ -1035,6 +1283,35 @@ function AppContent() {
               </TouchableOpacity>
             )}
 
+            {isConnected && (
+              <TouchableOpacity
+                style={styles.testButton}
+                onPress={syncDeviceSettings}
+              >
+                <Text style={styles.buttonText}>⚙️ Sync Settings</Text>
+              </TouchableOpacity>
+            )}
+
+            {isConnected && (
+              <TouchableOpacity
+                style={styles.testButton}
+                onPress={requestHistoryExport}
+              >
+                <Text style={styles.buttonText}>📶 Export History</Text>
+              </TouchableOpacity>
+            )}
+
+            {isConnected && (
+              <TouchableOpacity
+                style={styles.testButton}
+                onPress={toggleMirror}
+              >
+                <Text style={styles.buttonText}>
+                  {mirrorInfo ? '🪞 Stop Mirror' : '🪞 Mirror Screen'}
+                </Text>
+              </TouchableOpacity>
+            )}
+
             <TouchableOpacity style={styles.infoButton} onPress={showBLEInfo}>
               <Text style={styles.buttonText}>📖 BLE Implementation Guide</Text>
             </TouchableOpacity>
@@ -1085,6 +1362,10 @@ const styles = StyleSheet.create({
     color: 'white',
     fontSize: 14,
   },
+  mirror: {
+    width: '100%',
+    backgroundColor: 'black',
+  },
   messagesContainer: {
     flex: 1,
     padding: 16,
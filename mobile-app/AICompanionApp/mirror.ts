@@ -0,0 +1,110 @@
+/**
+ * Screen mirror decoder (frame format: firmware/src/screen_mirror.h)
+ *
+ * Keeps the same shadow framebuffer as the device and applies the XOR /
+ * RLE tile records of each mirror frame to it. Completed frames are
+ * rendered as a BMP data URI, which <Image> shows without native code.
+ */
+
+import { Buffer } from 'buffer';
+import { MirrorInfoFields } from './protocol';
+
+const FLAG_LAST = 0x01; // Frame complete, present it
+const FLAG_RESET = 0x02; // Clear the shadow first
+const CHUNK_HEADER = 2; // Frame seq, flags
+const RECORD_HEADER = 3; // Tile index u16 LE, length u8
+const BMP_HEADER = 14 + 40 + 12; // File header, BITMAPINFOHEADER, masks
+
+export class MirrorDecoder {
+  readonly width: number;
+  readonly height: number;
+  private readonly tile: number;
+  private readonly columns: number;
+  private readonly shadow: Uint16Array;
+
+  constructor(info: MirrorInfoFields) {
+    this.width = info.width;
+    this.height = info.height;
+    this.tile = info.tile;
+    this.columns = Math.ceil(info.width / info.tile);
+    this.shadow = new Uint16Array(info.width * info.height);
+  }
+
+  // Applies one mirror frame payload; true when a frame is complete
+  apply(payload: Buffer): boolean {
+    if (payload.length < CHUNK_HEADER) {
+      return false;
+    }
+    const flags = payload[1];
+    if (flags & FLAG_RESET) {
+      this.shadow.fill(0);
+    }
+    let at = CHUNK_HEADER;
+    while (at + RECORD_HEADER <= payload.length) {
+      const tile = payload.readUInt16LE(at);
+      const length = payload[at + 2];
+      at += RECORD_HEADER;
+      this.applyTile(tile, payload.subarray(at, at + length));
+      at += length;
+    }
+    return (flags & FLAG_LAST) !== 0;
+  }
+
+  // The shadow as a top-down 16-bit BMP with RGB565 bit fields
+  toDataUri(): string {
+    const rowBytes = (this.width * 2 + 3) & ~3;
+    const image = Buffer.alloc(BMP_HEADER + rowBytes * this.height);
+    image.write('BM', 0, 'ascii');
+    image.writeUInt32LE(image.length, 2);
+    image.writeUInt32LE(BMP_HEADER, 10);
+    image.writeUInt32LE(40, 14);
+    image.writeInt32LE(this.width, 18);
+    image.writeInt32LE(-this.height, 22);
+    image.writeUInt16LE(1, 26);
+    image.writeUInt16LE(16, 28);
+    image.writeUInt32LE(3, 30); // BI_BITFIELDS
+    image.writeUInt32LE(rowBytes * this.height, 34);
+    image.writeUInt32LE(0xf800, 54);
+    image.writeUInt32LE(0x07e0, 58);
+    image.writeUInt32LE(0x001f, 62);
+    for (let y = 0; y < this.height; y++) {
+      const row = BMP_HEADER + y * rowBytes;
+      for (let x = 0; x < this.width; x++) {
+        image.writeUInt16LE(this.shadow[y * this.width + x], row + x * 2);
+      }
+    }
+    return 'data:image/bmp;base64,' + image.toString('base64');
+  }
+
+  // Run tokens: 0x80 | (n - 1) then one pixel; literals: n - 1 then n
+  private applyTile(tile: number, data: Buffer) {
+    const x0 = (tile % this.columns) * this.tile;
+    const y0 = Math.floor(tile / this.columns) * this.tile;
+    const w = Math.min(this.tile, this.width - x0);
+    const h = Math.min(this.tile, this.height - y0);
+    const count = w * h;
+    const xor = (pixel: number, value: number) => {
+      const index =
+        (y0 + Math.floor(pixel / w)) * this.width + x0 + (pixel % w);
+      this.shadow[index] ^= value;
+    };
+
+    let pixel = 0;
+    let at = 0;
+    while (at < data.length && pixel < count) {
+      const token = data[at++];
+      if (token & 0x80) {
+        const value = data.readUInt16LE(at);
+        at += 2;
+        for (let n = (token & 0x7f) + 1; n > 0 && pixel < count; n--) {
+          xor(pixel++, value);
+        }
+      } else {
+        for (let n = token + 1; n > 0 && pixel < count; n--) {
+          xor(pixel++, data.readUInt16LE(at));
+          at += 2;
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,594 @@
+/**
+ * Generated by firmware/scripts/generate_protocol.py from
+ * protocol/schema.json - do not edit
+ *
+ * @format
+ */
+
+import { Buffer } from 'buffer';
+
+export const MessageType = {
+  Btn: 'btn',
+  Connected: 'connected',
+  Welcome: 'welcome',
+  Test: 'test',
+  TestResponse: 'test_response',
+  Hello: 'hello',
+  AiRequest: 'ai_request',
+  AiResponse: 'ai_response',
+  Notification: 'notification',
+  Command: 'command',
+  CommandResponse: 'command_response',
+  Batch: 'batch',
+  BulkStart: 'bulk_start',
+  BulkReady: 'bulk_ready',
+  BulkDone: 'bulk_done',
+  Metrics: 'metrics',
+  Bench: 'bench',
+  BenchResult: 'bench_result',
+  AssetBegin: 'asset_begin',
+  AssetAck: 'asset_ack',
+  AssetEnd: 'asset_end',
+  AssetDone: 'asset_done',
+  Credit: 'credit',
+  DeviceStatus: 'device_status',
+  Mirror: 'mirror',
+  MirrorInfo: 'mirror_info',
+} as const;
+
+export type MessageTypeName = (typeof MessageType)[keyof typeof MessageType];
+
+// BLE frames start with the id of their message's channel
+export const Channel = {
+  Chat: 0,
+  Control: 1,
+  Diagnostics: 2,
+  Logs: 3,
+  Ota: 4,
+  Asset: 5,
+  Mirror: 6,
+} as const;
+
+export type ChannelId = (typeof Channel)[keyof typeof Channel];
+
+export const MESSAGE_CHANNEL: Record<MessageTypeName, ChannelId> = {
+  btn: Channel.Chat,
+  connected: Channel.Control,
+  welcome: Channel.Control,
+  test: Channel.Chat,
+  test_response: Channel.Chat,
+  hello: Channel.Control,
+  ai_request: Channel.Chat,
+  ai_response: Channel.Chat,
+  notification: Channel.Chat,
+  command: Channel.Control,
+  command_response: Channel.Control,
+  batch: Channel.Chat,
+  bulk_start: Channel.Asset,
+  bulk_ready: Channel.Asset,
+  bulk_done: Channel.Asset,
+  metrics: Channel.Diagnostics,
+  bench: Channel.Diagnostics,
+  bench_result: Channel.Diagnostics,
+  asset_begin: Channel.Asset,
+  asset_ack: Channel.Asset,
+  asset_end: Channel.Asset,
+  asset_done: Channel.Asset,
+  credit: Channel.Control,
+  device_status: Channel.Control,
+  mirror: Channel.Control,
+  mirror_info: Channel.Control,
+};
+
+export interface CommandOp {
+  op: string;
+  key?: string;
+  value?: unknown;
+}
+
+export type BatchItem = ProtocolMessage & { count?: number };
+
+export interface TextFields {
+  message: string;
+  action: string;
+}
+
+export interface AiResponseFields {
+  message: string;
+  request: string;
+  ttl_ms: number;
+  action: string;
+}
+
+export interface NotificationFields {
+  app: string;
+  title: string;
+  message: string;
+  priority: string;
+}
+
+export interface BulkReadyFields {
+  ssid: string;
+  password: string;
+  ip: string;
+  port: number;
+  token: string;
+}
+
+export interface StatusFields {
+  ok: boolean;
+  bytes: number;
+}
+
+export interface BenchFields {
+  name: string;
+}
+
+export interface AssetBeginFields {
+  target: string;
+  name: string;
+  size: number;
+}
+
+export interface MetricsFields {
+  uptime_ms: number;
+  free_heap: number;
+  min_free_heap: number;
+  free_psram: number;
+  ble_peers: number;
+  outbox: number;
+  cache_hit_rate: number;
+  notifications: number;
+  notifications_dropped: number;
+  usb_frames: number;
+  usb_crc_errors: number;
+  stalls: number;
+  slo_misses: number;
+  loop_p99_us: number;
+  lvgl_internal: number;
+  lvgl_psram: number;
+  lvgl_internal_frag: number;
+  lvgl_psram_frag: number;
+}
+
+export interface DeviceStatusFields {
+  peers: number;
+  battery: number;
+  brightness: number;
+}
+
+export interface MirrorConfigFields {
+  fps: number;
+  share: number;
+}
+
+export interface MirrorInfoFields {
+  width: number;
+  height: number;
+  tile: number;
+  fps: number;
+  share: number;
+}
+
+export interface CommandFields {
+  id: number;
+  ops?: CommandOp[];
+}
+
+export interface CommandResponseFields {
+  id: number;
+  ok: boolean;
+  results?: Record<string, unknown>;
+  errors?: Record<string, string>;
+}
+
+export interface BatchFields {
+  items?: BatchItem[];
+}
+
+export interface BenchResultFields {
+  ok: boolean;
+  results?: Record<string, unknown>;
+}
+
+export interface BtnMessage extends TextFields {
+  type: 'btn';
+  seq?: number;
+}
+
+export interface ConnectedMessage extends TextFields {
+  type: 'connected';
+  seq?: number;
+}
+
+export interface WelcomeMessage extends TextFields {
+  type: 'welcome';
+  seq?: number;
+}
+
+export interface TestMessage extends TextFields {
+  type: 'test';
+  seq?: number;
+}
+
+export interface TestResponseMessage extends TextFields {
+  type: 'test_response';
+  seq?: number;
+}
+
+export interface HelloMessage extends TextFields {
+  type: 'hello';
+  seq?: number;
+}
+
+export interface AiRequestMessage extends TextFields {
+  type: 'ai_request';
+  seq?: number;
+}
+
+export interface AiResponseMessage extends AiResponseFields {
+  type: 'ai_response';
+  seq?: number;
+}
+
+export interface NotificationMessage extends NotificationFields {
+  type: 'notification';
+  seq?: number;
+}
+
+export interface CommandMessage extends CommandFields {
+  type: 'command';
+  seq?: number;
+}
+
+export interface CommandResponseMessage extends CommandResponseFields {
+  type: 'command_response';
+  seq?: number;
+}
+
+export interface BatchMessage extends BatchFields {
+  type: 'batch';
+  seq?: number;
+}
+
+export interface BulkStartMessage {
+  type: 'bulk_start';
+  seq?: number;
+}
+
+export interface BulkReadyMessage extends BulkReadyFields {
+  type: 'bulk_ready';
+  seq?: number;
+}
+
+export interface BulkDoneMessage extends StatusFields {
+  type: 'bulk_done';
+  seq?: number;
+}
+
+export interface MetricsMessage extends MetricsFields {
+  type: 'metrics';
+  seq?: number;
+}
+
+export interface BenchMessage extends BenchFields {
+  type: 'bench';
+  seq?: number;
+}
+
+export interface BenchResultMessage extends BenchResultFields {
+  type: 'bench_result';
+  seq?: number;
+}
+
+export interface AssetBeginMessage extends AssetBeginFields {
+  type: 'asset_begin';
+  seq?: number;
+}
+
+export interface AssetAckMessage extends StatusFields {
+  type: 'asset_ack';
+  seq?: number;
+}
+
+export interface AssetEndMessage {
+  type: 'asset_end';
+  seq?: number;
+}
+
+export interface AssetDoneMessage extends StatusFields {
+  type: 'asset_done';
+  seq?: number;
+}
+
+export interface CreditMessage {
+  type: 'credit';
+  seq?: number;
+}
+
+export interface DeviceStatusMessage extends DeviceStatusFields {
+  type: 'device_status';
+  seq?: number;
+}
+
+export interface MirrorMessage extends MirrorConfigFields {
+  type: 'mirror';
+  seq?: number;
+}
+
+export interface MirrorInfoMessage extends MirrorInfoFields {
+  type: 'mirror_info';
+  seq?: number;
+}
+
+export type ProtocolMessage =
+  | BtnMessage
+  | ConnectedMessage
+  | WelcomeMessage
+  | TestMessage
+  | TestResponseMessage
+  | HelloMessage
+  | AiRequestMessage
+  | AiResponseMessage
+  | NotificationMessage
+  | CommandMessage
+  | CommandResponseMessage
+  | BatchMessage
+  | BulkStartMessage
+  | BulkReadyMessage
+  | BulkDoneMessage
+  | MetricsMessage
+  | BenchMessage
+  | BenchResultMessage
+  | AssetBeginMessage
+  | AssetAckMessage
+  | AssetEndMessage
+  | AssetDoneMessage
+  | CreditMessage
+  | DeviceStatusMessage
+  | MirrorMessage
+  | MirrorInfoMessage;
+
+export type TextMessage =
+  | BtnMessage
+  | ConnectedMessage
+  | WelcomeMessage
+  | TestMessage
+  | TestResponseMessage
+  | HelloMessage
+  | AiRequestMessage;
+
+export type StatusMessage =
+  | BulkDoneMessage
+  | AssetAckMessage
+  | AssetDoneMessage;
+
+type WireKind = 'string' | 'u32' | 'bool';
+
+const BINARY_LAYOUT: Record<
+  number,
+  { type: MessageTypeName; fields: [string, number, WireKind][] }
+> = {
+  1: {
+    type: 'btn',
+    fields: [['message', 1, 'string'], ['action', 2, 'string']],
+  },
+  2: {
+    type: 'connected',
+    fields: [['message', 1, 'string'], ['action', 2, 'string']],
+  },
+  3: {
+    type: 'welcome',
+    fields: [['message', 1, 'string'], ['action', 2, 'string']],
+  },
+  4: {
+    type: 'test',
+    fields: [['message', 1, 'string'], ['action', 2, 'string']],
+  },
+  5: {
+    type: 'test_response',
+    fields: [['message', 1, 'string'], ['action', 2, 'string']],
+  },
+  6: {
+    type: 'hello',
+    fields: [['message', 1, 'string'], ['action', 2, 'string']],
+  },
+  7: {
+    type: 'ai_request',
+    fields: [['message', 1, 'string'], ['action', 2, 'string']],
+  },
+  8: {
+    type: 'ai_response',
+    fields: [
+      ['message', 1, 'string'],
+      ['request', 2, 'string'],
+      ['ttl_ms', 3, 'u32'],
+      ['action', 4, 'string'],
+    ],
+  },
+  9: {
+    type: 'notification',
+    fields: [
+      ['app', 1, 'string'],
+      ['title', 2, 'string'],
+      ['message', 3, 'string'],
+      ['priority', 4, 'string'],
+    ],
+  },
+  13: {
+    type: 'bulk_start',
+    fields: [],
+  },
+  14: {
+    type: 'bulk_ready',
+    fields: [
+      ['ssid', 1, 'string'],
+      ['password', 2, 'string'],
+      ['ip', 3, 'string'],
+      ['port', 4, 'u32'],
+      ['token', 5, 'string'],
+    ],
+  },
+  15: {
+    type: 'bulk_done',
+    fields: [['ok', 1, 'bool'], ['bytes', 2, 'u32']],
+  },
+  16: {
+    type: 'metrics',
+    fields: [
+      ['uptime_ms', 1, 'u32'],
+      ['free_heap', 2, 'u32'],
+      ['min_free_heap', 3, 'u32'],
+      ['free_psram', 4, 'u32'],
+      ['ble_peers', 5, 'u32'],
+      ['outbox', 6, 'u32'],
+      ['cache_hit_rate', 7, 'u32'],
+      ['notifications', 8, 'u32'],
+      ['notifications_dropped', 9, 'u32'],
+      ['usb_frames', 10, 'u32'],
+      ['usb_crc_errors', 11, 'u32'],
+      ['stalls', 12, 'u32'],
+      ['slo_misses', 13, 'u32'],
+      ['loop_p99_us', 14, 'u32'],
+      ['lvgl_internal', 15, 'u32'],
+      ['lvgl_psram', 16, 'u32'],
+      ['lvgl_internal_frag', 17, 'u32'],
+      ['lvgl_psram_frag', 18, 'u32'],
+    ],
+  },
+  17: {
+    type: 'bench',
+    fields: [['name', 1, 'string']],
+  },
+  19: {
+    type: 'asset_begin',
+    fields: [
+      ['target', 1, 'string'],
+      ['name', 2, 'string'],
+      ['size', 3, 'u32'],
+    ],
+  },
+  20: {
+    type: 'asset_ack',
+    fields: [['ok', 1, 'bool'], ['bytes', 2, 'u32']],
+  },
+  21: {
+    type: 'asset_end',
+    fields: [],
+  },
+  22: {
+    type: 'asset_done',
+    fields: [['ok', 1, 'bool'], ['bytes', 2, 'u32']],
+  },
+  23: {
+    type: 'credit',
+    fields: [],
+  },
+  24: {
+    type: 'device_status',
+    fields: [
+      ['peers', 1, 'u32'],
+      ['battery', 2, 'u32'],
+      ['brightness', 3, 'u32'],
+    ],
+  },
+  25: {
+    type: 'mirror',
+    fields: [['fps', 1, 'u32'], ['share', 2, 'u32']],
+  },
+  26: {
+    type: 'mirror_info',
+    fields: [
+      ['width', 1, 'u32'],
+      ['height', 2, 'u32'],
+      ['tile', 3, 'u32'],
+      ['fps', 4, 'u32'],
+      ['share', 5, 'u32'],
+    ],
+  },
+};
+
+const WIRE_VARINT = 0;
+const WIRE_BYTES = 2;
+
+const pushVarint = (out: number[], value: number) => {
+  let v = value >>> 0;
+  while (v >= 0x80) {
+    out.push((v & 0x7f) | 0x80);
+    v >>>= 7;
+  }
+  out.push(v);
+};
+
+// Compact binary form of a message (same layout as the firmware codec);
+// null for messages with nested JSON members
+export const encodeBinary = (message: ProtocolMessage): Uint8Array | null => {
+  const entry = Object.entries(BINARY_LAYOUT).find(
+    ([, layout]) => layout.type === message.type,
+  );
+  if (!entry) {
+    return null;
+  }
+  const out: number[] = [Number(entry[0])];
+  pushVarint(out, message.seq ?? 0);
+  const values = message as unknown as Record<string, unknown>;
+  for (const [name, tag, kind] of entry[1].fields) {
+    const value = values[name];
+    if (kind === 'string') {
+      const bytes = Buffer.from(String(value ?? ''), 'utf-8');
+      out.push((tag << 3) | WIRE_BYTES);
+      pushVarint(out, bytes.length);
+      bytes.forEach(b => out.push(b));
+    } else {
+      out.push((tag << 3) | WIRE_VARINT);
+      pushVarint(out, kind === 'bool' ? (value ? 1 : 0) : Number(value ?? 0));
+    }
+  }
+  return Uint8Array.from(out);
+};
+
+export const decodeBinary = (bytes: Uint8Array): ProtocolMessage | null => {
+  const layout = BINARY_LAYOUT[bytes[0]];
+  if (!layout) {
+    return null;
+  }
+  let pos = 1;
+  const readVarint = () => {
+    let value = 0;
+    for (let shift = 0; shift < 35 && pos < bytes.length; shift += 7) {
+      const b = bytes[pos++];
+      value += (b & 0x7f) * 2 ** shift;
+      if (!(b & 0x80)) {
+        return value;
+      }
+    }
+    throw new Error('truncated varint');
+  };
+
+  try {
+    const message: Record<string, unknown> = {
+      type: layout.type,
+      seq: readVarint(),
+    };
+    while (pos < bytes.length) {
+      const key = readVarint();
+      const field = layout.fields.find(([, tag]) => tag === key >> 3);
+      if ((key & 7) === WIRE_BYTES) {
+        const length = readVarint();
+        const text = Buffer.from(bytes.subarray(pos, pos + length));
+        pos += length;
+        if (field) {
+          message[field[0]] = text.toString('utf-8');
+        }
+      } else {
+        const value = readVarint();
+        if (field) {
+          message[field[0]] = field[2] === 'bool' ? value !== 0 : value;
+        }
+      }
+    }
+    return message as unknown as ProtocolMessage;
+  } catch {
+    return null;
+  }
+};